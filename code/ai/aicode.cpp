@@ -2360,13 +2360,25 @@ int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float ra
 	eno.nearest_objnum = -1;
 	eno.check_danger_weapon_objnum = 0;
 
-	// go through the list of all ships and evaluate as potential targets
-	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-		if (Objects[so->objnum].flags[Object::Object_Flags::Should_be_dead])
-			continue;
+	auto evaluate = [&eno](int trial_objnum) {
+		if (Objects[trial_objnum].flags[Object::Object_Flags::Should_be_dead])
+			return;
 
-		eno.trial_objp = &Objects[so->objnum];
+		eno.trial_objp = &Objects[trial_objnum];
 		evaluate_object_as_nearest_objnum(&eno);
+	};
+
+	// Go through all ships which could be within range and evaluate them as potential targets.  Fighters and bombers
+	// count at half their distance, so anything up to twice the range away may be picked.
+	SCP_vector<int> nearby_ships;
+	if (ship_grid_query(&Objects[objnum].pos, range * 2.0f, nearby_ships)) {
+		for (auto trial_objnum : nearby_ships) {
+			evaluate(trial_objnum);
+		}
+	} else {
+		for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
+			evaluate(so->objnum);
+		}
 	}
 
 	// check if danger_weapon_objnum has will show a stealth ship
@@ -2421,17 +2433,17 @@ int find_nearby_threat(int objnum, int enemy_team_mask, float range, int *count)
 
 	*count = 0;
 
-	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-		objp = &Objects[so->objnum];
+	auto evaluate = [&](int trial_objnum) {
+		objp = &Objects[trial_objnum];
 		if (objp->flags[Object::Object_Flags::Should_be_dead])
-			continue;
+			return;
 
 		if ( OBJ_INDEX(objp) != objnum ) {
 			if (Ships[objp->instance].flags[Ship::Ship_Flags::Dying])
-				continue;
+				return;
 
             if (Ship_info[Ships[objp->instance].ship_info_index].flags[Ship::Info_Flags::No_ship_type] || Ship_info[Ships[objp->instance].ship_info_index].flags[Ship::Info_Flags::Navbuoy])
-                continue;
+                return;
 
 			if (iff_matches_mask(Ships[objp->instance].team, enemy_team_mask)) {
 				float	dist;
@@ -2448,6 +2460,17 @@ int find_nearby_threat(int objnum, int enemy_team_mask, float range, int *count)
 				}
 			}
 		}
+	};
+
+	SCP_vector<int> nearby_ships;
+	if (ship_grid_query(&Objects[objnum].pos, range, nearby_ships)) {
+		for (auto trial_objnum : nearby_ships) {
+			evaluate(trial_objnum);
+		}
+	} else {
+		for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
+			evaluate(so->objnum);
+		}
 	}
 
 	return nearest_objnum;
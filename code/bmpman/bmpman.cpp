@@ -34,6 +34,7 @@
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
 #include "ktxutils/ktxutils.h"
+#include "utils/threading.h"
 
 #include <cctype>
 #include <climits>
@@ -103,6 +104,45 @@ static int Bm_max_ram = 0;
 static int Bm_ignore_duplicates = 0;
 static int Bm_ignore_load_count = 0;
 
+/**
+ * Handles of all loaded bitmaps, keyed by their filename without the extension.
+ *
+ * @details Used by bm_load_sub_fast() so finding an already loaded bitmap doesn't have to look at every slot. Entries
+ * are only removed when a bitmap is released, so the candidates are checked against the actual slot before they are used.
+ */
+static SCP_unordered_map<SCP_string, SCP_vector<int>, SCP_string_lcase_hash, SCP_string_lcase_equal_to> Bm_name_index;
+
+static int Bm_name_lookups = 0;
+static int Bm_name_lookup_hits = 0;
+
+/**
+ * Image data of a bitmap which was decoded on a worker thread by bm_page_in_stop() and is waiting to be handed to the
+ * bm_lock_* function of its type
+ */
+struct bm_staged_image {
+	int handle = -1;
+	BM_TYPE type = BM_TYPE_NONE;	// type of the image file, for EFFs this is the type of the frame
+	char filename[MAX_FILENAME_LEN];
+	int dir_type = CF_TYPE_ANY;
+	size_t size = 0;				// size of the buffer, the same as the bm_lock_* function would allocate
+	int bpp = 0;
+	int error = 0;
+	ubyte* data = nullptr;
+	bool taken = false;
+	std::uint64_t decode_time = 0;	// in nanoseconds
+};
+
+/**
+ * The current batch of decoded bitmaps while paging in
+ */
+static SCP_vector<bm_staged_image> Bm_staged_images;
+
+struct bm_decode_stats {
+	int count = 0;
+	size_t bytes = 0;
+	std::uint64_t decode_time = 0;	// summed up over all threads, in nanoseconds
+};
+
 // This needs to be declared somewhere and bm_internal.h has no own source file
 gr_bitmap_info::~gr_bitmap_info() = default;
 
@@ -116,6 +156,46 @@ static bool bm_is_anim(bitmap_entry* entry)
 		(entry->type == BM_TYPE_PNG && entry->info.ani.apng.is_apng));
 }
 
+/**
+ * The part of a filename which is compared by strextcmp(), i.e. everything up to the last '.'
+ */
+static SCP_string bm_name_index_key(const char* filename)
+{
+	auto ext = strrchr(filename, '.');
+
+	return (ext != nullptr) ? SCP_string(filename, ext - filename) : SCP_string(filename);
+}
+
+/**
+ * Adds a bitmap to the name index, needs to be called whenever an entry gets a new filename
+ */
+static void bm_name_index_add(const bitmap_entry* entry)
+{
+	auto& handles = Bm_name_index[bm_name_index_key(entry->filename)];
+
+	if (std::find(handles.begin(), handles.end(), entry->handle) == handles.end()) {
+		handles.push_back(entry->handle);
+	}
+}
+
+/**
+ * Removes a bitmap from the name index, needs to be called before the filename of the entry is changed or cleared
+ */
+static void bm_name_index_remove(const bitmap_entry* entry)
+{
+	auto it = Bm_name_index.find(bm_name_index_key(entry->filename));
+	if (it == Bm_name_index.end()) {
+		return;
+	}
+
+	auto& handles = it->second;
+	handles.erase(std::remove(handles.begin(), handles.end(), entry->handle), handles.end());
+
+	if (handles.empty()) {
+		Bm_name_index.erase(it);
+	}
+}
+
 bitmap_slot* bm_get_slot(int handle, bool separate_ani_frames) {
 	Assertion(handle >= 0, "Invalid handle %d passed to bm_get_slot!", handle);
 
@@ -456,6 +536,13 @@ DCF(bm_used, "Shows BmpMan Slot Usage") {
 	text << "  " << std::dec << std::setw(4) << std::setfill('0') << render_target_dynamic  << ", Render/Dynamic\n";
 	text << "  " << std::dec << std::setw(4) << std::setfill('0') << bmpman_count_bitmaps() << "/" << bmpman_count_available_slots()  << ", Total\n";
 	text << "\n";
+	text << "Duplicate Lookups\n";
+	text << "  " << std::dec << Bm_name_lookup_hits << "/" << Bm_name_lookups << " hits";
+	if (Bm_name_lookups > 0) {
+		text << " (" << std::fixed << std::setprecision(1) << (100.0 * Bm_name_lookup_hits / Bm_name_lookups) << "%)";
+	}
+	text << ", " << Bm_name_index.size() << " names indexed\n";
+	text << "\n";
 
 	// TODO consider converting 1's to monospace to make debug console output prettier
 	mprintf(("%s", text.str().c_str())); // log for ease for copying data
@@ -539,6 +626,7 @@ void bm_close() {
 			}
 		}
 		bm_blocks.clear();
+		Bm_name_index.clear();
 		bm_inited = false;
 	}
 }
@@ -592,6 +680,8 @@ int bm_create(int bpp, int w, int h, void *data, int flags) {
 
 	entry->load_count++;
 
+	bm_name_index_add(entry);
+
 	bm_update_memory_used(n, (int)entry->mem_taken);
 
 	gr_bm_create(bm_get_slot(n));
@@ -645,6 +735,8 @@ int bm_create_3d(int bpp, int w, int h, int d, void* data) {
 
 	entry->load_count++;
 
+	bm_name_index_add(entry);
+
 	bm_update_memory_used(n, (int)entry->mem_taken);
 
 	gr_bm_create(bm_get_slot(n));
@@ -1340,6 +1432,8 @@ int bm_load(const char *real_filename, int dir_type) {
 
 	entry->load_count++;
 
+	bm_name_index_add(entry);
+
 	if (img_cfp != nullptr)
 		cfclose(img_cfp);
 
@@ -1846,6 +1940,8 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 			}
 		}
 
+		bm_name_index_add(entry);
+
 		entry->info.ani.apng.frame_delay = 0.0f;
 		if (type == BM_TYPE_PNG) {
 			entry->info.ani.apng.is_apng = true;
@@ -1939,32 +2035,49 @@ int bm_load_sub_fast(const char *real_filename, int *handle, int dir_type, bool
 	if (Bm_ignore_duplicates)
 		return 0;
 
-	for (auto& block : bm_blocks) {
-		for (auto& slot : block) {
-			auto& entry = slot.entry;
-			if (entry.type == BM_TYPE_NONE)
-				continue;
+	++Bm_name_lookups;
+
+	auto it = Bm_name_index.find(bm_name_index_key(real_filename));
+	if (it == Bm_name_index.end())
+		return 0;
 
-			if (entry.dir_type != dir_type)
-				continue;
+	// if there is more than one match, use the one in the first slot like a search through all slots would
+	bitmap_entry* found = nullptr;
 
-			bool animated = bm_is_anim(&entry);
+	for (auto candidate : it->second) {
+		if (found != nullptr && candidate > found->handle)
+			continue;
 
-			if (animated_type && !animated)
-				continue;
-			else if (!animated_type && animated)
-				continue;
+		auto entry = bm_get_entry(candidate);
+		if (entry->type == BM_TYPE_NONE)
+			continue;
 
-			if (!strextcmp(real_filename, entry.filename)) {
-				entry.load_count++;
-				*handle = entry.handle;
-				return 1;
-			}
-		}
+		if (entry->handle != candidate)
+			continue;
+
+		if (entry->dir_type != dir_type)
+			continue;
+
+		bool animated = bm_is_anim(entry);
+
+		if (animated_type && !animated)
+			continue;
+		else if (!animated_type && animated)
+			continue;
+
+		if (!strextcmp(real_filename, entry->filename))
+			found = entry;
 	}
 
 	// not found to be loaded already
-	return 0;
+	if (found == nullptr)
+		return 0;
+
+	++Bm_name_lookup_hits;
+
+	found->load_count++;
+	*handle = found->handle;
+	return 1;
 }
 
 int bm_load_sub_slow(const char *real_filename, const int num_ext, const char **ext_list, CFILE **img_cfp, int dir_type) {
@@ -2085,6 +2198,45 @@ bitmap * bm_lock(int handle, int bpp, uint flags, bool nodebug) {
 	return bmp;
 }
 
+/**
+ * Hands the image data decoded by bm_page_in_stop() to the bm_lock_* function of a bitmap
+ *
+ * @details The memory is accounted for like it would have been by bm_malloc()
+ *
+ * @returns the data, or nullptr if the bitmap wasn't decoded ahead of time and needs to be read now
+ */
+static ubyte* bm_take_staged_image(int handle, size_t size, int* bpp, int* error)
+{
+	for (auto& staged : Bm_staged_images) {
+		if (staged.handle != handle || staged.taken)
+			continue;
+
+		staged.taken = true;
+
+		// something changed about the bitmap since it was decoded, so don't trust the data
+		if (staged.size != size || staged.data == nullptr) {
+			return nullptr;
+		}
+
+#ifdef BMPMAN_NDEBUG
+		auto entry = bm_get_entry(handle);
+		Assert(entry->data_size == 0);
+		entry->data_size += size;
+		bm_texture_ram += size;
+#endif
+
+		auto data = staged.data;
+		staged.data = nullptr;
+
+		*bpp = staged.bpp;
+		*error = staged.error;
+
+		return data;
+	}
+
+	return nullptr;
+}
+
 void bm_lock_ani(int /*handle*/, bitmap_slot *bs, bitmap* /*bmp*/, int bpp, uint flags) {
 	anim				*the_anim;
 	anim_instance	*the_anim_instance;
@@ -2275,18 +2427,25 @@ void bm_lock_dds(int handle, bitmap_slot *bs, bitmap *bmp, int /*bpp*/, uint /*f
 	Assert(be->mem_taken > 0);
 	Assert(&be->bm == bmp);
 
-	data = (ubyte*)bm_malloc(handle, be->mem_taken);
+	int staged_bpp;
+	data = bm_take_staged_image(handle, be->mem_taken, &staged_bpp, &error);
 
-	if (data == NULL)
-		return;
+	if (data != nullptr) {
+		dds_bpp = (ubyte)staged_bpp;
+	} else {
+		data = (ubyte*)bm_malloc(handle, be->mem_taken);
 
-	memset(data, 0, be->mem_taken);
+		if (data == NULL)
+			return;
 
-	// make sure we are using the correct filename in the case of an EFF.
-	// this will populate filename[] whether it's EFF or not
-	EFF_FILENAME_CHECK;
+		memset(data, 0, be->mem_taken);
 
-	error = dds_read_bitmap(filename, data, &dds_bpp, be->dir_type);
+		// make sure we are using the correct filename in the case of an EFF.
+		// this will populate filename[] whether it's EFF or not
+		EFF_FILENAME_CHECK;
+
+		error = dds_read_bitmap(filename, data, &dds_bpp, be->dir_type);
+	}
 
 #if BYTE_ORDER == BIG_ENDIAN
 	// same as with TGA, we need to byte swap 16 & 32-bit, uncompressed, DDS images
@@ -2435,22 +2594,29 @@ void bm_lock_png(int handle, bitmap_slot *bs, bitmap *bmp, int /*bpp*/, uint /*f
 	//if it's not 32-bit, we expand when we read it
 	bmp->bpp = 32;
 	d_size = bmp->bpp >> 3;
-	//we waste memory if it turns out to be 24-bit, but the way this whole thing works is dodgy anyway
-	data = (ubyte*)bm_malloc(handle, bmp->w * bmp->h * d_size);
-	if (data == NULL)
-		return;
-	memset(data, 0, bmp->w * bmp->h * d_size);
-	bmp->data = (ptr_u)data;
-	bmp->palette = NULL;
 
-	Assert(&be->bm == bmp);
+	data = bm_take_staged_image(handle, static_cast<size_t>(bmp->w * bmp->h * d_size), &bmp->bpp, &png_error);
+	if (data != nullptr) {
+		bmp->data = (ptr_u)data;
+		bmp->palette = NULL;
+	} else {
+		//we waste memory if it turns out to be 24-bit, but the way this whole thing works is dodgy anyway
+		data = (ubyte*)bm_malloc(handle, bmp->w * bmp->h * d_size);
+		if (data == NULL)
+			return;
+		memset(data, 0, bmp->w * bmp->h * d_size);
+		bmp->data = (ptr_u)data;
+		bmp->palette = NULL;
 
-	// make sure we are using the correct filename in the case of an EFF.
-	// this will populate filename[] whether it's EFF or not
-	EFF_FILENAME_CHECK;
+		Assert(&be->bm == bmp);
 
-	//bmp->bpp gets set correctly in here after reading into memory
-	png_error = png_read_bitmap(filename, data, &bmp->bpp, d_size, be->dir_type);
+		// make sure we are using the correct filename in the case of an EFF.
+		// this will populate filename[] whether it's EFF or not
+		EFF_FILENAME_CHECK;
+
+		//bmp->bpp gets set correctly in here after reading into memory
+		png_error = png_read_bitmap(filename, data, &bmp->bpp, d_size, be->dir_type);
+	}
 
 	if (png_error != PNG_ERROR_NONE) {
 		bm_free_data(bs);
@@ -2486,12 +2652,20 @@ void bm_lock_tga(int handle, bitmap_slot *bs, bitmap *bmp, int bpp, uint flags)
 	Assert(byte_size);
 	Assert(be->mem_taken > 0);
 
-	data = (ubyte*)bm_malloc(handle, static_cast<size_t>(bmp->w * bmp->h * byte_size));
+	int tga_error;
+	int staged_bpp;
 
-	if (data) {
-		memset(data, 0, be->mem_taken);
-	} else {
-		return;
+	data = bm_take_staged_image(handle, static_cast<size_t>(bmp->w * bmp->h * byte_size), &staged_bpp, &tga_error);
+	bool staged = (data != nullptr);
+
+	if (!staged) {
+		data = (ubyte*)bm_malloc(handle, static_cast<size_t>(bmp->w * bmp->h * byte_size));
+
+		if (data) {
+			memset(data, 0, be->mem_taken);
+		} else {
+			return;
+		}
 	}
 
 	bmp->bpp = bpp;
@@ -2503,13 +2677,13 @@ void bm_lock_tga(int handle, bitmap_slot *bs, bitmap *bmp, int bpp, uint flags)
 	Assert(be->data_size > 0);
 #endif
 
-	int tga_error;
+	if (!staged) {
+		// make sure we are using the correct filename in the case of an EFF.
+		// this will populate filename[] whether it's EFF or not
+		EFF_FILENAME_CHECK;
 
-	// make sure we are using the correct filename in the case of an EFF.
-	// this will populate filename[] whether it's EFF or not
-	EFF_FILENAME_CHECK;
-
-	tga_error = targa_read_bitmap(filename, data, nullptr, byte_size, be->dir_type);
+		tga_error = targa_read_bitmap(filename, data, nullptr, byte_size, be->dir_type);
+	}
 
 	if (tga_error != TARGA_ERROR_NONE) {
 		bm_free_data(bs);
@@ -2622,6 +2796,8 @@ int bm_make_render_target(int width, int height, int flags) {
 
 	entry->handle = n;
 
+	bm_name_index_add(entry);
+
 	if (entry->mem_taken) {
 		entry->bm.data = (ptr_u)bm_malloc(n, entry->mem_taken);
 	}
@@ -2680,6 +2856,177 @@ void bm_page_in_start() {
 	gr_bm_page_in_start();
 }
 
+/**
+ * Checks if a bitmap which is going to be paged in can be decoded on a worker thread, and fills in what is needed for that
+ *
+ * @details Only the image readers without any global state are used here. Everything else (ANI, APNG, PCX, JPG, KTX) is
+ * still read on the main thread when it is locked.
+ */
+static bool bm_page_in_stage(const bitmap_entry& entry, bm_staged_image& staged)
+{
+	if (!entry.preloaded || entry.bm.data != 0 || entry.mem_taken == 0 || Is_standalone)
+		return false;
+
+	BM_TYPE type = (entry.type == BM_TYPE_EFF) ? entry.info.ani.eff.type : entry.type;
+
+	switch (type) {
+	case BM_TYPE_DDS:
+	case BM_TYPE_DXT1:
+	case BM_TYPE_DXT3:
+	case BM_TYPE_DXT5:
+	case BM_TYPE_BC7:
+	case BM_TYPE_CUBEMAP_DDS:
+	case BM_TYPE_CUBEMAP_DXT1:
+	case BM_TYPE_CUBEMAP_DXT3:
+	case BM_TYPE_CUBEMAP_DXT5:
+		staged.type = BM_TYPE_DDS;
+		staged.size = entry.mem_taken;
+		break;
+
+	case BM_TYPE_PNG:
+		if (entry.info.ani.apng.is_apng)
+			return false;
+
+		// same as in bm_lock_png()
+		staged.type = BM_TYPE_PNG;
+		staged.size = static_cast<size_t>(entry.bm.w * entry.bm.h * 4);
+		break;
+
+	case BM_TYPE_TGA:
+		// same as in bm_lock_tga()
+		staged.type = BM_TYPE_TGA;
+		staged.bpp = entry.bm.true_bpp;
+		staged.size = static_cast<size_t>(entry.bm.w * entry.bm.h * (staged.bpp >> 3));
+		break;
+
+	default:
+		return false;
+	}
+
+	if (staged.size == 0)
+		return false;
+
+	staged.handle = entry.handle;
+	staged.dir_type = entry.dir_type;
+	strcpy_s(staged.filename, (entry.type == BM_TYPE_EFF) ? entry.info.ani.eff.filename : entry.filename);
+
+	return true;
+}
+
+/**
+ * Reads a staged bitmap. This is run on the worker threads.
+ */
+static void bm_page_in_decode(bm_staged_image& staged)
+{
+	auto start = timer_get_nanoseconds();
+
+	staged.data = (ubyte*)vm_malloc(staged.size);
+	memset(staged.data, 0, staged.size);
+
+	switch (staged.type) {
+	case BM_TYPE_DDS: {
+		ubyte dds_bpp = 0;
+		staged.error = dds_read_bitmap(staged.filename, staged.data, &dds_bpp, staged.dir_type);
+		staged.bpp = dds_bpp;
+		break;
+	}
+
+	case BM_TYPE_PNG:
+		staged.bpp = 32;
+		staged.error = png_read_bitmap(staged.filename, staged.data, &staged.bpp, 4, staged.dir_type);
+		break;
+
+	case BM_TYPE_TGA:
+		staged.error = targa_read_bitmap(staged.filename, staged.data, nullptr, staged.bpp >> 3, staged.dir_type);
+		break;
+
+	default:
+		UNREACHABLE("Unhandled bitmap type %d in bm_page_in_decode!", staged.type);
+	}
+
+	staged.decode_time = timer_get_nanoseconds() - start;
+}
+
+/**
+ * Frees everything of the current batch which was not picked up by bm_lock()
+ */
+static void bm_page_in_free_staged()
+{
+	for (auto& staged : Bm_staged_images) {
+		if (staged.data != nullptr) {
+			vm_free(staged.data);
+		}
+	}
+
+	Bm_staged_images.clear();
+}
+
+/**
+ * Decodes the next batch of bitmaps, starting at the given entry, on the worker threads
+ *
+ * @returns the index of the first entry which is not part of the batch anymore
+ */
+static size_t bm_page_in_decode_batch(const SCP_vector<bitmap_entry*>& entries, size_t begin, SCP_map<BM_TYPE, bm_decode_stats>& stats)
+{
+	TRACE_SCOPE(tracing::PageInDecodeBitmaps);
+
+	bm_page_in_free_staged();
+
+	// a few bitmaps per thread keeps all of them busy without holding on to too much memory at once
+	const size_t batch_size = 4 * (threading::get_num_workers() + 1);
+
+	auto end = begin;
+	for (; end < entries.size() && Bm_staged_images.size() < batch_size; ++end) {
+		bm_staged_image staged;
+		if (bm_page_in_stage(*entries[end], staged)) {
+			Bm_staged_images.push_back(staged);
+		}
+	}
+
+	threading::parallel_for(0, Bm_staged_images.size(), 1, [](size_t b, size_t e) {
+		for (auto i = b; i < e; ++i) {
+			bm_page_in_decode(Bm_staged_images[i]);
+		}
+	});
+
+	for (const auto& staged : Bm_staged_images) {
+		auto& stat = stats[staged.type];
+		++stat.count;
+		stat.bytes += staged.size;
+		stat.decode_time += staged.decode_time;
+	}
+
+	return end;
+}
+
+static void bm_page_in_print_decode_stats(const SCP_map<BM_TYPE, bm_decode_stats>& stats, std::uint64_t wall_time)
+{
+	int total_count = 0;
+	size_t total_bytes = 0;
+
+	mprintf(("BMPMAN: Bitmaps decoded on %d threads while paging in:\n", (int)threading::get_num_workers() + 1));
+
+	for (const auto& entry : stats) {
+		const auto& stat = entry.second;
+		const double mb = stat.bytes / (1024.0 * 1024.0);
+		const double seconds = stat.decode_time / 1000000000.0;
+
+		const char* name = (entry.first == BM_TYPE_DDS) ? "DDS" : (entry.first == BM_TYPE_PNG) ? "PNG" : "TGA";
+
+		mprintf(("  %s: %d bitmaps, %.1f MB in %.1f ms of decoding, %.1f MB/s per thread\n", name,
+			stat.count, mb, seconds * 1000.0, (seconds > 0.0) ? mb / seconds : 0.0));
+
+		total_count += stat.count;
+		total_bytes += stat.bytes;
+	}
+
+	const double mb = total_bytes / (1024.0 * 1024.0);
+	const double seconds = wall_time / 1000000000.0;
+
+	mprintf(("  Total: %d bitmaps, %.1f MB in %.1f ms, %.1f MB/s\n", total_count, mb, seconds * 1000.0,
+		(seconds > 0.0) ? mb / seconds : 0.0));
+}
+
 void bm_page_in_stop() {
 	TRACE_SCOPE(tracing::PageInStop);
 
@@ -2694,52 +3041,78 @@ void bm_page_in_stop() {
 
 	int bm_preloading = 1;
 
+	SCP_vector<bitmap_entry*> entries;
 	for (auto& block : bm_blocks) {
 		for (auto& slot : block) {
-			auto& entry = slot.entry;
+			entries.push_back(&slot.entry);
+		}
+	}
+
+	// The image files are read and decoded in batches on the worker threads, ahead of the loop below which uploads them
+	// to the graphics API. bm_lock() picks up the decoded data instead of reading the file again.
+	const bool decode_threaded = threading::is_threading();
+	size_t decoded_until = 0;
+
+	SCP_map<BM_TYPE, bm_decode_stats> decode_stats;
+	std::uint64_t decode_wall_time = 0;
 
-			if ((entry.type != BM_TYPE_NONE) && (entry.type != BM_TYPE_RENDER_TARGET_DYNAMIC)
-				&& (entry.type != BM_TYPE_RENDER_TARGET_STATIC)) {
-				if (entry.preloaded) {
-					TRACE_SCOPE(tracing::PageInSingleBitmap);
-					if (bm_preloading) {
-						if (!gr_preload(entry.handle, (entry.preloaded == 2))) {
-							mprintf(("Out of VRAM.  Done preloading.\n"));
-							bm_preloading = 0;
-						}
-					} else {
-						bm_lock(entry.handle, (entry.used_flags == BMP_AABITMAP) ? 8 : 16, entry.used_flags);
-						if (entry.ref_count >= 1) {
-							bm_unlock(entry.handle);
-						}
+	for (size_t i = 0; i < entries.size(); ++i) {
+		auto& entry = *entries[i];
+
+		if (decode_threaded && i == decoded_until) {
+			auto start = timer_get_nanoseconds();
+			decoded_until = bm_page_in_decode_batch(entries, i, decode_stats);
+			decode_wall_time += timer_get_nanoseconds() - start;
+		}
+
+		if ((entry.type != BM_TYPE_NONE) && (entry.type != BM_TYPE_RENDER_TARGET_DYNAMIC)
+			&& (entry.type != BM_TYPE_RENDER_TARGET_STATIC)) {
+			if (entry.preloaded) {
+				TRACE_SCOPE(tracing::PageInSingleBitmap);
+				if (bm_preloading) {
+					if (!gr_preload(entry.handle, (entry.preloaded == 2))) {
+						mprintf(("Out of VRAM.  Done preloading.\n"));
+						bm_preloading = 0;
 					}
+				} else {
+					bm_lock(entry.handle, (entry.used_flags == BMP_AABITMAP) ? 8 : 16, entry.used_flags);
+					if (entry.ref_count >= 1) {
+						bm_unlock(entry.handle);
+					}
+				}
 
-					n++;
+				n++;
 
-					multi_send_anti_timeout_ping();
+				multi_send_anti_timeout_ping();
 
-					if ((entry.info.ani.first_frame == 0) || (entry.info.ani.first_frame == entry.handle)) {
+				if ((entry.info.ani.first_frame == 0) || (entry.info.ani.first_frame == entry.handle)) {
 #ifndef NDEBUG
-						memset(busy_text, 0, sizeof(busy_text));
+					memset(busy_text, 0, sizeof(busy_text));
 
-						strcat_s(busy_text, "** BmpMan: ");
-						strcat_s(busy_text, entry.filename);
-						strcat_s(busy_text, " **");
+					strcat_s(busy_text, "** BmpMan: ");
+					strcat_s(busy_text, entry.filename);
+					strcat_s(busy_text, " **");
 
-						game_busy(busy_text);
+					game_busy(busy_text);
 #else
-						game_busy();
+					game_busy();
 #endif
-					}
-				} else {
-					bm_unload_fast(entry.handle);
 				}
+			} else {
+				bm_unload_fast(entry.handle);
 			}
 		}
 	}
 
+	bm_page_in_free_staged();
+
 	nprintf(("BmpInfo", "BMPMAN: Loaded %d bitmaps that are marked as used for this level.\n", n));
 
+	// without a renderer there's no upload, so this is the time it takes to get the images from disk into memory
+	if (gr_screen.mode == GraphicsAPI::Stub && !decode_stats.empty()) {
+		bm_page_in_print_decode_stats(decode_stats, decode_wall_time);
+	}
+
 #ifndef NDEBUG
 	int total_bitmaps = 0;
 	int total_slots = 0;
@@ -2970,6 +3343,8 @@ int bm_release(int handle, int clear_render_targets) {
 		for (i = 0; i < total; i++) {
 			auto entry = bm_get_entry(first + i);
 
+			bm_name_index_remove(entry);
+
 			memset(entry, 0, sizeof(bitmap_entry));
 
 			entry->type = BM_TYPE_NONE;
@@ -2995,6 +3370,7 @@ int bm_release(int handle, int clear_render_targets) {
 
 		bm_free_data(slot, true);		// clears flags, bbp, data, etc
 
+		bm_name_index_remove(entry);
 
 		memset(entry, 0, sizeof(bitmap_entry));
 
@@ -3058,7 +3434,10 @@ int bm_reload(int bitmap_handle, const char* filename) {
 		return -1;
 	}
 
+	bm_name_index_remove(entry);
 	strcpy_s(entry->filename, filename);
+	bm_name_index_add(entry);
+
 	return bitmap_handle;
 }
 
@@ -28,6 +28,7 @@
 
 #include "cfile/cfile.h"
 #include "cfile/cfilearchive.h"
+#include "cfile/cfilecompression.h"
 #include "cfile/cfilesystem.h"
 #include "osapi/osapi.h"
 #include "parse/encrypt.h"
@@ -35,6 +36,7 @@
 
 
 #include <limits>
+#include <mutex>
 
 char Cfile_root_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
 char Cfile_user_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
@@ -96,6 +98,9 @@ static SCP_vector<SCP_string> Cfile_stack;
 
 std::array<CFILE, MAX_CFILE_BLOCKS> Cfile_block_list;
 
+// the blocks may be claimed and released from several threads, e.g. when bitmaps are decoded while paging in
+static std::mutex Cfile_block_mutex;
+
 static const char *Cfile_cdrom_dir = NULL;
 
 //
@@ -105,6 +110,7 @@ static int cfget_cfile_block();
 static CFILE *cf_open_fill_cfblock(const char* source, int line, const char* original_filename, FILE * fp, int type);
 static CFILE *cf_open_packed_cfblock(const char* source, int line, const char* original_filename, FILE *fp, int type, size_t offset, size_t size);
 static CFILE *cf_open_memory_fill_cfblock(const char* source, int line, const char* original_filename, const void* data, size_t size, int dir_type);
+static bool cf_is_compressed_data(const void *data, size_t size);
 
 static void cf_chksum_long_init();
 
@@ -759,7 +765,9 @@ CFILE *_cfopen_special(const char* source, int line, const CFileLocation &res, c
 	}
 
 	// In-Memory files are a bit different from normal files so we need to handle them separately
-	if (res.data_ptr != nullptr) {
+	// Files of a memory mapped pack file are in memory as well, unless they are compressed. These still go through the
+	// pack file itself since decompression works on the file pointer.
+	if (res.data_ptr != nullptr && !((res.offset > 0) && cf_is_compressed_data(res.data_ptr, res.size))) {
 		return cf_open_memory_fill_cfblock(source, line, res.name_ext.c_str(), res.data_ptr, res.size, dir_type);
 	}
 	else {
@@ -782,6 +790,18 @@ CFILE *_cfopen_special(const char* source, int line, const CFileLocation &res, c
 }
 
 
+// Same check as cf_check_compression(), on data which is in memory
+static bool cf_is_compressed_data(const void *data, size_t size)
+{
+	if (size <= 16)
+		return false;
+
+	int header;
+	memcpy(&header, data, sizeof(header));
+
+	return comp_check_header(INTEL_INT(header)) == COMP_HEADER_MATCH;
+}
+
 // ------------------------------------------------------------------------
 // ctmpfile() 
 //
@@ -814,6 +834,8 @@ static int cfget_cfile_block()
 	int i;
 	CFILE* cfile;
 
+	std::lock_guard<std::mutex> guard(Cfile_block_mutex);
+
 	for ( i = 0; i < MAX_CFILE_BLOCKS; i++ ) {
 		cfile = &Cfile_block_list[i];
 		if (cfile->type == CFILE_BLOCK_UNUSED) {
@@ -857,6 +879,8 @@ int cfclose( CFILE * cfile )
 		// VP  do nothing
 	}
 	cf_clear_compression_info(cfile);
+
+	std::lock_guard<std::mutex> guard(Cfile_block_mutex);
 	cfile->type = CFILE_BLOCK_UNUSED;
 	return result;
 }
@@ -229,6 +229,12 @@ int cfilelength(CFILE *fp);
 // Reads data
 int cfread(void *buf, int elsize, int nelem, CFILE *fp);
 
+// Returns a pointer to the next len bytes of the file and skips over them, without copying anything.  This only works
+// for files which are in memory, like files in a memory mapped pack file (-mmap_vps).  For any other file, or if
+// there are less than len bytes left, nullptr is returned and the caller has to fall back to cfread().
+// The pointer must not be used after the file is closed.
+const void *cfread_span(CFILE *fp, size_t len);
+
 // cfwrite() writes to the file
 int cfwrite(const void *buf, int elsize, int nelem, CFILE *cfile);
 
@@ -258,6 +258,33 @@ int cfread(void *buf, int elsize, int nelem, CFILE *cfile)
 	return (int)(bytes_read / elsize);
 }
 
+// cfread_span() returns a pointer to the next len bytes and advances past them
+//
+// returns:   success ==> pointer into the data of the file
+//            error   ==> nullptr if the file isn't in memory or doesn't have len bytes left
+//
+const void *cfread_span(CFILE *cfile, size_t len)
+{
+	if (!cf_is_valid(cfile))
+		return nullptr;
+
+	// compressed files are never read from memory, so there's nothing to check for them here
+	if (cfile->data == nullptr)
+		return nullptr;
+
+	if ( (cfile->raw_position+len) > cfile->size )
+		return nullptr;
+
+	// let cfread() deal with the error handling for this
+	if ( cfile->max_read_len && (cfile->raw_position+len > cfile->max_read_len) )
+		return nullptr;
+
+	auto span = reinterpret_cast<const ubyte*>(cfile->data) + cfile->raw_position;
+	cfile->raw_position += len;
+
+	return span;
+}
+
 int cfread_lua_number(double *buf, CFILE *cfile)
 {
 	if(!cf_is_valid(cfile))
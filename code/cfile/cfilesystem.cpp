@@ -28,7 +28,9 @@
 #ifdef SCP_UNIX
 #include <sys/types.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <fnmatch.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <libgen.h>
@@ -48,6 +50,27 @@ enum CfileRootType {
 	CF_ROOTTYPE_MEMORY = 2,
 };
 
+// A read-only memory mapping of a whole pack file (see -mmap_vps).  If the file can't be mapped, data() is nullptr.
+class cf_pack_mapping {
+  public:
+	explicit cf_pack_mapping(const SCP_string &path);
+	~cf_pack_mapping();
+
+	cf_pack_mapping(const cf_pack_mapping&) = delete;
+	cf_pack_mapping& operator=(const cf_pack_mapping&) = delete;
+
+	const ubyte *data() const { return m_data; }
+	size_t size() const { return m_size; }
+
+  private:
+	const ubyte *m_data = nullptr;
+	size_t m_size = 0;
+
+#ifdef _WIN32
+	HANDLE m_mapping = nullptr;
+#endif
+};
+
 //  Created by:
 //    specifying hard drive tree
 //    searching for pack files on hard drive		// Found by searching all known paths
@@ -63,6 +86,8 @@ typedef struct cf_root {
 	SCP_unordered_map<int, SCP_string> pathTypeToRealPath;
 #endif
 
+	std::unique_ptr<cf_pack_mapping> mapping;	// for pack files opened with -mmap_vps
+
 	cf_root() : roottype(-1), location_flags(0) {}
 } cf_root;
 
@@ -116,6 +141,11 @@ typedef struct cf_file_block {
 static uint Num_files = 0;
 static SCP_vector<std::unique_ptr<cf_file_block>> File_blocks;
 
+// Index of all files by their case insensitive name.  Each entry lists the indices of the files with that name in
+// the order they were found, which is also their order of precedence.
+static SCP_unordered_map<SCP_string, SCP_vector<uint>, SCP_string_lcase_hash, SCP_string_lcase_equal_to> File_name_index;
+static uint Num_indexed_files = 0;
+
 // Return a pointer to to file 'index'.
 cf_file *cf_get_file(int index)
 {
@@ -149,6 +179,35 @@ cf_file *cf_create_file()
 	return &File_blocks[block]->files[offset];
 }
 
+// Adds all files which were created since the last call to the name index.  While the file list is being built
+// this is done lazily when a lookup needs it, once it is complete the index is never modified.
+static void cf_update_file_index()
+{
+	for (; Num_indexed_files < Num_files; ++Num_indexed_files) {
+		File_name_index[cf_get_file(Num_indexed_files)->name_ext].push_back(Num_indexed_files);
+	}
+}
+
+static void cf_clear_file_index()
+{
+	File_name_index.clear();
+	Num_indexed_files = 0;
+}
+
+// Returns the indices of all files with the given name (case insensitive) in order of precedence, or nullptr if
+// there are none
+static const SCP_vector<uint> *cf_find_indexed_files(const SCP_string &name_ext)
+{
+	cf_update_file_index();
+
+	auto it = File_name_index.find(name_ext);
+	if (it == File_name_index.end()) {
+		return nullptr;
+	}
+
+	return &it->second;
+}
+
 extern int cfile_inited;
 
 // Create a new root and return a pointer to it.  The structure is assumed unitialized.
@@ -795,7 +854,13 @@ static void check_file_shadows(const int root_index __UNUSED, const int pathtype
 	newfile += cf_get_root_pathtype(root, pathtype) + DIR_SEPARATOR_CHAR;
 	newfile += sub_path + (real_name ? real_name : name);
 
-	for (uint i = 0; i < Num_files; ++i) {
+	const auto candidates = cf_find_indexed_files(name);
+
+	if (candidates == nullptr) {
+		return;
+	}
+
+	for (auto i : *candidates) {
 		const auto f = cf_get_file(i);
 		const auto r = cf_get_root(f->root_index);
 
@@ -945,6 +1010,70 @@ typedef struct VP_FILE {
 	_fs_time_t write_time;
 } VP_FILE;
 
+cf_pack_mapping::cf_pack_mapping(const SCP_string &path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+		// the mapping keeps the file open on its own
+		m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+
+	CloseHandle(file);
+
+	if (m_mapping == nullptr) {
+		return;
+	}
+
+	auto view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+		return;
+	}
+
+	m_data = static_cast<const ubyte*>(view);
+	m_size = static_cast<size_t>(file_size.QuadPart);
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+
+	struct stat buf;
+	if (fstat(fd, &buf) == 0 && buf.st_size > 0) {
+		// the mapping keeps the file open on its own
+		auto view = mmap(nullptr, static_cast<size_t>(buf.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+		if (view != MAP_FAILED) {
+			m_data = static_cast<const ubyte*>(view);
+			m_size = static_cast<size_t>(buf.st_size);
+		}
+	}
+
+	close(fd);
+#endif
+}
+
+cf_pack_mapping::~cf_pack_mapping()
+{
+	if (m_data == nullptr) {
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+#else
+	munmap(const_cast<ubyte*>(m_data), m_size);
+#endif
+}
+
 static int cf_add_pack_files(const int root_index, SCP_vector<_file_list_t> &files)
 {
 	if (files.empty()) {
@@ -1098,6 +1227,15 @@ void cf_search_root_pack(int root_index)
 
 	fclose(fp);
 
+	if (Cmdline_mmap_vps && (num_files > 0)) {
+		root->mapping.reset(new cf_pack_mapping(root->path));
+
+		if (root->mapping->data() == nullptr) {
+			mprintf(( "Could not memory map '%s', reading it normally... ", root->path.c_str() ));
+			root->mapping.reset();
+		}
+	}
+
 	mprintf(( "%i files\n", num_files ));
 }
 
@@ -1149,6 +1287,7 @@ void cf_build_file_list()
 	int i;
 
 	Num_files = 0;
+	cf_clear_file_index();
 
 	// For each root, find all files...
 	for (i=0; i<Num_roots; i++ )	{
@@ -1162,6 +1301,9 @@ void cf_build_file_list()
 		}
 	}
 
+	// complete the index now so that lookups don't have to modify it anymore
+	cf_update_file_index();
+
 #ifndef NDEBUG
 	// if some special/critical files might be shadowed then make sure the user knows about it
 	if ( !critical_shadowed.empty() && !running_unittests ) {
@@ -1208,6 +1350,7 @@ void cf_free_secondary_filelist()
 	// Free the file blocks
 	File_blocks.clear();
 	Num_files = 0;
+	cf_clear_file_index();
 }
 
 static bool is_absolute_path(const char *path)
@@ -1254,6 +1397,37 @@ static time_t get_mtime(int fd)
 	return buf.st_mtime;
 }
 
+// Fills in where the contents of an indexed file can be found
+static void cf_fill_file_location(CFileLocation &res, const cf_file *f)
+{
+	res.size = static_cast<size_t>(f->size);
+	res.offset = (size_t)f->pack_offset;
+	res.data_ptr = f->data;
+	res.name_ext = f->name_ext;
+	res.m_time = f->write_time;
+
+	if (f->data != nullptr) {
+		// This is an in-memory file so we just copy the pathtype name + file name
+		res.full_name = Pathtypes[f->pathtype_index].path;
+		res.full_name += DIR_SEPARATOR_STR;
+		res.full_name += f->sub_path;
+		res.full_name += f->name_ext;
+	} else if (f->pack_offset < 1) {
+		// This is a real file, return the actual file path
+		res.full_name = f->real_name;
+	} else {
+		// File is in a pack file
+		cf_root *r = cf_get_root(f->root_index);
+
+		res.full_name = r->path;
+
+		// if the pack file is mapped, the file can be read from memory
+		if (r->mapping && (res.offset + res.size <= r->mapping->size())) {
+			res.data_ptr = r->mapping->data() + res.offset;
+		}
+	}
+}
+
 /**
  * Searches for a file.
  *
@@ -1380,8 +1554,14 @@ CFileLocation cf_find_file_location(const char* filespec, int pathtype, uint32_t
 	}
 
 	// Search the pak files and CD-ROM.
-	for (ui = 0; ui < Num_files; ui++ )	{
-		cf_file *f = cf_get_file(ui);
+	const auto candidates = cf_find_indexed_files(filename);
+
+	if (candidates == nullptr) {
+		return CFileLocation();
+	}
+
+	for (auto index : *candidates) {
+		cf_file *f = cf_get_file(index);
 
 		// only search paths we're supposed to...
 		if ( (pathtype != CF_TYPE_ANY) && (pathtype != f->pathtype_index) )
@@ -1401,46 +1581,21 @@ CFileLocation cf_find_file_location(const char* filespec, int pathtype, uint32_t
 			continue;
 		}
 
-		// file either not localized or localized version not found
-		if ( !stricmp(filename.c_str(), f->name_ext.c_str()) ) {
-			CFileLocation res(true);
-			res.size = static_cast<size_t>(f->size);
-			res.offset = (size_t)f->pack_offset;
-			res.data_ptr = f->data;
-			res.name_ext = f->name_ext;
-			res.m_time = f->write_time;
-
-			if (f->data != nullptr) {
-				// This is an in-memory file so we just copy the pathtype name + file name
-				res.full_name = Pathtypes[f->pathtype_index].path;
-				res.full_name += DIR_SEPARATOR_STR;
-				res.full_name += f->sub_path;
-				res.full_name += f->name_ext;
-			} else if (f->pack_offset < 1) {
-				// This is a real file, return the actual file path
-				res.full_name = f->real_name;
-			} else {
-				// File is in a pack file
-				cf_root *r = cf_get_root(f->root_index);
-
-				res.full_name = r->path;
-			}
+		// the index only holds files with the right name, so the first one that's left is the one with the highest precedence
+		CFileLocation res(true);
+		cf_fill_file_location(res, f);
 
-			return res;
-		}
+		return res;
 	}
 		
 	return CFileLocation();
 }
 
-// -- from parselo.cpp --
-extern char *stristr(char *str, const char *substr);
-
 /**
  * Searches for a file.
  *
  * @note Follows all rules and precedence and searches CD's and pack files. Searches all locations in order for first filename using filter list.
- * @note This function is exponentially slow, so don't use it unless truely needed
+ * @note This checks the file index once per extension, so don't use it unless truely needed
  *
  * @param filename      Filename & extension
  * @param ext_num       Number of extensions to look for
@@ -1567,11 +1722,27 @@ CFileLocationExt cf_find_file_location_ext(const char *filename, const int ext_n
 	int last_root_index = -1;
 	int last_path_index = -1;
 
-	file_list_index.reserve( MIN(ext_num * 4, (int)Num_files) );
+	// gather all files with one of our names, back in order of precedence
+	SCP_vector<uint> candidates;
+
+	for (cur_ext = 0; cur_ext < ext_num; cur_ext++) {
+		filespec_ext = filespec + ext_list[cur_ext];
+
+		auto files = cf_find_indexed_files(filespec_ext);
+
+		if (files != nullptr) {
+			candidates.insert(candidates.end(), files->begin(), files->end());
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	file_list_index.reserve( candidates.size() );
 
 	// next, run though and pick out base matches
-	for (ui = 0; ui < Num_files; ui++) {
-		cf_file *f = cf_get_file(ui);
+	for (auto index : candidates) {
+		cf_file *f = cf_get_file(index);
 
 		// ... only search paths that we're supposed to
 		if ( (num_search_dirs == 1) && (pathtype != f->pathtype_index) )
@@ -1586,22 +1757,6 @@ CFileLocationExt cf_find_file_location_ext(const char *filename, const int ext_n
 		if (f->name_ext.length() != filespec_len_big )
 			continue;
 
-		// ... check that we match the base filename
-		if ( strnicmp(f->name_ext.c_str(), filespec.c_str(), filespec.length()) != 0 )
-			continue;
-
-		// ... make sure that it's one of our supported types
-		bool found_one = false;
-		for (cur_ext = 0; cur_ext < ext_num; cur_ext++) {
-			if ( stristr(f->name_ext.c_str(), ext_list[cur_ext]) ) {
-				found_one = true;
-				break;
-			}
-		}
-
-		if ( !found_one )
-			continue;
-
 		// ... we check based on location, so if location changes after the first find then bail
 		if (last_root_index == -1) {
 			last_root_index = f->root_index;
@@ -1629,27 +1784,7 @@ CFileLocationExt cf_find_file_location_ext(const char *filename, const int ext_n
 			if ( !stricmp(filespec_ext.c_str(), f->name_ext.c_str()) ) {
 				CFileLocationExt res(cur_ext);
 				res.found = true;
-				res.size = static_cast<size_t>(f->size);
-				res.offset = (size_t)f->pack_offset;
-				res.data_ptr = f->data;
-				res.name_ext = f->name_ext;
-				res.m_time = f->write_time;
-
-				if (f->data != nullptr) {
-					// This is an in-memory file so we just copy the pathtype name + file name
-					res.full_name = Pathtypes[f->pathtype_index].path;
-					res.full_name += DIR_SEPARATOR_STR;
-					res.full_name += f->sub_path;
-					res.full_name += f->name_ext;
-				} else if (f->pack_offset < 1) {
-					// This is a real file, return the actual file path
-					res.full_name = f->real_name;
-				} else {
-					// File is in a pack file
-					cf_root *r = cf_get_root(f->root_index);
-
-					res.full_name = r->path;
-				}
+				cf_fill_file_location(res, f);
 
 				// found it, so cleanup and return
 				file_list_index.clear();
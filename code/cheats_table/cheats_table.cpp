@@ -51,6 +51,7 @@ void SpawnShipCheat::runCheat() {
 			
 			ship *shipp = &Ships[Objects[objnum].instance];
 			shipp->ship_name[0] = '\0';
+			ship_name_changed(Objects[objnum].instance);
 			shipp->display_name.clear();
 			for (size_t j = 0; j < Player_orders.size(); j++)
 				shipp->orders_accepted.insert(j);
@@ -63,6 +64,7 @@ void SpawnShipCheat::runCheat() {
 				if ( (ship_name_lookup(name) == -1) && (ship_find_exited_ship_by_name(name) == -1) )
 				{
 					strcpy_s(shipp->ship_name, name);
+					ship_name_changed(Objects[objnum].instance);
 					break;
 				}
 
@@ -245,6 +245,11 @@ Flag exe_params[] =
 
 	//flag					launcher text								FSO		on_flags							off_flags						category		reference URL
 	{ "-voicer",			"Enable voice recognition",					true,	0,									EASY_DEFAULT,					"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-voicer", },
+	{ "-threaded_physics",	"Run physics on the worker threads",			true,	0,									EASY_DEFAULT,					"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-threaded_physics", },
+	{ "-threaded_particles",	"Run particles on the worker threads",		true,	0,									EASY_DEFAULT,					"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-threaded_particles", },
+	{ "-threaded_shadows",	"Build shadow lists on worker threads",		true,	0,									EASY_DEFAULT,					"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-threaded_shadows", },
+	{ "-mmap_vps",			"Memory map VP files",						true,	0,									EASY_DEFAULT,					"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-mmap_vps", },
+	{ "-model_cache",		"Cache preprocessed models on disk",		true,	0,									EASY_DEFAULT,					"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-model_cache", },
 
 	//flag					launcher text								FSO		on_flags							off_flags						category		reference URL
 	{ "-override_data",		"Enable override directory",				false,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-override_data", },
@@ -275,6 +280,8 @@ Flag exe_params[] =
 	{ "-gr_debug",		"Output graphics debug information",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-gr_debug", },
 	{ "-stdout_log",		"Output log file to stdout",				true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-stdout_log", },
 	{ "-slow_frames_ok",	"Don't adjust timestamps for slow frames",	true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-slow_frames_ok", },
+	{ "-check_transforms",	"Cross-check cached submodel transforms",	true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-check_transforms", },
+	{ "-verify_model_cache",	"Compare cached models with rebuilt ones",	true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-verify_model_cache", },
 	{ "-imgui_debug",		"Show imgui debug/demo window in the lab",  true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-imgui_debug", },
 	{ "-luadev",			"Make lua errors non-fatal",				true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-luadev", },
 	{"-vulkan",			"Use vulkan render backend",				true,	0,									  EASY_DEFAULT,				"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-vulkan", },
@@ -532,6 +539,8 @@ cmdline_parm graphics_debug_output_arg("-gr_debug", nullptr, AT_NONE); // Cmdlin
 cmdline_parm gr_sync_validation_arg("-gr_sync_validation", nullptr, AT_NONE); // Cmdline_gr_sync_validation (implies -gr_debug)
 cmdline_parm log_to_stdout_arg("-stdout_log", nullptr, AT_NONE); // Cmdline_log_to_stdout
 cmdline_parm slow_frames_ok_arg("-slow_frames_ok", nullptr, AT_NONE);	// Cmdline_slow_frames_ok
+cmdline_parm check_transforms_arg("-check_transforms", nullptr, AT_NONE);	// Cmdline_check_transforms
+cmdline_parm verify_model_cache_arg("-verify_model_cache", nullptr, AT_NONE);	// Cmdline_verify_model_cache
 cmdline_parm fixed_seed_rand("-seed", nullptr, AT_INT);	// Cmdline_rng_seed,Cmdline_reuse_rng_seed;
 cmdline_parm luadev_arg("-luadev", "Make lua errors non-fatal", AT_NONE);	// Cmdline_lua_devmode
 cmdline_parm override_arg("-override_data", "Enable override directory", AT_NONE);	// Cmdline_override_data
@@ -539,6 +548,11 @@ cmdline_parm imgui_debug_arg("-imgui_debug", nullptr, AT_NONE);
 cmdline_parm vulkan("-vulkan", nullptr, AT_NONE);
 cmdline_parm opengl("-opengl", nullptr, AT_NONE);
 cmdline_parm multithreading("-threads", nullptr, AT_INT);
+cmdline_parm threaded_physics_arg("-threaded_physics", nullptr, AT_NONE);	// Cmdline_threaded_physics
+cmdline_parm threaded_particles_arg("-threaded_particles", nullptr, AT_NONE);	// Cmdline_threaded_particles
+cmdline_parm threaded_shadows_arg("-threaded_shadows", nullptr, AT_NONE);	// Cmdline_threaded_shadows
+cmdline_parm mmap_vps_arg("-mmap_vps", nullptr, AT_NONE);	// Cmdline_mmap_vps
+cmdline_parm model_cache_arg("-model_cache", nullptr, AT_NONE);	// Cmdline_model_cache
 
 char *Cmdline_start_mission = NULL;
 int Cmdline_dis_collisions = 0;
@@ -574,11 +588,18 @@ bool Cmdline_graphics_debug_output = false;
 bool Cmdline_gr_sync_validation = false;
 bool Cmdline_log_to_stdout = false;
 bool Cmdline_slow_frames_ok = false;
+bool Cmdline_check_transforms = false;
+bool Cmdline_verify_model_cache = false;
 bool Cmdline_lua_devmode = false;
 bool Cmdline_override_data = false;
 bool Cmdline_show_imgui_debug = false;
 GraphicsAPI Cmdline_graphics_api = GraphicsAPI::Default;
 int Cmdline_multithreading = 1;
+bool Cmdline_threaded_physics = false;
+bool Cmdline_threaded_particles = false;
+bool Cmdline_threaded_shadows = false;
+bool Cmdline_mmap_vps = false;
+bool Cmdline_model_cache = false;
 
 // Other
 cmdline_parm get_flags_arg(GET_FLAGS_STRING, "Output the launcher flags file", AT_STRING);
@@ -2353,6 +2374,15 @@ bool SetCmdlineParams()
 	if (slow_frames_ok_arg.found()) {
 		Cmdline_slow_frames_ok = true;
 	}
+
+	if (check_transforms_arg.found()) {
+		Cmdline_check_transforms = true;
+	}
+
+	if (verify_model_cache_arg.found()) {
+		Cmdline_verify_model_cache = true;
+	}
+
 	if ( luadev_arg.found()) {
 		Cmdline_lua_devmode = true;
 	}
@@ -2455,6 +2485,26 @@ bool SetCmdlineParams()
 		Cmdline_multithreading = abs(multithreading.get_int());
 	}
 
+	if (threaded_physics_arg.found()) {
+		Cmdline_threaded_physics = true;
+	}
+
+	if (threaded_particles_arg.found()) {
+		Cmdline_threaded_particles = true;
+	}
+
+	if (threaded_shadows_arg.found()) {
+		Cmdline_threaded_shadows = true;
+	}
+
+	if (mmap_vps_arg.found()) {
+		Cmdline_mmap_vps = true;
+	}
+
+	if (model_cache_arg.found()) {
+		Cmdline_model_cache = true;
+	}
+
 	return true; 
 }
 
@@ -157,11 +157,18 @@ extern bool Cmdline_graphics_debug_output;
 extern bool Cmdline_gr_sync_validation;
 extern bool Cmdline_log_to_stdout;
 extern bool Cmdline_slow_frames_ok;
+extern bool Cmdline_check_transforms;
+extern bool Cmdline_verify_model_cache;
 extern bool Cmdline_lua_devmode;
 extern bool Cmdline_override_data;
 extern bool Cmdline_show_imgui_debug;
 extern GraphicsAPI Cmdline_graphics_api;
 extern int Cmdline_multithreading;
+extern bool Cmdline_threaded_physics;
+extern bool Cmdline_threaded_particles;
+extern bool Cmdline_threaded_shadows;
+extern bool Cmdline_mmap_vps;
+extern bool Cmdline_model_cache;
 
 enum class WeaponSpewType { NONE = 0, STANDARD, ALL };
 extern WeaponSpewType Cmdline_spew_weapon_stats;
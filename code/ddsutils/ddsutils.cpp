@@ -403,9 +403,6 @@ Done:
 	return retval;
 }
 
-static void (*decompress_dds)(const void *in, void *out, int pitch) = nullptr;
-static uint32_t BLOCK_SIZE = 0;
-
 //reads pixel info from a dds file
 int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 {
@@ -450,11 +447,16 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 		cfread(data, 1, (int)size, cfp);
 	} else {
 		// Compression format not supported, convert to BGRA
-		ubyte *comp_data = (ubyte*)vm_malloc(size);
-
-		cfread(comp_data, 1, (int)size, cfp);
+		// (if the file is in memory, decompress it from there instead of making a copy first)
+		ubyte *comp_data = nullptr;
+		auto src = static_cast<const ubyte*>(cfread_span(cfp, size));
+
+		if (src == nullptr) {
+			comp_data = (ubyte*)vm_malloc(size);
+			cfread(comp_data, 1, (int)size, cfp);
+			src = comp_data;
+		}
 
-		ubyte *src = comp_data;
 		ubyte *dst = data;
 
 		uint d_width, d_height, d_depth;
@@ -467,6 +469,10 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 		const int num_faces = (dds_header.dwCaps2 & DDSCAPS2_CUBEMAP) ? 6 : 1;
 		const bool has_depth = (dds_header.dwFlags & DDSD_DEPTH) == DDSD_DEPTH;
 
+		// these are local since bitmaps may be read on several threads at once while paging in
+		void (*decompress_dds)(const void *in, void *out, int pitch) = nullptr;
+		uint32_t BLOCK_SIZE = 0;
+
 		switch (dds_header.ddspf.dwFourCC) {
 			case FOURCC_DX10:
 				decompress_dds = bcdec_bc7;
@@ -528,8 +534,10 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 			}
 		}
 
-		vm_free(comp_data);
-		comp_data = nullptr;
+		if (comp_data != nullptr) {
+			vm_free(comp_data);
+			comp_data = nullptr;
+		}
 
 		// switch to uncompressed format and reset vars (needed below to get correct bit count)
 		dds_header.ddspf.dwFlags &= ~DDPF_FOURCC;
@@ -619,16 +627,22 @@ int dds_decompress_top_mip_bgra(const char *filename, int cf_type,
 	// _dds_read_header leaves the file positioned right after the header
 	// (including the DX10 sub-header if present), so the next read is the
 	// top mip's pixel data.
-	SCP_vector<ubyte> compressed(compressed_size);
-	const int got = cfread(compressed.data(), 1, static_cast<int>(compressed_size), cfp);
-	cfclose(cfp);
-	if (got != static_cast<int>(compressed_size))
-		return DDS_ERROR_INVALID_FORMAT;
+	// If the file is in memory it is decoded from there, the file is only closed once decoding is done.
+	SCP_vector<ubyte> compressed;
+	auto src = static_cast<const ubyte*>(cfread_span(cfp, compressed_size));
+	if (src == nullptr) {
+		compressed.resize(compressed_size);
+		const int got = cfread(compressed.data(), 1, static_cast<int>(compressed_size), cfp);
+		if (got != static_cast<int>(compressed_size)) {
+			cfclose(cfp);
+			return DDS_ERROR_INVALID_FORMAT;
+		}
+		src = compressed.data();
+	}
 
 	// Decode into a padded buffer so edge blocks have room, then crop to w*h.
 	SCP_vector<ubyte> decoded(static_cast<size_t>(padded_w) * padded_h * 4);
 	const int dec_stride = padded_w * 4;
-	const ubyte *src = compressed.data();
 
 	for (int by = 0; by < blocks_h; ++by) {
 		for (int bx = 0; bx < blocks_w; ++bx) {
@@ -638,6 +652,8 @@ int dds_decompress_top_mip_bgra(const char *filename, int cf_type,
 		}
 	}
 
+	cfclose(cfp);
+
 	out_pixels.assign(static_cast<size_t>(w) * h * 4, 0);
 	const int dst_stride = w * 4;
 	for (int y = 0; y < h; ++y) {
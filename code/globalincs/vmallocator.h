@@ -2,6 +2,8 @@
 #define _VMALLOCATOR_H_INCLUDED_
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <deque>
 #include <iterator>
 #include <list>
@@ -205,14 +207,22 @@ template<typename T> SCP_multiset(std::initializer_list<T>) -> SCP_multiset<T>;
 template <typename T>
 using SCP_hash = std::hash<T>;
 
+// FNV-1a over the lowercased characters, so that hashing doesn't need a lowercase copy of the string
 struct SCP_string_lcase_hash {
 	size_t operator()(const SCP_string& elem) const {
-		SCP_string lcase_copy;
-		std::transform(elem.begin(), elem.end(), std::back_inserter(lcase_copy),
-			[](char c) {
-				return SCP_tolower(c);
-			});
-		return SCP_hash<SCP_string>()(lcase_copy);
+		return hash(elem.c_str(), elem.size());
+	}
+	size_t operator()(const char* elem) const {
+		return hash(elem, strlen(elem));
+	}
+
+	static size_t hash(const char* str, size_t len) {
+		uint64_t h = 14695981039346656037ull;
+		for (size_t i = 0; i < len; ++i) {
+			h ^= static_cast<unsigned char>(SCP_tolower(str[i]));
+			h *= 1099511628211ull;
+		}
+		return static_cast<size_t>(h);
 	}
 };
 
@@ -2988,7 +2988,7 @@ void poly_list::calculate_tangent()
 	}
 }
 
-static poly_list buffer_list_internal;
+static thread_local poly_list buffer_list_internal;
 
 void poly_list::make_index_buffer(SCP_vector<int> &vertex_list)
 {
@@ -99,8 +99,11 @@ public:
 
 	void add_submodel_to_batch(int model_num)
 	{
-		matrix4 transform = _transforms.get_transform();
+		add_submodel_to_batch(_transforms.get_transform(), model_num);
+	}
 
+	void add_submodel_to_batch(matrix4 transform, int model_num)
+	{
 		vm_vec_scale(&transform.vec.rvec, _scale.xyz.x);
 		vm_vec_scale(&transform.vec.uvec, _scale.xyz.y);
 		vm_vec_scale(&transform.vec.fvec, _scale.xyz.z);
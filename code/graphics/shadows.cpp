@@ -29,6 +29,7 @@
 #include "render/3d.h"
 #include "tracing/tracing.h"
 #include "util/uniform_structs.h"
+#include "utils/threading.h"
 
 extern vec3d check_offsets[8];
 
@@ -811,6 +812,120 @@ static void render_viewer_shadow(object* objp, const matrix* light_matrix,
 	}
 }
 
+// An object whose shadow is drawn this frame, along with what it adds to the shadow list
+struct shadow_caster {
+	ship* blowup_ship = nullptr;	// large ships which are blowing up are drawn by shipfx instead
+
+	polymodel* pm = nullptr;
+	polymodel_instance* pmi = nullptr;
+	int obj_num = -1;
+	const vec3d* pos = nullptr;
+	const matrix* orient = nullptr;
+	vec3d view_pos_local;
+
+	bool has_clip = false;
+	shadow_render_list::clip_plane_info clip;
+
+	shadow_render_list::model_draw_plan plan;
+};
+
+// objects in one chunk of the culling work
+static const size_t Shadow_cull_chunk_size = 64;
+
+static SCP_vector<ubyte> Shadow_caster_visible;
+// kept around between frames so that the plans don't have to allocate again, only the first Num_shadow_casters are used
+static SCP_vector<shadow_caster> Shadow_casters;
+static size_t Num_shadow_casters = 0;
+
+// Works out which model objp casts its shadow with, everything which has to be done on the main thread
+static void add_shadow_caster(object* objp, const vec3d* eye_pos)
+{
+	if (Num_shadow_casters == Shadow_casters.size())
+		Shadow_casters.emplace_back();
+
+	auto& caster = Shadow_casters[Num_shadow_casters];
+	caster.blowup_ship = nullptr;
+	caster.pmi = nullptr;
+	caster.has_clip = false;
+
+	switch (objp->type) {
+	case OBJ_SHIP: {
+		if (objp == Viewer_obj) {
+			return;
+		}
+
+		ship* shipp = &Ships[objp->instance];
+
+		if (shipp->large_ship_blowup_index >= 0) {
+			caster.blowup_ship = shipp;
+			break;
+		}
+
+		model_clear_instance(Ship_info[shipp->ship_info_index].model_num);
+
+		caster.has_clip = shadow_obj_clip_plane(objp, &caster.clip);
+
+		caster.pm = model_get(Ship_info[shipp->ship_info_index].model_num);
+		if (shipp->model_instance_num >= 0) {
+			caster.pmi = model_get_instance(shipp->model_instance_num);
+		}
+		caster.obj_num = OBJ_INDEX(objp);
+		break;
+	}
+
+	case OBJ_RAW_POF:
+	case OBJ_PROP: {
+		int model_num = object_get_model_num(objp);
+		caster.pm = model_get(model_num);
+		model_clear_instance(model_num);
+
+		int instance_num = object_get_model_instance_num(objp);
+		if (instance_num >= 0) {
+			caster.pmi = model_get_instance(instance_num);
+		}
+		caster.obj_num = OBJ_INDEX(objp);
+		break;
+	}
+
+	case OBJ_ASTEROID: {
+		int num = objp->instance;
+		auto* ast = &Asteroids[num];
+		int model_num = Asteroid_info[ast->asteroid_type].subtypes[ast->asteroid_subtype].model_number;
+		model_clear_instance(model_num);
+		caster.pm = model_get(model_num);
+		caster.obj_num = OBJ_INDEX(objp);
+		break;
+	}
+
+	case OBJ_DEBRIS: {
+		debris* db = &Debris[objp->instance];
+		if ( !(db->flags[Debris_Flags::Used]) ) return;
+
+		caster.pm = model_get(db->model_num);
+		if (db->model_instance_num >= 0) {
+			caster.pmi = model_get_instance(db->model_instance_num);
+		}
+		caster.obj_num = db->objnum;
+		objp = &Objects[db->objnum];
+		break;
+	}
+
+	default:
+		return;
+	}
+
+	if (caster.blowup_ship == nullptr) {
+		caster.pos = &objp->pos;
+		caster.orient = &objp->orient;
+
+		vec3d eye_rel;
+		vm_vec_sub(&eye_rel, eye_pos, &objp->pos);
+		vm_vec_rotate(&caster.view_pos_local, &eye_rel, &objp->orient);
+	}
+
+	++Num_shadow_casters;
+}
+
 void shadows_render_all(fov_t fov, matrix *eye_orient, vec3d *eye_pos,
                         const vec3d* cam_offset, const matrix* rot_offset, const fov_t* fov_override)
 {
@@ -852,117 +967,80 @@ void shadows_render_all(fov_t fov, matrix *eye_orient, vec3d *eye_pos,
 
 	matrix light_matrix = shadows_start_render(eye_orient, eye_pos, fov, cockpit_fov, gr_screen.clip_aspect);
 
-	shadow_render_list shadow_list;
-
-	object *objp = Objects;
-
-	for ( int i = 0; i <= Highest_object_index; i++, objp++ ) {
-		if ( objp->flags[Object::Object_Flags::Should_be_dead] )
-			continue;
-
-		bool cull = true;
-		for (const auto& Shadow_frustum : Shadow_frustums) {
-			if ( shadows_obj_in_frustum(objp, &light_matrix, &Shadow_frustum.min, &Shadow_frustum.max) ) {
-				cull = false;
-				break;
-			}
-		}
-		if ( cull ) continue;
-
-		switch (objp->type) {
-		case OBJ_SHIP: {
-			if (objp == Viewer_obj) {
-				continue;
-			}
-
-			ship* shipp = &Ships[objp->instance];
+	const bool threaded = Cmdline_threaded_shadows && threading::is_threading();
 
-			if (shipp->large_ship_blowup_index >= 0) {
-				shipfx_shadow_render_blowup(&shadow_list, shipp);
-				continue;
-			}
-
-			model_clear_instance(Ship_info[shipp->ship_info_index].model_num);
+	// runs body over [0, count), on the worker threads if there are any
+	auto for_all = [threaded](size_t count, size_t grain_size, const std::function<void(size_t, size_t)>& body) {
+		if (threaded)
+			threading::parallel_for(0, count, grain_size, body);
+		else
+			body(0, count);
+	};
 
-			shadow_render_list::clip_plane_info clip;
-			bool has_clip = shadow_obj_clip_plane(objp, &clip);
+	const auto num_objects = static_cast<size_t>(Highest_object_index + 1);
+	Shadow_caster_visible.assign(num_objects, 0);
 
-			auto pm = model_get(Ship_info[shipp->ship_info_index].model_num);
-			polymodel_instance* pmi = nullptr;
-			if (shipp->model_instance_num >= 0) {
-				pmi = model_get_instance(shipp->model_instance_num);
+	{
+		TRACE_SCOPE(tracing::ShadowMapCull);
+
+		for_all(num_objects, Shadow_cull_chunk_size, [&light_matrix](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				auto objp = &Objects[i];
+				if ( objp->flags[Object::Object_Flags::Should_be_dead] )
+					continue;
+
+				for (const auto& Shadow_frustum : Shadow_frustums) {
+					if ( shadows_obj_in_frustum(objp, &light_matrix, &Shadow_frustum.min, &Shadow_frustum.max) ) {
+						Shadow_caster_visible[i] = 1;
+						break;
+					}
+				}
 			}
+		});
+	}
 
-			vec3d eye_rel, view_pos_local;
-			vm_vec_sub(&eye_rel, eye_pos, &objp->pos);
-			vm_vec_rotate(&view_pos_local, &eye_rel, &objp->orient);
+	{
+		TRACE_SCOPE(tracing::ShadowMapPrepareDraws);
 
-			shadow_render_list::add_model_draws(&shadow_list, pm, pmi, OBJ_INDEX(objp), &objp->pos, &objp->orient, has_clip ? &clip : nullptr, -1, &view_pos_local);
-			break;
+		// the models' textures are reset here, before any of them are looked at by the workers
+		Num_shadow_casters = 0;
+		for (size_t i = 0; i < num_objects; ++i) {
+			if (Shadow_caster_visible[i])
+				add_shadow_caster(&Objects[i], eye_pos);
 		}
 
-		case OBJ_RAW_POF:
-		case OBJ_PROP: {
-			int model_num = object_get_model_num(objp);
-			auto pm = model_get(model_num);
-			model_clear_instance(model_num);
-
-			polymodel_instance* pmi = nullptr;
-			int instance_num = object_get_model_instance_num(objp);
-			if (instance_num >= 0) {
-				pmi = model_get_instance(instance_num);
+		for_all(Num_shadow_casters, 1, [](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				auto& caster = Shadow_casters[i];
+				if (caster.blowup_ship == nullptr) {
+					shadow_render_list::plan_model_draws(&caster.plan, caster.pm, caster.pmi, caster.obj_num, caster.pos, caster.orient, -1, &caster.view_pos_local);
+				}
 			}
+		});
+	}
 
-			vec3d eye_rel, view_pos_local;
-			vm_vec_sub(&eye_rel, eye_pos, &objp->pos);
-			vm_vec_rotate(&view_pos_local, &eye_rel, &objp->orient);
-
-			shadow_render_list::add_model_draws(&shadow_list, pm, pmi, OBJ_INDEX(objp), &objp->pos, &objp->orient, nullptr, -1, &view_pos_local);
-			break;
-		}
-
-		case OBJ_ASTEROID: {
-			int num = objp->instance;
-			auto* ast = &Asteroids[num];
-			int model_num = Asteroid_info[ast->asteroid_type].subtypes[ast->asteroid_subtype].model_number;
-			model_clear_instance(model_num);
-			auto pm = model_get(model_num);
-
-			vec3d eye_rel, view_pos_local;
-			vm_vec_sub(&eye_rel, eye_pos, &objp->pos);
-			vm_vec_rotate(&view_pos_local, &eye_rel, &objp->orient);
-
-			shadow_render_list::add_model_draws(&shadow_list, pm, nullptr, OBJ_INDEX(objp), &objp->pos, &objp->orient, nullptr, -1, &view_pos_local);
-			break;
-		}
-
-		case OBJ_DEBRIS: {
-			debris* db = &Debris[objp->instance];
-			if ( !(db->flags[Debris_Flags::Used]) ) continue;
-
-			auto pm = model_get(db->model_num);
-			object* debris_obj = &Objects[db->objnum];
+	shadow_render_list shadow_list;
 
-			polymodel_instance* pmi = nullptr;
-			if (db->model_instance_num >= 0) {
-				pmi = model_get_instance(db->model_instance_num);
+	{
+		TRACE_SCOPE(tracing::ShadowMapSubmitDraws);
+
+		// in the same order as the objects, so the list comes out the same with and without threads
+		for (size_t i = 0; i < Num_shadow_casters; ++i) {
+			const auto& caster = Shadow_casters[i];
+			if (caster.blowup_ship != nullptr) {
+				shipfx_shadow_render_blowup(&shadow_list, caster.blowup_ship);
+			} else {
+				shadow_list.add_planned_draws(caster.plan, caster.has_clip ? &caster.clip : nullptr);
 			}
-
-			vec3d eye_rel, view_pos_local;
-			vm_vec_sub(&eye_rel, eye_pos, &debris_obj->pos);
-			vm_vec_rotate(&view_pos_local, &eye_rel, &debris_obj->orient);
-
-			shadow_render_list::add_model_draws(&shadow_list, pm, pmi, db->objnum, &debris_obj->pos, &debris_obj->orient, nullptr, -1, &view_pos_local);
-			break;
-		}
-
-		default:
-			break;
 		}
 	}
 
-	shadow_list.init_render(false);
-	shadow_list.render_all();
+	{
+		TRACE_SCOPE(tracing::ShadowMapRenderDraws);
+
+		shadow_list.init_render(false);
+		shadow_list.render_all();
+	}
 
 	render_viewer_shadow(Viewer_obj, &light_matrix, cam_offset, rot_offset);
 
@@ -1190,6 +1268,19 @@ void shadow_render_list::add_model_draws(shadow_render_list* list,
                                          const clip_plane_info* clip,
                                          int detail_level_lock,
                                          const vec3d* view_pos)
+{
+	model_draw_plan plan;
+	plan_model_draws(&plan, pm, pmi, obj_num, pos, orient, detail_level_lock, view_pos);
+	list->add_planned_draws(plan, clip);
+}
+
+void shadow_render_list::plan_model_draws(model_draw_plan* plan,
+                                          polymodel* pm,
+                                          polymodel_instance* pmi,
+                                          int obj_num,
+                                          const vec3d* pos, const matrix* orient,
+                                          int detail_level_lock,
+                                          const vec3d* view_pos)
 {
 	int detail_level;
 	if (detail_level_lock >= 0) {
@@ -1200,6 +1291,11 @@ void shadow_render_list::add_model_draws(shadow_render_list* list,
 	}
 	int detail_root = pm->detail[detail_level];
 
+	plan->pm = pm;
+	plan->detail_level = detail_level;
+	plan->texture_buffers.clear();
+	plan->submodel_transforms.clear();
+
 	bool render_root_geometry = true;
 	if (view_pos != nullptr) {
 		if (!model_render_check_detail_box(view_pos, pm, detail_root, 0)) {
@@ -1207,18 +1303,10 @@ void shadow_render_list::add_model_draws(shadow_render_list* list,
 		}
 	}
 
-	list->clear_transforms();
-	list->push_transform(pos, orient);
-
-	//TODO This might be incorrect for some models
-	const vec3d scale_identity = SCALE_IDENTITY_VECTOR;
-
-	matrix4 identity_4;
-	vm_matrix4_set_identity(&identity_4);
+	transform_stack transforms;
+	transforms.push(pos, orient);
 
 	{
-		list->start_model_batch(pm->n_models);
-
 		auto& detail_buffer = pm->detail_buffers[detail_level];
 		for (size_t j = 0; j < detail_buffer.tex_buf.size(); j++) {
 			if (detail_buffer.tex_buf[j].n_verts == 0) {
@@ -1251,7 +1339,7 @@ void shadow_render_list::add_model_draws(shadow_render_list* list,
 				continue;
 			}
 
-			list->add_draw(&pm->vert_source, &detail_buffer, j, identity_4, scale_identity, clip);
+			plan->texture_buffers.push_back(j);
 		}
 	}
 
@@ -1259,24 +1347,42 @@ void shadow_render_list::add_model_draws(shadow_render_list* list,
 
 	while (i >= 0) {
 		if (!pm->submodel[i].flags[Model::Submodel_flags::Is_thruster]) {
-			render_submodel_children(list, pm, pmi, i, clip, view_pos);
+			plan_submodel_children(plan, &transforms, pm, pmi, i, view_pos);
 		}
 
 		i = pm->submodel[i].next_sibling;
 	}
 
 	if (render_root_geometry)
-		list->add_submodel_to_batch(detail_root);
+		plan->submodel_transforms.emplace_back(detail_root, transforms.get_transform());
+}
 
-	list->pop_transform();
+void shadow_render_list::add_planned_draws(const model_draw_plan& plan, const clip_plane_info* clip)
+{
+	//TODO This might be incorrect for some models
+	const vec3d scale_identity = SCALE_IDENTITY_VECTOR;
+
+	matrix4 identity_4;
+	vm_matrix4_set_identity(&identity_4);
+
+	start_model_batch(plan.pm->n_models);
+
+	auto& detail_buffer = plan.pm->detail_buffers[plan.detail_level];
+	for (auto texi : plan.texture_buffers) {
+		add_draw(&plan.pm->vert_source, &detail_buffer, texi, identity_4, scale_identity, clip);
+	}
+
+	for (const auto& submodel : plan.submodel_transforms) {
+		add_submodel_to_batch(submodel.second, submodel.first);
+	}
 }
 
-void shadow_render_list::render_submodel_children(shadow_render_list* list,
-                                                  polymodel* pm,
-                                                  polymodel_instance* pmi,
-                                                  int mn,
-                                                  const clip_plane_info* clip,
-                                                  const vec3d* view_pos)
+void shadow_render_list::plan_submodel_children(model_draw_plan* plan,
+                                                transform_stack* transforms,
+                                                polymodel* pm,
+                                                polymodel_instance* pmi,
+                                                int mn,
+                                                const vec3d* view_pos)
 {
 	bsp_info* sm = &pm->submodel[mn];
 	submodel_instance* smi = nullptr;
@@ -1302,19 +1408,19 @@ void shadow_render_list::render_submodel_children(shadow_render_list* list,
 		vm_vec_add2(&submodel_offset, &smi->canonical_offset);
 	}
 
-	list->push_transform(&submodel_offset, &submodel_orient);
+	transforms->push(&submodel_offset, &submodel_orient);
 
-	list->add_submodel_to_batch(mn);
+	plan->submodel_transforms.emplace_back(mn, transforms->get_transform());
 
 	// Recurse into children
 	int i = sm->first_child;
 	while (i >= 0) {
 		if (!pm->submodel[i].flags[Model::Submodel_flags::Is_thruster]) {
-			render_submodel_children(list, pm, pmi, i, clip, view_pos);
+			plan_submodel_children(plan, transforms, pm, pmi, i, view_pos);
 		}
 
 		i = pm->submodel[i].next_sibling;
 	}
 
-	list->pop_transform();
-}
\ No newline at end of file
+	transforms->pop();
+}
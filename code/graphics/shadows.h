@@ -140,6 +140,15 @@ public:
 		vec3d position;
 	};
 
+	// Everything add_model_draws() adds to a list for one model. Working it out doesn't touch any list, so it can be
+	// done for several models at once on the worker threads.
+	struct model_draw_plan {
+		polymodel* pm = nullptr;
+		int detail_level = 0;
+		SCP_vector<size_t> texture_buffers;	// indices into the tex_buf of the detail level's buffer
+		SCP_vector<std::pair<int, matrix4>> submodel_transforms;
+	};
+
 	shadow_render_list();
 	~shadow_render_list() = default;
 
@@ -159,6 +168,15 @@ public:
 								int detail_level_lock = -1,
 								const vec3d* view_pos = nullptr);
 
+	static void plan_model_draws(model_draw_plan* plan,
+								 polymodel* pm,
+								 polymodel_instance* pmi,
+								 int obj_num,
+								 const vec3d* pos, const matrix* orient,
+								 int detail_level_lock = -1,
+								 const vec3d* view_pos = nullptr);
+	void add_planned_draws(const model_draw_plan& plan, const clip_plane_info* clip);
+
 private:
 	void build_uniform_buffer();
 	void render_buffer(const shadow_batch_entry& entry);
@@ -166,12 +184,12 @@ private:
 
 	void sort_draws() {}
 
-	static void render_submodel_children(shadow_render_list* list,
-										 polymodel* pm,
-										 polymodel_instance* pmi,
-										 int mn,
-										 const clip_plane_info* clip,
-										 const vec3d* view_pos);
+	static void plan_submodel_children(model_draw_plan* plan,
+									   transform_stack* transforms,
+									   polymodel* pm,
+									   polymodel_instance* pmi,
+									   int mn,
+									   const vec3d* view_pos);
 };
 
 #endif
@@ -586,6 +586,160 @@ bool light_compare_by_type(const light &a, const light &b)
 	return a.type < b.type;
 }
 
+// number of lights below which the tree doesn't split any further
+static const int Point_light_leaf_size = 8;
+
+void point_light_tree::build(const SCP_vector<light> &lights)
+{
+	Nodes.clear();
+	Pos_x.clear();
+	Pos_y.clear();
+	Pos_z.clear();
+	Radius.clear();
+	Light_indices.clear();
+
+	for ( size_t i = 0; i < lights.size(); ++i ) {
+		auto& l = lights[i];
+		if ( l.type != Light_Type::Point ) {
+			continue;
+		}
+
+		Pos_x.push_back(l.vec.xyz.x);
+		Pos_y.push_back(l.vec.xyz.y);
+		Pos_z.push_back(l.vec.xyz.z);
+		Radius.push_back(l.radb);
+		Light_indices.push_back(i);
+	}
+
+	if ( !Light_indices.empty() ) {
+		build_node(0, static_cast<int>(Light_indices.size()));
+	}
+}
+
+int point_light_tree::build_node(int first, int count)
+{
+	node n;
+	n.min = vm_vec_new(FLT_MAX, FLT_MAX, FLT_MAX);
+	n.max = vm_vec_new(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	n.first = first;
+	n.count = count;
+	n.right = -1;
+
+	vec3d center_min = n.min, center_max = n.max;
+
+	for ( int i = first; i < first + count; ++i ) {
+		// pad the bounds a little so that rounding can't make them miss a light which the exact test would accept
+		float r = Radius[i] + (fl_abs(Pos_x[i]) + fl_abs(Pos_y[i]) + fl_abs(Pos_z[i]) + Radius[i]) * 1e-4f;
+
+		n.min.xyz.x = MIN(n.min.xyz.x, Pos_x[i] - r);
+		n.min.xyz.y = MIN(n.min.xyz.y, Pos_y[i] - r);
+		n.min.xyz.z = MIN(n.min.xyz.z, Pos_z[i] - r);
+		n.max.xyz.x = MAX(n.max.xyz.x, Pos_x[i] + r);
+		n.max.xyz.y = MAX(n.max.xyz.y, Pos_y[i] + r);
+		n.max.xyz.z = MAX(n.max.xyz.z, Pos_z[i] + r);
+
+		center_min.xyz.x = MIN(center_min.xyz.x, Pos_x[i]);
+		center_min.xyz.y = MIN(center_min.xyz.y, Pos_y[i]);
+		center_min.xyz.z = MIN(center_min.xyz.z, Pos_z[i]);
+		center_max.xyz.x = MAX(center_max.xyz.x, Pos_x[i]);
+		center_max.xyz.y = MAX(center_max.xyz.y, Pos_y[i]);
+		center_max.xyz.z = MAX(center_max.xyz.z, Pos_z[i]);
+	}
+
+	int index = static_cast<int>(Nodes.size());
+	Nodes.push_back(n);
+
+	if ( count <= Point_light_leaf_size ) {
+		return index;
+	}
+
+	// split at the median along the axis where the lights are spread out the most
+	vec3d extent;
+	vm_vec_sub(&extent, &center_max, &center_min);
+
+	const SCP_vector<float> *coords = &Pos_x;
+	if ( extent.xyz.y > extent.xyz.x && extent.xyz.y >= extent.xyz.z ) {
+		coords = &Pos_y;
+	} else if ( extent.xyz.z > extent.xyz.x && extent.xyz.z > extent.xyz.y ) {
+		coords = &Pos_z;
+	}
+
+	SCP_vector<int> order(count);
+	for ( int i = 0; i < count; ++i ) {
+		order[i] = first + i;
+	}
+
+	int mid = count / 2;
+	std::nth_element(order.begin(), order.begin() + mid, order.end(), [coords](int a, int b) { return (*coords)[a] < (*coords)[b]; });
+
+	auto reorder = [&order, first, count](auto &values) {
+		using value_type = typename std::decay_t<decltype(values)>::value_type;
+		SCP_vector<value_type> sorted(count);
+		for ( int i = 0; i < count; ++i ) {
+			sorted[i] = values[order[i]];
+		}
+		std::copy(sorted.begin(), sorted.end(), values.begin() + first);
+	};
+	reorder(Pos_x);
+	reorder(Pos_y);
+	reorder(Pos_z);
+	reorder(Radius);
+	reorder(Light_indices);
+
+	// Nodes may be reallocated by the children, so only touch this node through its index
+	Nodes[index].count = 0;
+	build_node(first, mid);
+	Nodes[index].right = build_node(first + mid, count - mid);
+
+	return index;
+}
+
+void point_light_tree::query(const vec3d *pos, float rad, SCP_vector<size_t> &out) const
+{
+	if ( Nodes.empty() ) {
+		return;
+	}
+
+	// the tree halves the lights on every level, so this can't run out
+	int stack[64];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+
+	const float px = pos->xyz.x, py = pos->xyz.y, pz = pos->xyz.z;
+	const float reach = rad + (fl_abs(px) + fl_abs(py) + fl_abs(pz) + fl_abs(rad)) * 1e-4f;
+
+	while ( stack_size > 0 ) {
+		auto& n = Nodes[stack[--stack_size]];
+
+		if ( px < n.min.xyz.x - reach || px > n.max.xyz.x + reach
+			|| py < n.min.xyz.y - reach || py > n.max.xyz.y + reach
+			|| pz < n.min.xyz.z - reach || pz > n.max.xyz.z + reach ) {
+			continue;
+		}
+
+		if ( n.count == 0 ) {
+			stack[stack_size++] = n.right;
+			stack[stack_size++] = static_cast<int>(&n - Nodes.data()) + 1;
+			continue;
+		}
+
+		// the same test as for a single light in scene_lights::setLightFilter() used to be, just over the whole leaf
+		for ( int i = n.first; i < n.first + n.count; ++i ) {
+			float dx = Pos_x[i] - px;
+			float dy = Pos_y[i] - py;
+			float dz = Pos_z[i] - pz;
+			float dist_squared = (dx * dx) + (dy * dy) + (dz * dz);
+
+			float max_dist_squared = Radius[i] + rad;
+			max_dist_squared *= max_dist_squared;
+
+			if ( dist_squared < max_dist_squared ) {
+				out.push_back(Light_indices[i]);
+			}
+		}
+	}
+}
+
 void scene_lights::addLight(const light *light_ptr)
 {
 	Assert(light_ptr != NULL);
@@ -594,56 +748,45 @@ void scene_lights::addLight(const light *light_ptr)
 
 	if ( light_ptr->type == Light_Type::Directional ) {
 		StaticLightIndices.push_back(AllLights.size() - 1);
+	} else if ( light_ptr->type == Light_Type::Point ) {
+		PointLightsDirty = true;
+	} else if ( light_ptr->type == Light_Type::Tube ) {
+		TubeLightIndices.push_back(AllLights.size() - 1);
 	}
 }
 
 void scene_lights::setLightFilter(const vec3d *pos, float rad)
 {
-	size_t i = 0;
 	// clear out current filtered lights
 	FilteredLights.clear();
 
-	for ( auto& l : AllLights ) {
-		switch ( l.type ) {
-			case Light_Type::Directional:
-				++i;
-				continue;
-			case Light_Type::Point: {
-				vec3d to_light;
-				float dist_squared, max_dist_squared;
-				vm_vec_sub( &to_light, &l.vec, pos );
-				dist_squared = vm_vec_mag_squared(&to_light);
-
-				max_dist_squared = l.radb+rad;
-				max_dist_squared *= max_dist_squared;
-
-				if ( dist_squared < max_dist_squared )	{
-					FilteredLights.push_back(i);
-				}
-			}
-			break;
-			case Light_Type::Tube: {
-				vec3d nearest;
-				float dist_squared, max_dist_squared;
-				vm_vec_dist_squared_to_line(pos,&l.vec,&l.vec2,&nearest,&dist_squared);
+	// all lights are added before the first model is drawn, so this is built once per scene
+	if ( PointLightsDirty ) {
+		PointLights.build(AllLights);
+		PointLightsDirty = false;
+	}
 
-				max_dist_squared = l.radb+rad;
-				max_dist_squared *= max_dist_squared;
+	PointLights.query(pos, rad, FilteredLights);
 
-				if ( dist_squared < max_dist_squared ) {
-					FilteredLights.push_back(i);
-				}
-			}
-			break;
+	// tube lights reach along their whole line, not just the segment, so there is no bound to put them into the tree
+	// with. There are only ever a few of them anyway.
+	for ( auto i : TubeLightIndices ) {
+		auto& l = AllLights[i];
+
+		vec3d nearest;
+		float dist_squared, max_dist_squared;
+		vm_vec_dist_squared_to_line(pos,&l.vec,&l.vec2,&nearest,&dist_squared);
 
-			case Light_Type::Cone:
-				break;
+		max_dist_squared = l.radb+rad;
+		max_dist_squared *= max_dist_squared;
 
-			default:
-				break;
+		if ( dist_squared < max_dist_squared ) {
+			FilteredLights.push_back(i);
 		}
-		++i;
 	}
+
+	// lights are set in the order they were added
+	std::sort(FilteredLights.begin(), FilteredLights.end());
 }
 
 light_indexing_info scene_lights::bufferLights()
@@ -68,16 +68,45 @@ struct light_indexing_info
 	size_t num_lights;
 };
 
+// Bounding volume hierarchy over the point lights of a scene, so that filtering only has to look at the lights near
+// a model. The light data is kept in separate arrays in the order of the tree so the distance tests of a leaf run over
+// contiguous memory.
+class point_light_tree
+{
+	struct node {
+		vec3d min, max;		// bounds of the spheres of all lights below this node
+		int first, count;	// range of lights for a leaf, count is 0 for inner nodes
+		int right;			// second child of an inner node, the first one always follows the node
+	};
+
+	SCP_vector<node> Nodes;
+
+	SCP_vector<float> Pos_x, Pos_y, Pos_z, Radius;
+	SCP_vector<size_t> Light_indices;
+
+	int build_node(int first, int count);
+public:
+	void build(const SCP_vector<light> &lights);
+
+	// adds the index of every light whose sphere of influence intersects the given sphere to out, in no particular order
+	void query(const vec3d *pos, float rad, SCP_vector<size_t> &out) const;
+};
+
 class scene_lights
 {
 	SCP_vector<light> AllLights;
 	
 	SCP_vector<size_t> StaticLightIndices;
 
+	SCP_vector<size_t> TubeLightIndices;
+
 	SCP_vector<size_t> FilteredLights;
 
 	SCP_vector<size_t> BufferedLights;
 
+	point_light_tree PointLights;
+	bool PointLightsDirty = false;
+
 	size_t current_light_index;
 	size_t current_num_lights;
 public:
@@ -87,6 +116,7 @@ public:
 	}
 	void addLight(const light *light_ptr);
 	void setLightFilter(const vec3d *pos, float rad);
+	const SCP_vector<size_t>& getFilteredLights() const { return FilteredLights; }
 	bool setLights(const light_indexing_info *info);
 	void resetLightState();
 	light_indexing_info bufferLights();
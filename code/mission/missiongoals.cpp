@@ -34,6 +34,7 @@
 #include "parse/sexp.h"
 #include "playerman/player.h"
 #include "scripting/global_hooks.h"
+#include "tracing/Monitor.h"
 #include "tracing/tracing.h"
 #include "ui/ui.h"
 
@@ -186,6 +187,10 @@ static goal_text Goal_text;
 static TIMESTAMP Mission_directive_sound_timestamp;		// timestamp to control when directive succcess sound gets played
 static TIMESTAMP Mission_directive_special_timestamp;	// used to specially mark a directive as true even though it's not
 
+// goals and events evaluated on the goal timestamp this mission, and those skipped since nothing they read had changed
+MONITOR(FormulasEvaluated)
+MONITOR(FormulasSkipped)
+
 const char *Goal_type_text(int n)
 {
 	switch (n) {
@@ -369,6 +374,9 @@ void mission_goals_and_events_init()
 	Mission_goal_timestamp = _timestamp(GOAL_TIMESTAMP);
 	Mission_directive_sound_timestamp = TIMESTAMP::invalid();
 	Mission_directive_special_timestamp = TIMESTAMP::invalid();		// need to make invalid right away
+
+	mon_FormulasEvaluated = 0;
+	mon_FormulasSkipped = 0;
 }
 
 // called once right before entering the show goals screen to do initializations.
@@ -877,6 +885,7 @@ void mission_process_event( int event )
 	int store_flags = Mission_events[event].flags;
 	int store_result = Mission_events[event].result;
 	int store_count = Mission_events[event].count;
+	auto store_timestamp = Mission_events[event].timestamp;
 
 	int result, sindex;
 	bool bump_timestamp = false; 
@@ -1014,6 +1023,7 @@ void mission_process_event( int event )
 		// _argv[-1] - repeat_count of -1 would mean repeat indefinitely, so set to 0 instead.
 		Mission_events[event].repeat_count = 0;
 		Mission_events[event].flags |= MEF_EVENT_IS_DONE;	// in lieu of setting formula to -1
+		sexp_input_changed(SEXP_INPUT_EVENTS);
 
 		// Also send an update.
 		// (This would always fire on MULTIPLAYER_MASTER on retail because sindex and the formula were guaranteed to be different)
@@ -1075,9 +1085,46 @@ void mission_process_event( int event )
 	}
 
 	// see if anything has changed	
-	if(MULTIPLAYER_MASTER && ((store_flags != Mission_events[event].flags) || (store_result != Mission_events[event].result) || (store_count != Mission_events[event].count)) ){
+	bool changed = (store_flags != Mission_events[event].flags) || (store_result != Mission_events[event].result) || (store_count != Mission_events[event].count);
+	if(MULTIPLAYER_MASTER && changed){
 		send_event_update_packet(event);
 	}
+
+	// the event delay operators also look at when a true event was last evaluated
+	if (changed || (Mission_events[event].result && (store_timestamp != Mission_events[event].timestamp))) {
+		sexp_input_changed(SEXP_INPUT_EVENTS);
+	}
+}
+
+/**
+ * The input stamp to check a goal or event formula against before evaluating it, see sexp_get_formula_inputs().
+ * In multiplayer the game state also changes through packets, so everything is evaluated every time there.
+ *
+ * @return the stamp, or 0 if the formula has to be evaluated
+ */
+static uint64_t mission_formula_input_stamp(int formula, int &inputs)
+{
+	if (Game_mode & GM_MULTIPLAYER)
+		return 0;
+
+	if (inputs < 0)
+		inputs = sexp_get_formula_inputs(formula);
+
+	if (inputs & SEXP_INPUT_VOLATILE)
+		return 0;
+
+	return sexp_input_stamp(inputs);
+}
+
+static uint64_t mission_event_input_stamp(int event)
+{
+	auto &ev = Mission_events[event];
+
+	// chained events depend on their neighbours, and logged events are expected to show up in the log every time
+	if ((ev.chain_delay >= 0) || (ev.mission_log_flags != 0) || Snapshot_all_events)
+		return 0;
+
+	return mission_formula_input_stamp(ev.formula, ev.inputs);
 }
 
 // Maybe play a directive success sound... need to poll since the sound is delayed from when
@@ -1122,12 +1169,21 @@ void mission_eval_goals()
 		}
 
 		if (Mission_goals[i].satisfied == GOAL_INCOMPLETE) {
+			auto stamp = mission_formula_input_stamp(Mission_goals[i].formula, Mission_goals[i].inputs);
+			if ((stamp != 0) && (stamp == Mission_goals[i].input_stamp)) {
+				MONITOR_INC(FormulasSkipped, 1);
+				continue;
+			}
+
+			MONITOR_INC(FormulasEvaluated, 1);
 			result = eval_sexp(Mission_goals[i].formula);
 			if ( Sexp_nodes[Mission_goals[i].formula].value == SEXP_KNOWN_FALSE ) {
 				mission_goal_status_change( i, GOAL_FAILED );
 
 			} else if (result) {
 				mission_goal_status_change(i, GOAL_COMPLETE );
+			} else {
+				Mission_goals[i].input_stamp = stamp;
 			} // end if result
 
 		}	// end if goals[i].satsified != GOAL_COMPLETE
@@ -1140,8 +1196,22 @@ void mission_eval_goals()
 			// we will evaluate repeatable events at the top of the file so we can get
 			// the exact interval that the designer asked for.
 			if ( !Mission_events[i].timestamp.isValid() ){
-				TRACE_SCOPE(tracing::NonrepeatingEvents);
-				mission_process_event( i );
+				// nothing this event looks at has changed since it was last false
+				auto stamp = mission_event_input_stamp(i);
+				if ((stamp != 0) && (stamp == Mission_events[i].input_stamp)) {
+					MONITOR_INC(FormulasSkipped, 1);
+					continue;
+				}
+
+				MONITOR_INC(FormulasEvaluated, 1);
+				{
+					TRACE_SCOPE(tracing::NonrepeatingEvents);
+					mission_process_event( i );
+				}
+
+				auto &ev = Mission_events[i];
+				bool waiting = !ev.result && !(ev.flags & MEF_EVENT_IS_DONE) && !ev.timestamp.isValid();
+				ev.input_stamp = waiting ? stamp : 0;
 			}
 		}
 	}
@@ -59,6 +59,8 @@ typedef struct mission_goal {
 	int  score = 0;                         // score for this goal
 	int  flags = 0;                         // MGF_
 	int  team = 0;                          // which team is this objective for (defaults to the first team)
+	int  inputs = -1;                       // SEXP_INPUT_* the formula reads, -1 if not worked out yet
+	uint64_t input_stamp = 0;               // sexp_input_stamp() of the last evaluation which came up false, or 0
 } mission_goal;
 extern SCP_vector<mission_goal> Mission_goals;	// structure for the goals of this mission
 
@@ -123,6 +125,8 @@ typedef struct mission_event {
 	SCP_vector<SCP_string> event_log_argument_buffer;
 	SCP_vector<SCP_string> backup_log_buffer;
 	int	previous_result = 0;                            // result of previous evaluation of event
+	int inputs = -1;                                    // SEXP_INPUT_* the formula reads, -1 if not worked out yet
+	uint64_t input_stamp = 0;                           // sexp_input_stamp() of the last evaluation which came up false, or 0
 
 } mission_event;
 extern SCP_vector<mission_event> Mission_events;
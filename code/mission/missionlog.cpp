@@ -18,6 +18,7 @@
 #include "network/multimsgs.h"
 #include "network/multiutil.h"
 #include "parse/parselo.h"
+#include "parse/sexp.h"
 #include "playerman/player.h"
 #include "ship/ship.h"
 
@@ -36,10 +37,59 @@ static int X, Line_offset, P_width;
 SCP_vector<log_line_complete> Log_scrollback_vec;
 SCP_vector<log_entry> Log_entries;
 
+// Entries of the log by type and name, so that looking up what happened to a ship doesn't have to go through the whole
+// log.  Names are interned case-insensitively, and every list of entries is in the order they were added.  Dock and
+// undock entries are listed under both ships since they can be looked up by either one.
+static SCP_unordered_map<SCP_string, int, SCP_string_lcase_hash, SCP_string_lcase_equal_to> Log_name_ids;
+static SCP_unordered_map<uint64_t, SCP_vector<int>> Log_entry_index;
+
+static uint64_t mission_log_index_key(LogType type, int name_id)
+{
+	return (static_cast<uint64_t>(type) << 32) | static_cast<uint32_t>(name_id);
+}
+
+static void mission_log_index_add(LogType type, const char *name, int entry_index)
+{
+	auto id_it = Log_name_ids.emplace(name, static_cast<int>(Log_name_ids.size())).first;
+	Log_entry_index[mission_log_index_key(type, id_it->second)].push_back(entry_index);
+}
+
+// must be called for every entry added to the log
+static void mission_log_index_entry(int entry_index)
+{
+	const auto &entry = Log_entries[entry_index];
+
+	mission_log_index_add(entry.type, entry.pname, entry_index);
+
+	if ( ((entry.type == LOG_SHIP_DOCKED) || (entry.type == LOG_SHIP_UNDOCKED)) && stricmp(entry.pname, entry.sname) != 0 ) {
+		mission_log_index_add(entry.type, entry.sname, entry_index);
+	}
+}
+
+// the indexes of all entries of the given type which have the given name, or of dock and undock entries which have it
+// as either name
+static const SCP_vector<int> *mission_log_find_entries(LogType type, const char *name)
+{
+	auto id_it = Log_name_ids.find(name);
+	if (id_it == Log_name_ids.end()) {
+		return nullptr;
+	}
+
+	auto it = Log_entry_index.find(mission_log_index_key(type, id_it->second));
+	if (it == Log_entry_index.end()) {
+		return nullptr;
+	}
+
+	return &it->second;
+}
+
 void mission_log_init()
 {
 	// zero out all the memory so we don't get bogus information when playing across missions!
 	Log_entries.clear();
+	Log_name_ids.clear();
+	Log_entry_index.clear();
+	sexp_input_changed(SEXP_INPUT_MISSION_LOG);
 }
 
 // following function adds an entry into the mission log.
@@ -55,6 +105,7 @@ void mission_log_add_entry(LogType type, const char *pname, const char *sname, i
 
 	Log_entries.emplace_back();
 	auto &entry = Log_entries.back();
+	sexp_input_changed(SEXP_INPUT_MISSION_LOG);
 
 	entry.type = type;
 	if ( pname ) {
@@ -226,6 +277,8 @@ void mission_log_add_entry(LogType type, const char *pname, const char *sname, i
 	entry.timestamp = Missiontime;
 	entry.timer_padding = The_mission.HUD_timer_padding;
 
+	mission_log_index_entry(static_cast<int>(Log_entries.size()) - 1);
+
 	// if in multiplayer and I am the master, send this log entry to everyone
 	if ( MULTIPLAYER_MASTER ){
 		send_mission_log_packet( &entry );
@@ -305,6 +358,7 @@ void mission_log_add_entry_multi( LogType type, const char *pname, const char *s
 
 	Log_entries.emplace_back();
 	auto &entry = Log_entries.back();
+	sexp_input_changed(SEXP_INPUT_MISSION_LOG);
 
 	entry.type = type;
 	if ( pname ) {
@@ -323,6 +377,8 @@ void mission_log_add_entry_multi( LogType type, const char *pname, const char *s
 
 	entry.pname_display = entry.pname;
 	entry.sname_display = entry.sname;
+
+	mission_log_index_entry(static_cast<int>(Log_entries.size()) - 1);
 }
 
 // function to determine is the given event has taken place count number of times.
@@ -331,55 +387,63 @@ int mission_log_get_time_indexed( LogType type, const char *pname, const char *s
 {
 	Assertion(count > 0, "The count parameter is %d; it should be greater than 0!", count);
 
-	for (const auto& entry: Log_entries) {
-		bool found = false;
+	bool is_dock = (type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED);
 
-		if ( entry.type == type ) {
-			// if we are looking for a dock/undock entry, then we don't care about the order in which the names
-			// were passed into this function.  Count the entry as found if either name matches both in the other
-			// set.
-			if ( (type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED) ) {
-				if (sname == NULL) {
-					Int3();
-					return 0;
-				}
+	// if we are looking for a dock/undock entry, then we don't care about the order in which the names
+	// were passed into this function, but we need both of them.  For anything else the primary name is
+	// what matters!
+	if ( (is_dock && (sname == NULL)) || (pname == NULL) ) {
+		Int3();
+		return 0;
+	}
 
-				if ( (!stricmp(entry.pname, pname) && !stricmp(entry.sname, sname)) || (!stricmp(entry.pname, sname) && !stricmp(entry.sname, pname)) ) {
-					found = true;
-				}
-			} else {
-				// for non dock/undock goals, then the names are important!
-				if (pname == NULL) {
-					Int3();
-					return 0;
-				}
+	auto entries = mission_log_find_entries(type, pname);
+	if (entries == nullptr) {
+		return 0;
+	}
 
-				if ( stricmp(entry.pname, pname) != 0 ) {
-					continue;
-				}
+	// without a secondary name every entry under the primary name counts
+	if ( !is_dock && (sname == NULL) ) {
+		if (count > static_cast<int>(entries->size())) {
+			return 0;
+		}
 
-				// if we are looking for a subsystem entry, the subsystem names must be compared
-				if ((type == LOG_SHIP_SUBSYS_DESTROYED || type == LOG_CAP_SUBSYS_CARGO_REVEALED)) {
-					if ( (sname == NULL) || !subsystem_stricmp(sname, entry.sname) ) {
-						found = true;
-					}
-				} else {
-					if ( (sname == NULL) || !stricmp(sname, entry.sname) ) {
-						found = true;
-					}
-				}
-			}
+		if (time) {
+			*time = Log_entries[(*entries)[count - 1]].timestamp;
+		}
+
+		return 1;
+	}
 
-			if ( found ) {
-				count--;
+	for (int entry_index : *entries) {
+		const auto &entry = Log_entries[entry_index];
+		bool found = false;
 
-				if ( !count ) {
-					if (time) {
-						*time = entry.timestamp;
-					}
+		if ( is_dock ) {
+			// Count the entry as found if either name matches both in the other set.
+			if ( (!stricmp(entry.pname, pname) && !stricmp(entry.sname, sname)) || (!stricmp(entry.pname, sname) && !stricmp(entry.sname, pname)) ) {
+				found = true;
+			}
+		} else if ((type == LOG_SHIP_SUBSYS_DESTROYED || type == LOG_CAP_SUBSYS_CARGO_REVEALED)) {
+			// if we are looking for a subsystem entry, the subsystem names must be compared
+			if ( (sname == NULL) || !subsystem_stricmp(sname, entry.sname) ) {
+				found = true;
+			}
+		} else {
+			if ( (sname == NULL) || !stricmp(sname, entry.sname) ) {
+				found = true;
+			}
+		}
 
-					return 1;
+		if ( found ) {
+			count--;
+
+			if ( !count ) {
+				if (time) {
+					*time = entry.timestamp;
 				}
+
+				return 1;
 			}
 		}
 	}
@@ -399,37 +463,34 @@ int mission_log_get_time( LogType type, const char *pname, const char *sname, fi
 
 int mission_log_get_count( LogType type, const char *pname, const char *sname )
 {
-	int count = 0;
+	bool is_dock = (type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED);
 
-	for (const auto& entry : Log_entries) {
-		if ( entry.type == type ) {
-			// if we are looking for a dock/undock entry, then we don't care about the order in which the names
-			// were passed into this function.  Count the entry as found if either name matches both in the other
-			// set.
-			if ( (type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED) ) {
-				if (sname == NULL) {
-					Int3();
-					return 0;
-				}
+	if ( (is_dock && (sname == NULL)) || (pname == NULL) ) {
+		Int3();
+		return 0;
+	}
 
-				if ( (!stricmp(entry.pname, pname) && !stricmp(entry.sname, sname)) || (!stricmp(entry.pname, sname) && !stricmp(entry.sname, pname)) ) {
-					count++;
-				}
-			} else {
-				// for non dock/undock goals, then the names are important!
-				if (pname == NULL) {
-					Int3();
-					return 0;
-				}
+	auto entries = mission_log_find_entries(type, pname);
+	if (entries == nullptr) {
+		return 0;
+	}
 
-				if ( stricmp(entry.pname, pname) != 0 ) {
-					continue;
-				}
+	// without a secondary name every entry under the primary name counts
+	if ( !is_dock && (sname == NULL) ) {
+		return static_cast<int>(entries->size());
+	}
 
-				if ( (sname == NULL) || !stricmp(sname, entry.sname) ) {
-					count++;
-				}
+	int count = 0;
+
+	for (int entry_index : *entries) {
+		const auto &entry = Log_entries[entry_index];
+
+		if ( is_dock ) {
+			if ( (!stricmp(entry.pname, pname) && !stricmp(entry.sname, sname)) || (!stricmp(entry.pname, sname) && !stricmp(entry.sname, pname)) ) {
+				count++;
 			}
+		} else if ( !stricmp(sname, entry.sname) ) {
+			count++;
 		}
 	}
 
@@ -64,6 +64,7 @@
 #include "object/waypoint.h"
 #include "parse/generic_log.h"
 #include "parse/parselo.h"
+#include "parse/sexp.h"
 #include "parse/sexp_container.h"
 #include "prop/prop.h"
 #include "scripting/global_hooks.h"
@@ -4153,6 +4154,7 @@ void mission_parse_maybe_create_parse_object(p_object *pobjp)
 				entry->objnum = -1;
 				entry->shipnum = -1;
 				entry->cleanup_mode = SHIP_DESTROYED;
+				sexp_input_changed(SEXP_INPUT_SHIPS);
 
 				// once the ship is exploded, find the debris pieces belonging to this object, mark them
 				// as not to expire, and move them forward in time N seconds
@@ -4643,6 +4645,7 @@ int parse_wing_create_ships( wing *wingp, int num_to_create, bool force_create,
 
 				// set the gone flag
                 wingp->flags.set(Ship::Wing_Flags::Gone);
+				sexp_input_changed(SEXP_INPUT_SHIPS);
 
 				// mark the number of waves and number of ships destroyed equal to the last wave and the number
 				// of ships yet to arrive
@@ -7064,6 +7067,9 @@ bool post_process_mission(mission *pm)
 	Arriving_support_ship = nullptr;
 	Num_arriving_repair_targets = 0;
 
+	// all sexps are loaded now, so resolve everything about their nodes which would otherwise be looked up during play
+	sexp_precompute_nodes();
+
 	// before doing anything else, we must validate all of the sexpressions that were loaded into the mission.
 	// Loop through the Sexp_nodes array and send the top level functions to the check_sexp_syntax parser
 	// Cyborg -- If you are a ingame joiner, your sexps will be taken care of by the server, and checking will 
@@ -7131,6 +7137,9 @@ bool post_process_mission(mission *pm)
 				}
 			}
 		}
+
+		// every ship and wing of the mission is known by now
+		sexp_precompute_references();
 	}
 
 	// multiplayer missions are handled just before mission start
@@ -455,6 +455,7 @@ namespace animation {
 
 		submodel->canonical_prev_offset = submodel->canonical_offset;
 		submodel->canonical_offset = data.position;
+		submodel_instance_transform_changed(submodel);
 		
 		vec3d delta_vec;
 		vm_vec_sub(&delta_vec, &submodel->canonical_offset, &submodel->canonical_prev_offset);
@@ -633,6 +634,7 @@ namespace animation {
 
 		submodel->canonical_prev_offset = submodel->canonical_offset;
 		submodel->canonical_offset = data.position;
+		submodel_instance_transform_changed(submodel);
 
 		submodel->translation_axis = sm->translation_axis;
 
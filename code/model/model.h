@@ -146,6 +146,8 @@ struct submodel_instance
 	// similarly for translation
 	vec3d	canonical_offset = vmd_zero_vector;
 	vec3d	canonical_prev_offset = vmd_zero_vector;
+	// Bumped by submodel_instance_transform_changed() whenever canonical_orient or canonical_offset is written
+	int		transform_changes = 0;
 
 	SCP_vector<model_electrical_arc> electrical_arcs;
 
@@ -200,6 +202,19 @@ public:
 };
 
 // Data specific to a particular instance of a model.
+// Where a submodel sits in its model, with all the rotations and translations of its parents applied.
+// See model_instance_get_submodel_transform().
+struct submodel_transform
+{
+	matrix	orient = vmd_identity_matrix;		// unrotating by this turns the submodel's frame of reference into the model's
+	vec3d	offset = vmd_zero_vector;			// the submodel's origin in the model's frame of reference
+
+	int		framecount = -1;					// the frame this was computed in
+	int		transform_changes = -1;				// the submodel instance's transform_changes it was computed from
+	int		version = 0;						// tells the children of the submodel when this was recomputed
+	int		parent_version = -1;				// the parent's version it was computed from
+};
+
 struct polymodel_instance
 {
 	int id = -1;							// global model_instance num index
@@ -209,6 +224,10 @@ struct polymodel_instance
 	std::shared_ptr<model_texture_replace> texture_replace = nullptr;
 
 	int objnum;								// id of the object using this pmi, or -1 if no object (e.g. skybox) 
+
+	// filled in on demand by model_instance_get_submodel_transform(); mirrors the polymodel->submodel array
+	mutable SCP_vector<submodel_transform> transform_cache;
+	mutable int transform_cache_version = 0;
 };
 
 #define MAX_MODEL_SUBSYSTEMS		200				// used in ships.cpp (only place?) for local stack variable DTP; bumped to 200
@@ -414,6 +433,25 @@ struct bsp_collision_leaf {
 	int next;
 };
 
+// A node of bsp_collision_tree::flat_nodes
+struct bsp_collision_flat_node {
+	vec3d min;
+	vec3d max;
+
+	int skip;			// the node after this one's subtree, where to go on if the box is missed
+	int first_poly;
+	int n_polys;
+};
+
+// A polygon of bsp_collision_tree::flat_polys
+struct bsp_collision_poly {
+	vec3d plane_norm;
+	int first_point;	// index of the first point in flat_points and flat_uvs
+	int leaf;			// the leaf in leaf_list this polygon comes from
+	ubyte num_verts;
+	ubyte tmap_num;
+};
+
 struct bsp_collision_tree {
 	bsp_collision_node *node_list;
 	int n_nodes;
@@ -425,6 +463,14 @@ struct bsp_collision_tree {
 	vec3d *point_list;
 	SCP_vector<vec3d> poly_centers;
 
+	// The same tree as node_list and leaf_list, laid out in the order model_collide() walks it. Every node is followed
+	// by its back subtree and then its front subtree, so the walk is a loop over the array which jumps ahead whenever a
+	// box is missed. The polygons of a node, and the points and uvs of a polygon, come right after one another.
+	SCP_vector<bsp_collision_flat_node> flat_nodes;
+	SCP_vector<bsp_collision_poly> flat_polys;
+	SCP_vector<vec3d> flat_points;
+	SCP_vector<uv_pair> flat_uvs;
+
 	int n_verts;
 	bool used;
 };
@@ -1046,6 +1092,12 @@ int model_load(ship_info* sip, bool prefer_tech_model);
 // NOTE: Each time model_load is called with a ship_info pointer, which causes it to load subsystems, the model number is also assigned to the ship_info.
 int model_load(const char *filename, ship_info* sip = nullptr, ErrorType error_type = ErrorType::FATAL_ERROR, bool allow_redundant_load = false);
 
+// For level paging: models loaded after this are usable right away, except that building their collision trees and
+// vertex buffers is left to model_finish_deferred_loads(), which does it for all of them at once on the worker threads.
+// A collision tree which is needed before that is built on the spot.
+void model_defer_loads();
+void model_finish_deferred_loads();
+
 int model_create_instance(int objnum, int model_num);
 void model_delete_instance(int model_instance_num);
 
@@ -1194,6 +1246,20 @@ void submodel_stepped_translate(model_subsystem *psub, submodel_instance *smi);
 
 // ------- submodel transformations -------
 
+// Has to be called whenever canonical_orient or canonical_offset of a submodel instance is changed, so that the cached
+// transforms of the submodel and its children are recomputed
+inline void submodel_instance_transform_changed(submodel_instance *smi)
+{
+	++smi->transform_changes;
+}
+
+// Returns where a submodel sits in the model, taking into account the current rotations and translations of the
+// submodel and all of its parents.  This is cached per frame and only recomputed after
+// submodel_instance_transform_changed() was called for the submodel or one of its parents.  The model_instance_*
+// transformation functions below use it for the current frame's positions.  The cache is only kept up to date on the
+// main thread, so this returns nullptr on any other thread.
+extern const submodel_transform *model_instance_get_submodel_transform(const polymodel *pm, const polymodel_instance *pmi, int submodel_num);
+
 // Goober5000
 // For a submodel, return its overall offset from the main model.
 extern void model_find_submodel_offset(vec3d *outpnt, const polymodel *pm, int sub_model_num);
@@ -1425,7 +1491,24 @@ typedef struct mc_info {
 */
 
 int model_collide(mc_info *mc_info_obj);
+
+/*
+   Does the checks of several mc_info structures at once.  Works just like
+   calling model_collide() on each of them, and fills in the same results,
+   the model's submodels are only walked once, each ray is only rotated
+   into each submodel once, and each collision tree is checked against
+   all the rays in a row.  This needs all the checks
+   to be against the same model instance at the same spot (same model_num,
+   model_instance_num, orient, pos, submodel_num, lod and submodel flags)
+   as the first one.  Anything else, like shield checks, MC_ONLY_BOUND_BOX,
+   a pre-populated collision_checked or checks against another model, is
+   simply passed on to model_collide().
+
+   Returns how many of the checks hit something.
+*/
+int model_collide_batch(mc_info **mc_info_list, int count);
 void model_collide_parse_bsp(bsp_collision_tree *tree, ubyte *bsp_data, int version);
+void model_collide_flatten_bsp(bsp_collision_tree *tree);
 
 bsp_collision_tree *model_get_bsp_collision_tree(int tree_index);
 void model_remove_bsp_collision_tree(int tree_index);
@@ -0,0 +1,662 @@
+#include "model/modelcache.h"
+
+#include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
+#include "globalincs/systemvars.h"
+#include "graphics/2d.h"
+
+#include <md5.h>
+
+#include <algorithm>
+#include <ctime>
+#include <type_traits>
+
+extern SCP_vector<bsp_collision_tree> Bsp_collision_tree_list;
+
+namespace {
+
+// bump this whenever the layout below or the way the cached data is built changes
+const int MODEL_CACHE_VERSION = 2;
+const uint MODEL_CACHE_MAGIC = 0x434D5346;	// "FSMC"
+
+const uint32_t MODEL_CACHE_LOCATIONS = CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT;
+const SCP_string MODEL_CACHE_PREFIX = "model-";
+const char* MODEL_CACHE_EXT = ".bin";
+
+SCP_string cache_filename(const SCP_string& key)
+{
+	return MODEL_CACHE_PREFIX + key + MODEL_CACHE_EXT;
+}
+
+// Everything is written field by field, so neither padding nor fields which are never set end up in the file and two
+// builds of the same model always produce the same bytes
+class cache_writer {
+  public:
+	explicit cache_writer(SCP_vector<ubyte>& out) : m_out(out) {}
+
+	template <typename T>
+	void put(T value)
+	{
+		static_assert(std::is_arithmetic<T>::value, "Only numbers can be written directly!");
+		auto bytes = reinterpret_cast<const ubyte*>(&value);
+		m_out.insert(m_out.end(), bytes, bytes + sizeof(T));
+	}
+
+	void put(const vec3d& v)
+	{
+		put(v.xyz.x);
+		put(v.xyz.y);
+		put(v.xyz.z);
+	}
+
+	void put(const uv_pair& uv)
+	{
+		put(uv.u);
+		put(uv.v);
+	}
+
+	template <typename T, typename Put>
+	void put_array(const T* items, size_t count, Put put_item)
+	{
+		put((int)count);
+		for (size_t i = 0; i < count; ++i) {
+			put_item(items[i]);
+		}
+	}
+
+	template <typename T>
+	void put_array(const T* items, size_t count)
+	{
+		put_array(items, count, [this](const T& item) { put(item); });
+	}
+
+	size_t size() const { return m_out.size(); }
+
+  private:
+	SCP_vector<ubyte>& m_out;
+};
+
+class cache_reader {
+  public:
+	cache_reader(const ubyte* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+	template <typename T>
+	bool get(T& value)
+	{
+		static_assert(std::is_arithmetic<T>::value, "Only numbers can be read directly!");
+		if ((size_t)(m_end - m_pos) < sizeof(T)) {
+			return false;
+		}
+		memcpy(&value, m_pos, sizeof(T));
+		m_pos += sizeof(T);
+		return true;
+	}
+
+	bool get(vec3d& v) { return get(v.xyz.x) && get(v.xyz.y) && get(v.xyz.z); }
+
+	bool get(uv_pair& uv) { return get(uv.u) && get(uv.v); }
+
+	// reads the count of an array, which can't possibly be bigger than what is left if every item takes min_size bytes
+	bool get_count(int& count, size_t min_size)
+	{
+		return get(count) && count >= 0 && (size_t)count <= (size_t)(m_end - m_pos) / min_size;
+	}
+
+	template <typename T, typename Get>
+	bool get_array(SCP_vector<T>& items, size_t min_size, Get get_item)
+	{
+		int count;
+		if (!get_count(count, min_size)) {
+			return false;
+		}
+
+		items.resize(count);
+		for (auto& item : items) {
+			if (!get_item(item)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <typename T>
+	bool get_array(SCP_vector<T>& items, size_t min_size)
+	{
+		return get_array(items, min_size, [this](T& item) { return get(item); });
+	}
+
+	bool at_end() const { return m_pos == m_end; }
+
+  private:
+	const ubyte* m_pos;
+	const ubyte* m_end;
+};
+
+// what model_collide_parse_bsp() and interp_build_vertex_buffers() produce for one submodel
+struct cached_submodel {
+	SCP_vector<vec3d> points;
+	SCP_vector<bsp_collision_node> nodes;
+	SCP_vector<bsp_collision_leaf> leaves;
+	SCP_vector<model_tmap_vert> tmap_verts;
+	SCP_vector<vec3d> poly_centers;
+	SCP_vector<bsp_collision_flat_node> flat_nodes;
+	SCP_vector<bsp_collision_poly> flat_polys;
+	SCP_vector<vec3d> flat_points;
+	SCP_vector<uv_pair> flat_uvs;
+
+	int buffer_flags = 0;
+	std::unique_ptr<poly_list> model_list;
+	SCP_vector<buffer_data> tex_buf;
+
+	SCP_vector<vertex> outline;
+};
+
+// the tree doesn't know how long vert_list is, but its leaves do
+size_t tree_tmap_vert_count(const bsp_collision_tree* tree)
+{
+	size_t count = 0;
+	for (int i = 0; i < tree->n_leaves; ++i) {
+		count = std::max(count, (size_t)tree->leaf_list[i].vert_start + tree->leaf_list[i].num_verts);
+	}
+	return count;
+}
+
+void write_tree(cache_writer& out, const bsp_collision_tree* tree)
+{
+	out.put_array(tree->point_list, (size_t)tree->n_verts);
+
+	out.put_array(tree->node_list, (size_t)tree->n_nodes, [&out](const bsp_collision_node& node) {
+		out.put(node.min);
+		out.put(node.max);
+		out.put(node.back);
+		out.put(node.front);
+		out.put(node.leaf);
+	});
+
+	out.put_array(tree->leaf_list, (size_t)tree->n_leaves, [&out](const bsp_collision_leaf& leaf) {
+		out.put(leaf.plane_norm);
+		out.put(leaf.vert_start);
+		out.put(leaf.num_verts);
+		out.put(leaf.tmap_num);
+		out.put(leaf.next);
+	});
+
+	// normnum indexes the normals of the submodel, which the tree doesn't keep and model_collide() never looks at
+	out.put_array(tree->vert_list, tree_tmap_vert_count(tree), [&out](const model_tmap_vert& vert) {
+		out.put(vert.vertnum);
+		out.put(vert.u);
+		out.put(vert.v);
+	});
+
+	out.put_array(tree->poly_centers.data(), tree->poly_centers.size());
+
+	out.put_array(tree->flat_nodes.data(), tree->flat_nodes.size(), [&out](const bsp_collision_flat_node& node) {
+		out.put(node.min);
+		out.put(node.max);
+		out.put(node.skip);
+		out.put(node.first_poly);
+		out.put(node.n_polys);
+	});
+
+	out.put_array(tree->flat_polys.data(), tree->flat_polys.size(), [&out](const bsp_collision_poly& poly) {
+		out.put(poly.plane_norm);
+		out.put(poly.first_point);
+		out.put(poly.leaf);
+		out.put(poly.num_verts);
+		out.put(poly.tmap_num);
+	});
+
+	out.put_array(tree->flat_points.data(), tree->flat_points.size());
+	out.put_array(tree->flat_uvs.data(), tree->flat_uvs.size());
+}
+
+// A broken file shouldn't send model_collide() off into random memory, or around in circles. Children, next leaves and
+// skips always point further ahead, since the trees are built depth first.
+bool tree_indices_valid(const cached_submodel& sm)
+{
+	auto n_nodes = (int)sm.nodes.size();
+	auto n_leaves = (int)sm.leaves.size();
+	auto n_flat_nodes = (int)sm.flat_nodes.size();
+	auto n_flat_polys = (int)sm.flat_polys.size();
+
+	auto links_ahead = [](int link, int index, int count) { return link == -1 || (link > index && link < count); };
+
+	for (int i = 0; i < n_nodes; ++i) {
+		const auto& node = sm.nodes[i];
+		if (!links_ahead(node.front, i, n_nodes) || !links_ahead(node.back, i, n_nodes) || node.leaf < -1 || node.leaf >= n_leaves)
+			return false;
+	}
+
+	for (int i = 0; i < n_leaves; ++i) {
+		const auto& leaf = sm.leaves[i];
+		if (!links_ahead(leaf.next, i, n_leaves) || leaf.vert_start < 0 || (size_t)leaf.vert_start + leaf.num_verts > sm.tmap_verts.size())
+			return false;
+	}
+
+	for (const auto& vert : sm.tmap_verts) {
+		if (vert.vertnum >= sm.points.size())
+			return false;
+	}
+
+	for (int i = 0; i < n_flat_nodes; ++i) {
+		const auto& node = sm.flat_nodes[i];
+		if (node.skip <= i || node.skip > n_flat_nodes || node.first_poly < 0 || node.n_polys < 0 || node.first_poly > n_flat_polys - node.n_polys)
+			return false;
+	}
+
+	if (sm.flat_points.size() != sm.flat_uvs.size())
+		return false;
+
+	for (const auto& poly : sm.flat_polys) {
+		if (poly.leaf < 0 || poly.leaf >= n_leaves || poly.first_point < 0 || (size_t)poly.first_point + poly.num_verts > sm.flat_points.size())
+			return false;
+	}
+
+	return true;
+}
+
+bool read_tree(cache_reader& in, cached_submodel& sm)
+{
+	if (!in.get_array(sm.points, 12))
+		return false;
+
+	if (!in.get_array(sm.nodes, 36, [&in](bsp_collision_node& node) {
+		return in.get(node.min) && in.get(node.max) && in.get(node.back) && in.get(node.front) && in.get(node.leaf);
+	}))
+		return false;
+
+	if (!in.get_array(sm.leaves, 22, [&in](bsp_collision_leaf& leaf) {
+		return in.get(leaf.plane_norm) && in.get(leaf.vert_start) && in.get(leaf.num_verts) && in.get(leaf.tmap_num) && in.get(leaf.next);
+	}))
+		return false;
+
+	if (!in.get_array(sm.tmap_verts, 12, [&in](model_tmap_vert& vert) {
+		vert = model_tmap_vert();
+		return in.get(vert.vertnum) && in.get(vert.u) && in.get(vert.v);
+	}))
+		return false;
+
+	if (!in.get_array(sm.poly_centers, 12))
+		return false;
+
+	if (!in.get_array(sm.flat_nodes, 36, [&in](bsp_collision_flat_node& node) {
+		return in.get(node.min) && in.get(node.max) && in.get(node.skip) && in.get(node.first_poly) && in.get(node.n_polys);
+	}))
+		return false;
+
+	if (!in.get_array(sm.flat_polys, 22, [&in](bsp_collision_poly& poly) {
+		return in.get(poly.plane_norm) && in.get(poly.first_point) && in.get(poly.leaf) && in.get(poly.num_verts) && in.get(poly.tmap_num);
+	}))
+		return false;
+
+	if (!in.get_array(sm.flat_points, 12) || !in.get_array(sm.flat_uvs, 8))
+		return false;
+
+	return tree_indices_valid(sm);
+}
+
+// only the position and the uv of the vertices of a submodel's mesh are set, see bsp_polygon_data::generate_triangles()
+void write_buffer(cache_writer& out, const bsp_info* sm)
+{
+	auto model_list = sm->buffer.model_list;
+
+	out.put(sm->buffer.flags);
+	out.put((ubyte)(model_list != nullptr));
+
+	if (model_list == nullptr) {
+		return;
+	}
+
+	auto n_verts = (size_t)model_list->n_verts;
+
+	out.put_array(model_list->vert, n_verts, [&out](const vertex& vert) {
+		out.put(vert.world);
+		out.put(vert.texture_position);
+	});
+	out.put_array(model_list->norm, n_verts);
+
+	out.put((ubyte)(model_list->tsb != nullptr));
+	if (model_list->tsb != nullptr) {
+		out.put_array(model_list->tsb, n_verts, [&out](const tsb_t& tsb) {
+			out.put(tsb.tangent);
+			out.put(tsb.scaler);
+		});
+	}
+
+	out.put_array(model_list->submodels, n_verts);
+	out.put_array(model_list->sorted_indices, n_verts);
+
+	out.put((int)sm->buffer.tex_buf.size());
+	for (const auto& tex : sm->buffer.tex_buf) {
+		out.put(tex.flags);
+		out.put(tex.texture);
+		out.put_array(tex.get_index(), tex.n_verts);
+	}
+}
+
+bool read_buffer(cache_reader& in, cached_submodel& sm)
+{
+	ubyte has_model_list;
+	if (!in.get(sm.buffer_flags) || !in.get(has_model_list))
+		return false;
+
+	if (!has_model_list)
+		return true;
+
+	SCP_vector<vertex> verts;
+	if (!in.get_array(verts, 20, [&in](vertex& vert) {
+		vert = vertex();
+		return in.get(vert.world) && in.get(vert.texture_position);
+	}))
+		return false;
+
+	SCP_vector<vec3d> norms;
+	if (!in.get_array(norms, 12) || norms.size() != verts.size())
+		return false;
+
+	// the cache key knows about -normal, but make sure the file agrees before poly_list::allocate() relies on it
+	ubyte has_tsb;
+	SCP_vector<tsb_t> tsbs;
+	if (!in.get(has_tsb) || (has_tsb != 0) != (Cmdline_normal != 0))
+		return false;
+	if (has_tsb && (!in.get_array(tsbs, 16, [&in](tsb_t& tsb) { return in.get(tsb.tangent) && in.get(tsb.scaler); }) || tsbs.size() != verts.size()))
+		return false;
+
+	SCP_vector<int> submodels;
+	SCP_vector<uint> sorted_indices;
+	if (!in.get_array(submodels, 4) || !in.get_array(sorted_indices, 4) || submodels.size() != verts.size() || sorted_indices.size() != verts.size())
+		return false;
+
+	int n_tex_buf;
+	if (!in.get_count(n_tex_buf, 12))
+		return false;
+
+	for (int i = 0; i < n_tex_buf; ++i) {
+		int flags, texture, n_indices;
+		if (!in.get(flags) || !in.get(texture) || texture < 0 || texture >= MAX_MODEL_TEXTURES || !in.get_count(n_indices, 4))
+			return false;
+
+		buffer_data tex(n_indices);
+		tex.flags = flags;
+		tex.texture = texture;
+
+		for (int j = 0; j < n_indices; ++j) {
+			uint index;
+			if (!in.get(index) || index >= verts.size())
+				return false;
+			tex.assign(j, index);
+		}
+
+		sm.tex_buf.push_back(tex);
+	}
+
+	auto n_verts = (int)verts.size();
+
+	sm.model_list.reset(new poly_list);
+	sm.model_list->allocate(n_verts);
+
+	if (n_verts > 0) {
+		memcpy(sm.model_list->vert, verts.data(), sizeof(vertex) * n_verts);
+		memcpy(sm.model_list->norm, norms.data(), sizeof(vec3d) * n_verts);
+		if (has_tsb) {
+			memcpy(sm.model_list->tsb, tsbs.data(), sizeof(tsb_t) * n_verts);
+		}
+		memcpy(sm.model_list->submodels, submodels.data(), sizeof(int) * n_verts);
+		memcpy(sm.model_list->sorted_indices, sorted_indices.data(), sizeof(uint) * n_verts);
+	}
+	sm.model_list->n_verts = n_verts;
+
+	return true;
+}
+
+// the outline has positions and colors, see bsp_polygon_data::generate_lines()
+void write_outline(cache_writer& out, const bsp_info* sm)
+{
+	out.put_array(sm->outline_buffer.get(), sm->n_verts_outline, [&out](const vertex& vert) {
+		out.put(vert.world);
+		out.put(vert.r);
+		out.put(vert.g);
+		out.put(vert.b);
+		out.put(vert.a);
+	});
+}
+
+bool read_outline(cache_reader& in, cached_submodel& sm)
+{
+	return in.get_array(sm.outline, 16, [&in](vertex& vert) {
+		vert = vertex();
+		return in.get(vert.world) && in.get(vert.r) && in.get(vert.g) && in.get(vert.b) && in.get(vert.a);
+	});
+}
+
+template <typename T>
+T* copy_to_vm_array(const SCP_vector<T>& items)
+{
+	if (items.empty()) {
+		return nullptr;
+	}
+
+	auto array = (T*)vm_malloc(sizeof(T) * items.size());
+	memcpy(array, items.data(), sizeof(T) * items.size());
+	return array;
+}
+
+void apply_submodel(bsp_info* sm, bsp_collision_tree* tree, cached_submodel& cached)
+{
+	tree->point_list = copy_to_vm_array(cached.points);
+	tree->n_verts = (int)cached.points.size();
+	tree->node_list = copy_to_vm_array(cached.nodes);
+	tree->n_nodes = (int)cached.nodes.size();
+	tree->leaf_list = copy_to_vm_array(cached.leaves);
+	tree->n_leaves = (int)cached.leaves.size();
+	tree->vert_list = copy_to_vm_array(cached.tmap_verts);
+	tree->poly_centers = std::move(cached.poly_centers);
+	tree->flat_nodes = std::move(cached.flat_nodes);
+	tree->flat_polys = std::move(cached.flat_polys);
+	tree->flat_points = std::move(cached.flat_points);
+	tree->flat_uvs = std::move(cached.flat_uvs);
+
+	sm->buffer.flags = cached.buffer_flags;
+	sm->buffer.model_list = cached.model_list.release();
+	sm->buffer.tex_buf = std::move(cached.tex_buf);
+
+	if (!cached.outline.empty()) {
+		sm->n_verts_outline = (uint)cached.outline.size();
+		sm->outline_buffer = make_shared<vertex[]>(sm->n_verts_outline);
+		std::copy(cached.outline.begin(), cached.outline.end(), sm->outline_buffer.get());
+	}
+}
+
+bool read_cache_file(const SCP_string& key, SCP_vector<ubyte>& data)
+{
+	auto fp = cfopen(cache_filename(key).c_str(), "rb", CF_TYPE_CACHE, false, MODEL_CACHE_LOCATIONS);
+	if (!fp) {
+		return false;
+	}
+
+	auto length = cfilelength(fp);
+	data.resize((size_t)std::max(length, 0));
+
+	bool ok = length > 0 && cfread(data.data(), 1, length, fp) == length;
+	cfclose(fp);
+
+	return ok;
+}
+
+}
+
+bool model_cache_enabled()
+{
+	return (Cmdline_model_cache || Cmdline_verify_model_cache) && !Is_standalone;
+}
+
+SCP_string model_cache_key(const polymodel* pm, const model_read_deferred_tasks& deferredTasks)
+{
+	MD5 md5;
+	auto add_int = [&md5](int value) { md5.update(reinterpret_cast<const char*>(&value), (MD5::size_type)sizeof(value)); };
+
+	add_int(MODEL_CACHE_VERSION);
+	add_int((int)sizeof(vertex));
+	add_int(Cmdline_normal ? 1 : 0);
+
+	add_int(pm->version);
+	add_int(pm->n_models);
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		const auto sm = &pm->submodel[i];
+
+		add_int(sm->bsp_data_size);
+		md5.update(reinterpret_cast<const char*>(sm->bsp_data.get()), (MD5::size_type)sm->bsp_data_size);
+
+		// textures which got swapped around by a virtual POF end up in the vertex buffers
+		auto replace = deferredTasks.texture_replacements.find(i);
+		if (replace != deferredTasks.texture_replacements.end()) {
+			add_int((int)replace->second.replacementIds.size());
+			for (const auto& ids : replace->second.replacementIds) {
+				add_int(ids.first);
+				add_int(ids.second);
+			}
+		} else {
+			add_int(0);
+		}
+	}
+
+	md5.finalize();
+	return md5.hexdigest();
+}
+
+void model_cache_serialize(const polymodel* pm, const SCP_string& key, SCP_vector<ubyte>& out, SCP_vector<size_t>* submodel_offsets)
+{
+	cache_writer writer(out);
+
+	writer.put(MODEL_CACHE_MAGIC);
+	writer.put(MODEL_CACHE_VERSION);
+	writer.put_array(key.c_str(), key.size());
+	writer.put(pm->n_models);
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		const auto sm = &pm->submodel[i];
+
+		if (submodel_offsets != nullptr) {
+			submodel_offsets->push_back(writer.size());
+		}
+
+		write_tree(writer, &Bsp_collision_tree_list[sm->collision_tree_index]);
+		write_buffer(writer, sm);
+		write_outline(writer, sm);
+	}
+}
+
+bool model_cache_deserialize(polymodel* pm, const SCP_string& key, const ubyte* data, size_t size)
+{
+	cache_reader reader(data, size);
+
+	uint magic;
+	int version;
+	SCP_vector<char> file_key;
+	int n_models;
+
+	if (!reader.get(magic) || magic != MODEL_CACHE_MAGIC || !reader.get(version) || version != MODEL_CACHE_VERSION)
+		return false;
+
+	if (!reader.get_array(file_key, 1) || SCP_string(file_key.begin(), file_key.end()) != key)
+		return false;
+
+	if (!reader.get(n_models) || n_models != pm->n_models)
+		return false;
+
+	SCP_vector<cached_submodel> submodels(n_models);
+	for (auto& cached : submodels) {
+		if (!read_tree(reader, cached) || !read_buffer(reader, cached) || !read_outline(reader, cached))
+			return false;
+	}
+
+	if (!reader.at_end())
+		return false;
+
+	for (int i = 0; i < n_models; ++i) {
+		auto sm = &pm->submodel[i];
+
+		Assertion(sm->collision_tree_index >= 0 && (size_t)sm->collision_tree_index < Bsp_collision_tree_list.size(),
+			"Submodel %d of model %s needs a collision tree before it can be read from the cache!", i, pm->filename);
+		Assertion(sm->buffer.model_list == nullptr, "Submodel %d of model %s already has a vertex buffer!", i, pm->filename);
+
+		apply_submodel(sm, &Bsp_collision_tree_list[sm->collision_tree_index], submodels[i]);
+	}
+
+	return true;
+}
+
+bool model_cache_read(polymodel* pm, const SCP_string& key)
+{
+	SCP_vector<ubyte> data;
+	if (!read_cache_file(key, data)) {
+		return false;
+	}
+
+	if (!model_cache_deserialize(pm, key, data.data(), data.size())) {
+		mprintf(("Cached data of model %s is unusable, building it again...\n", pm->filename));
+		return false;
+	}
+
+	nprintf(("ModelCache", "Read model %s from the cache.\n", pm->filename));
+	return true;
+}
+
+void model_cache_write(const polymodel* pm, const SCP_string& key)
+{
+	SCP_vector<ubyte> data;
+	SCP_vector<size_t> submodel_offsets;
+	model_cache_serialize(pm, key, data, &submodel_offsets);
+
+	if (Cmdline_verify_model_cache) {
+		SCP_vector<ubyte> cached;
+		if (read_cache_file(key, cached)) {
+			if (cached == data) {
+				mprintf(("Cached data of model %s matches the freshly built data.\n", pm->filename));
+				return;
+			}
+
+			auto mismatch = (size_t)(std::mismatch(data.begin(), data.begin() + std::min(data.size(), cached.size()), cached.begin()).first - data.begin());
+			auto submodel = (int)(std::upper_bound(submodel_offsets.begin(), submodel_offsets.end(), mismatch) - submodel_offsets.begin()) - 1;
+
+			Warning(LOCATION, "Cached data of model %s does not match the freshly built data, starting at byte " SIZE_T_ARG " (submodel %s). The cache file will be replaced.",
+				pm->filename, mismatch, submodel >= 0 ? pm->submodel[submodel].name : "none, in the header");
+		}
+	}
+
+	auto fp = cfopen(cache_filename(key).c_str(), "wb", CF_TYPE_CACHE, false, MODEL_CACHE_LOCATIONS);
+	if (!fp) {
+		mprintf(("Could not open model cache file for %s!\n", pm->filename));
+		return;
+	}
+
+	if (cfwrite(data.data(), 1, (int)data.size(), fp) != (int)data.size()) {
+		mprintf(("Failed to write model cache file for %s!\n", pm->filename));
+	}
+	cfclose(fp);
+}
+
+void model_cache_purge_old()
+{
+	SCP_vector<SCP_string> cache_files;
+	SCP_vector<file_list_info> file_info;
+	cf_get_file_list(cache_files, CF_TYPE_CACHE, (SCP_string("*") + MODEL_CACHE_EXT).c_str(), CF_SORT_NONE, &file_info, MODEL_CACHE_LOCATIONS);
+
+	Assertion(cache_files.size() == file_info.size(),
+			  "cf_get_file_list returned different sizes for file names and file informations!");
+
+	const auto TIMEOUT = 2.0 * 30.0 * 24.0 * 60.0 * 60.0; // purge timeout in seconds which is ~2 months
+
+	auto now = std::time(nullptr);
+	for (size_t i = 0; i < cache_files.size(); ++i) {
+		if (cache_files[i].compare(0, MODEL_CACHE_PREFIX.size(), MODEL_CACHE_PREFIX) != 0) {
+			// Not a model cache file
+			continue;
+		}
+
+		if (std::difftime(now, file_info[i].write_time) > TIMEOUT) {
+			cf_delete((cache_files[i] + MODEL_CACHE_EXT).c_str(), CF_TYPE_CACHE);
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "model/model.h"
+
+/*
+ * On-disk cache of the data model_load() derives from the BSP data of a model: the collision trees and the vertices
+ * and indices of every submodel's vertex buffer. The cache files live in data/cache and are named after a hash of
+ * everything this data is built from, so an edited POF, virtual POF or texture replacement simply ends up with a
+ * different file. Whatever needs bmpman or the renderer (transparency and detail buffers, the GPU buffers themselves
+ * and the shield mesh) is still done at load time.
+ */
+
+// Whether model_load() should look for and write cache files, see -model_cache and -verify_model_cache
+bool model_cache_enabled();
+
+// The name of the cache file for a model which has been read but whose trees and buffers haven't been built yet
+SCP_string model_cache_key(const polymodel* pm, const model_read_deferred_tasks& deferredTasks);
+
+// Fills in the collision trees and submodel vertex buffers from the cache, returns false if there is nothing usable
+bool model_cache_read(polymodel* pm, const SCP_string& key);
+
+// Writes the collision trees and submodel vertex buffers of a freshly built model. With -verify_model_cache, whatever
+// was cached before is compared to the fresh data first, and any difference is reported.
+void model_cache_write(const polymodel* pm, const SCP_string& key);
+
+// Deletes cache files which haven't been written to in a long time
+void model_cache_purge_old();
+
+// The file format, exposed for the tests. Deserializing either fills in all of the model or leaves it alone.
+void model_cache_serialize(const polymodel* pm, const SCP_string& key, SCP_vector<ubyte>& out, SCP_vector<size_t>* submodel_offsets = nullptr);
+bool model_cache_deserialize(polymodel* pm, const SCP_string& key, const ubyte* data, size_t size);
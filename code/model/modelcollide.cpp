@@ -77,7 +77,7 @@ void model_collide_allocate_point_list(int n_points)
 // Returns non-zero if vector from p0 to pdir 
 // intersects the bounding box.
 // hitpos could be NULL, so don't fill it if it is.
-int mc_ray_boundingbox( vec3d *min, vec3d *max, vec3d * p0, vec3d *pdir, vec3d *hitpos )
+int mc_ray_boundingbox( const vec3d *min, const vec3d *max, const vec3d * p0, const vec3d *pdir, vec3d *hitpos )
 {
 
 	vec3d tmp_hitpos;
@@ -381,22 +381,20 @@ int model_collide_parse_bsp_defpoints(ubyte * p)
 	return nverts;
 }
 
-void model_collide_bsp_poly(bsp_collision_tree *tree, int leaf_index)
+static void model_collide_bsp_polys(bsp_collision_tree *tree, const bsp_collision_flat_node *node)
 {
-	int i;
-	int tested_leaf = leaf_index;
-	uv_pair uvlist[TMAP_MAX_VERTS];
 	vec3d *points[TMAP_MAX_VERTS];
 
-	while ( tested_leaf >= 0 ) {
-		bsp_collision_leaf *leaf = &tree->leaf_list[tested_leaf];
+	const int end = node->first_poly + node->n_polys;
+	for ( int i = node->first_poly; i < end; ++i ) {
+		bsp_collision_poly *poly = &tree->flat_polys[i];
+		bsp_collision_leaf *leaf = &tree->leaf_list[poly->leaf];
 
 		bool flat_poly = false;
-		int vert_start = leaf->vert_start;
-		int nv = leaf->num_verts;
+		int nv = poly->num_verts;
 
-		if ( leaf->tmap_num < MAX_MODEL_TEXTURES ) {
-			if ( (!(Mc->flags & MC_CHECK_INVISIBLE_FACES)) && (Mc_pm->maps[leaf->tmap_num].textures[TM_BASE_TYPE].GetTexture() < 0) )	{
+		if ( poly->tmap_num < MAX_MODEL_TEXTURES ) {
+			if ( (!(Mc->flags & MC_CHECK_INVISIBLE_FACES)) && (Mc_pm->maps[poly->tmap_num].textures[TM_BASE_TYPE].GetTexture() < 0) )	{
 				// Don't check invisible polygons.
 				//SUSHI: Unless $collide_invisible is set.
 				if (!(Mc_pm->submodel[Mc_submodel].flags[Model::Submodel_flags::Collide_invisible]))
@@ -406,56 +404,115 @@ void model_collide_bsp_poly(bsp_collision_tree *tree, int leaf_index)
 			flat_poly = true;
 		}
 
-		int vert_num;
-		for ( i = 0; i < nv; ++i ) {
-			vert_num = tree->vert_list[vert_start+i].vertnum;
-			points[i] = &tree->point_list[vert_num];
-
-			uvlist[i].u = tree->vert_list[vert_start+i].u;
-			uvlist[i].v = tree->vert_list[vert_start+i].v;
+		for ( int j = 0; j < nv; ++j ) {
+			points[j] = &tree->flat_points[poly->first_point + j];
 		}
 
 		if ( flat_poly ) {
 			if ( Mc->flags & MC_CHECK_SPHERELINE ) {
-				mc_check_sphereline_face(nv, points, points[0], &leaf->plane_norm, nullptr, -1, nullptr, leaf);
+				mc_check_sphereline_face(nv, points, points[0], &poly->plane_norm, nullptr, -1, nullptr, leaf);
 			} else {
-				mc_check_face(nv, points, points[0], &leaf->plane_norm, nullptr, -1, nullptr, leaf);
+				mc_check_face(nv, points, points[0], &poly->plane_norm, nullptr, -1, nullptr, leaf);
 			}
 		} else {
+			uv_pair *uvlist = &tree->flat_uvs[poly->first_point];
+
 			if ( Mc->flags & MC_CHECK_SPHERELINE ) {
-				mc_check_sphereline_face(nv, points, points[0], &leaf->plane_norm, uvlist, leaf->tmap_num, nullptr, leaf);
+				mc_check_sphereline_face(nv, points, points[0], &poly->plane_norm, uvlist, poly->tmap_num, nullptr, leaf);
 			} else {
-				mc_check_face(nv, points, points[0], &leaf->plane_norm, uvlist, leaf->tmap_num, nullptr, leaf);
+				mc_check_face(nv, points, points[0], &poly->plane_norm, uvlist, poly->tmap_num, nullptr, leaf);
 			}
 		}
-
-		tested_leaf = leaf->next;
 	}
 }
 
-void model_collide_bsp(bsp_collision_tree *tree, int node_index)
+static void model_collide_bsp(bsp_collision_tree *tree)
 {
-	if ( tree->node_list == NULL || tree->n_verts <= 0) {
+	if ( tree->flat_nodes.empty() || tree->n_verts <= 0) {
 		return;
 	}
 
-	bsp_collision_node *node = &tree->node_list[node_index];
+	const bsp_collision_flat_node *nodes = tree->flat_nodes.data();
+	const int n_nodes = (int)tree->flat_nodes.size();
 	vec3d hitpos;
 
-	// check the bounding box of this node. if it passes, check left and right children
-	if ( mc_ray_boundingbox( &node->min, &node->max, &Mc_p0, &Mc_direction, &hitpos ) ) {
+	int node_index = 0;
+	while ( node_index < n_nodes ) {
+		const bsp_collision_flat_node *node = &nodes[node_index];
+
+		// check the bounding box of this node. if it fails, skip everything below it
+		if ( !mc_ray_boundingbox( &node->min, &node->max, &Mc_p0, &Mc_direction, &hitpos ) ) {
+			node_index = node->skip;
+			continue;
+		}
+
 		if ( !(Mc->flags & MC_CHECK_RAY) && (vm_vec_dist(&hitpos, &Mc_p0) > Mc_mag) ) {
 			// The ray isn't long enough to intersect the bounding box
-			return;
+			node_index = node->skip;
+			continue;
 		}
 
-		if ( node->leaf >= 0 ) {
-			model_collide_bsp_poly(tree, node->leaf);
-		} else {
-			if ( node->back >= 0 ) model_collide_bsp(tree, node->back);
-			if ( node->front >= 0 ) model_collide_bsp(tree, node->front);
+		if ( node->n_polys > 0 ) {
+			model_collide_bsp_polys(tree, node);
+		}
+
+		// either the first child, or for leaves the next node anyway
+		++node_index;
+	}
+}
+
+static void model_collide_flatten_bsp_node(bsp_collision_tree *tree, int node_index)
+{
+	const bsp_collision_node *node = &tree->node_list[node_index];
+
+	const int flat_index = (int)tree->flat_nodes.size();
+	tree->flat_nodes.push_back({ node->min, node->max, -1, (int)tree->flat_polys.size(), 0 });
+
+	if ( node->leaf >= 0 ) {
+		for ( int leaf_index = node->leaf; leaf_index >= 0; leaf_index = tree->leaf_list[leaf_index].next ) {
+			const bsp_collision_leaf *leaf = &tree->leaf_list[leaf_index];
+
+			tree->flat_polys.push_back({ leaf->plane_norm, (int)tree->flat_points.size(), leaf_index, leaf->num_verts, leaf->tmap_num });
+
+			for ( int i = 0; i < leaf->num_verts; ++i ) {
+				const model_tmap_vert *vert = &tree->vert_list[leaf->vert_start + i];
+
+				tree->flat_points.push_back(tree->point_list[vert->vertnum]);
+				tree->flat_uvs.push_back({ vert->u, vert->v });
+			}
 		}
+
+		tree->flat_nodes[flat_index].n_polys = (int)tree->flat_polys.size() - tree->flat_nodes[flat_index].first_poly;
+	} else {
+		// same order as the checks in model_collide_bsp() used to recurse in
+		if ( node->back >= 0 ) model_collide_flatten_bsp_node(tree, node->back);
+		if ( node->front >= 0 ) model_collide_flatten_bsp_node(tree, node->front);
 	}
+
+	tree->flat_nodes[flat_index].skip = (int)tree->flat_nodes.size();
+}
+
+/**
+ * @brief Lays out the nodes and polygons of a parsed collision tree in the order they are checked in
+ *
+ * The walk over the flattened tree tests the same boxes and polygons in the same order as a recursive walk over
+ * node_list and leaf_list does, so the collision results are exactly the same.
+ */
+void model_collide_flatten_bsp(bsp_collision_tree *tree)
+{
+	tree->flat_nodes.clear();
+	tree->flat_polys.clear();
+	tree->flat_points.clear();
+	tree->flat_uvs.clear();
+
+	if ( tree->node_list == nullptr || tree->n_verts <= 0 ) {
+		return;
+	}
+
+	tree->flat_nodes.reserve(tree->n_nodes);
+	tree->flat_polys.reserve(tree->n_leaves);
+
+	model_collide_flatten_bsp_node(tree, 0);
 }
 
 void model_collide_parse_bsp_tmappoly(bsp_collision_leaf *leaf, SCP_vector<model_tmap_vert> *vert_buffer, void *model_ptr)
@@ -607,12 +664,14 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, ubyte *bsp_data, int vers
 		// finally copy the vert list.
 		tree->vert_list = NULL;
 
+		model_collide_flatten_bsp(tree);
+
 		return;
 	}
 
 	p += chunk_size;
 
-	bsp_collision_node new_node;
+	bsp_collision_node new_node{};
 	bsp_collision_leaf new_leaf{ vmd_zero_vector, 0, 0, 0, 0 };
 
 	SCP_vector<bsp_collision_node> node_buffer;
@@ -825,6 +884,8 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, ubyte *bsp_data, int vers
 	tree->vert_list = (model_tmap_vert*)vm_malloc(sizeof(model_tmap_vert) * vert_buffer.size());
 	memcpy(tree->vert_list, &vert_buffer[0], sizeof(model_tmap_vert) * vert_buffer.size());
 	vert_buffer.clear();
+
+	model_collide_flatten_bsp(tree);
 }
 
 bool mc_shield_check_common(shield_tri	*tri)
@@ -1061,9 +1122,9 @@ void mc_check_subobj( int mn )
 					}
 				}
 
-				model_collide_bsp(model_get_bsp_collision_tree(lod_sm->collision_tree_index), 0);
+				model_collide_bsp(model_get_bsp_collision_tree(lod_sm->collision_tree_index));
 			} else {
-				model_collide_bsp(model_get_bsp_collision_tree(sm->collision_tree_index), 0);
+				model_collide_bsp(model_get_bsp_collision_tree(sm->collision_tree_index));
 			}
 		}
 	}
@@ -1119,13 +1180,11 @@ NoHit:
 
 MONITOR(NumFVI)
 
-// See model.h for usage.   I don't want to put the
-// usage here because you need to see the #defines and structures
-// this uses while reading the help.   
-int model_collide(mc_info *mc_info_obj)
+// Resets the results in Mc, fills in the globals every check of Mc needs and does the quick check against the
+// bounding sphere of the model.  Returns false if there's nothing left to check, either because the sphere was
+// missed or because the sphere was all that had to be checked.
+static bool mc_collide_start()
 {
-	Mc = mc_info_obj;
-
 	MONITOR_INC(NumFVI,1);
 
 	Mc->num_hits = 0;				// How many collisions were found
@@ -1135,7 +1194,7 @@ int model_collide(mc_info *mc_info_obj)
 
 	if ( (Mc->flags & MC_CHECK_SHIELD) && (Mc->flags & MC_CHECK_MODEL) )	{
 		Error( LOCATION, "Checking both shield and model!\n" );
-		return 0;
+		return false;
 	}
 
 	//Fill in some global variables that all the model collide routines need internally.
@@ -1175,7 +1234,7 @@ int model_collide(mc_info *mc_info_obj)
 	if ( Mc->flags & MC_CHECK_SPHERELINE ) {
 		if ( Mc->radius <= 0.0f ) {
 			Warning(LOCATION, "Attempting to collide with a sphere, but the sphere's radius is <= 0.0f!\n\n(model file is %s; submodel is %d, mc_flags are %d)", Mc_pm->filename, first_submodel, Mc->flags);
-			return 0;
+			return false;
 		}
 
 		// Do a quick check on the Bounding Sphere
@@ -1184,11 +1243,11 @@ int model_collide(mc_info *mc_info_obj)
 				Mc->hit_point = Mc->hit_point_world;
 				Mc->hit_submodel = first_submodel;
 				Mc->num_hits++;
-				return (Mc->num_hits > 0);
+				return false;
 			}
 			// continue checking polygons.
 		} else {
-			return 0;
+			return false;
 		}
 	} else {
 		int r;
@@ -1204,34 +1263,21 @@ int model_collide(mc_info *mc_info_obj)
 				Mc->hit_point = Mc->hit_point_world;
 				Mc->hit_submodel = first_submodel;
 				Mc->num_hits++;
-				return (Mc->num_hits > 0);
+				return false;
 			}
 			// continue checking polygons.
 		} else {
-			return 0;
+			return false;
 		}
 
 	}
 
-	// Check only one subobject; or check submodel and any children
-	if ( (Mc->flags & MC_SUBMODEL) || (Mc->flags & MC_SUBMODEL_INSTANCE) ) {
-		// note: within this function, MC_SUBMODEL will return after one check; but MC_SUBMODEL_INSTANCE will not
-		mc_check_subobj(Mc->submodel_num);
-	}
-	// Check all the the highest detail model polygons and subobjects for intersections
-	else {
-		// Don't check it or its children if it is destroyed
-		if ( Mc_pmi ) {
-			if ( !Mc_pmi->submodel[Mc_pm->detail[0]].blown_off ) {
-				mc_check_subobj(Mc_pm->detail[0]);
-			}
-		} else {
-			mc_check_subobj(Mc_pm->detail[0]);
-		}
-	}
-
+	return true;
+}
 
-	//If we found a hit, then rotate it into world coordinates	
+// Rotates the hits found for Mc into world coordinates
+static void mc_collide_finish()
+{
 	if ( Mc->num_hits )	{
 		if ( Mc->flags & MC_SUBMODEL )	{
 			// If we're just checking one submodel, don't use normal instancing to find world points
@@ -1244,7 +1290,7 @@ int model_collide(mc_info *mc_info_obj)
 				model_local_to_global_point(&Mc->hit_point_world, &Mc->hit_point, Mc_pm, Mc->hit_submodel, Mc->orient, Mc->pos);
 			}
 		}
-		
+	
 		// do the same for the list of hitpoints, if necessary
 		if (Mc->flags & MC_COLLIDE_ALL) {
 			for (size_t i = 0; i < Mc->hit_points_all.size(); i++) {
@@ -1263,6 +1309,263 @@ int model_collide(mc_info *mc_info_obj)
 		}
 
 	}
+}
+
+// See model.h for usage.   I don't want to put the
+// usage here because you need to see the #defines and structures
+// this uses while reading the help.   
+int model_collide(mc_info *mc_info_obj)
+{
+	Mc = mc_info_obj;
+
+	if ( !mc_collide_start() ) {
+		return Mc->num_hits;
+	}
+
+	// Check only one subobject; or check submodel and any children
+	if ( (Mc->flags & MC_SUBMODEL) || (Mc->flags & MC_SUBMODEL_INSTANCE) ) {
+		// note: within this function, MC_SUBMODEL will return after one check; but MC_SUBMODEL_INSTANCE will not
+		mc_check_subobj(Mc->submodel_num);
+	}
+	// Check all the the highest detail model polygons and subobjects for intersections
+	else {
+		// Don't check it or its children if it is destroyed
+		if ( Mc_pmi ) {
+			if ( !Mc_pmi->submodel[Mc_pm->detail[0]].blown_off ) {
+				mc_check_subobj(Mc_pm->detail[0]);
+			}
+		} else {
+			mc_check_subobj(Mc_pm->detail[0]);
+		}
+	}
+
+	mc_collide_finish();
 
 	return Mc->num_hits;
 }
+
+// A ray (or sphere) of model_collide_batch(), along with the way it looks from the submodel being checked
+struct mc_batch_ray {
+	mc_info *mc;
+	float mag;
+	vec3d p0, p1, direction;
+};
+
+static void mc_batch_use_ray(const mc_batch_ray *ray)
+{
+	Mc = ray->mc;
+	Mc_mag = ray->mag;
+	Mc_p0 = ray->p0;
+	Mc_p1 = ray->p1;
+	Mc_direction = ray->direction;
+}
+
+// Whether a check can be done as part of a batch, and can share the walk over the submodels with the given one
+static bool mc_batch_compatible(const mc_info *mc, const mc_info *first)
+{
+	if ( !(mc->flags & MC_CHECK_MODEL) || (mc->flags & (MC_CHECK_SHIELD | MC_ONLY_BOUND_BOX)) ) {
+		return false;
+	}
+
+	// callers which pick the submodels to check themselves get a walk of their own
+	if ( !mc->collision_checked.empty() ) {
+		return false;
+	}
+
+	if ( first == nullptr ) {
+		return true;
+	}
+
+	const int walk_flags = MC_SUBMODEL | MC_SUBMODEL_INSTANCE | MC_RESPECT_DETAIL_BOX_SPHERE;
+
+	return mc->model_num == first->model_num && mc->model_instance_num == first->model_instance_num
+		&& vm_vec_same(mc->pos, first->pos)
+		&& vm_vec_same(&mc->orient->vec.rvec, &first->orient->vec.rvec)
+		&& vm_vec_same(&mc->orient->vec.uvec, &first->orient->vec.uvec)
+		&& vm_vec_same(&mc->orient->vec.fvec, &first->orient->vec.fvec)
+		&& (mc->flags & walk_flags) == (first->flags & walk_flags)
+		&& mc->submodel_num == first->submodel_num && mc->lod == first->lod;
+}
+
+// The batched version of mc_check_subobj().  All the rays share the flags which decide which submodels get checked,
+// so the submodels are only walked once, and every ray is rotated into each submodel just once.  The order of the
+// rays gets shuffled around, which doesn't matter since every ray has its own results.
+static void mc_batch_check_subobj( int mn, mc_batch_ray **rays, size_t n_rays )
+{
+	Assert( mn >= 0 );
+	Assert( mn < Mc_pm->n_models );
+	if ( (mn < 0) || (mn>=Mc_pm->n_models) ) return;
+
+	bsp_info *sm = &Mc_pm->submodel[mn];
+	if (sm->flags[Model::Submodel_flags::No_collisions]) return; // don't do collisions
+
+	const mc_info *first = rays[0]->mc;
+	bool check_this = !sm->flags[Model::Submodel_flags::Nocollide_this_only];
+
+	if (check_this && (first->flags & MC_RESPECT_DETAIL_BOX_SPHERE)) {
+		vec3d local;
+		vm_vec_sub(&local, &Eye_position, first->pos);
+		vm_vec_rotate(&local, &local, first->orient);
+		check_this = model_render_check_detail_box(&local, Mc_pm, mn, MR_NORMAL);
+	}
+
+	if (check_this) {
+		// Rotate the rays into this subobject's frame of reference, and sort them into the ones which are done
+		// (at the end), the ones which hit this subobject's bounding box (at the start) and the rest
+		size_t n_hits = 0;
+		size_t i = 0;
+
+		while ( i < n_rays ) {
+			mc_batch_ray *ray = rays[i];
+			vec3d tempv;
+
+			vm_vec_sub(&tempv, ray->mc->p0, &Mc_base);
+			vm_vec_rotate(&ray->p0, &tempv, &Mc_orient);
+
+			vm_vec_sub(&tempv, ray->mc->p1, &Mc_base);
+			vm_vec_rotate(&ray->p1, &tempv, &Mc_orient);
+			vm_vec_sub(&ray->direction, &ray->p1, &ray->p0);
+
+			mc_batch_use_ray(ray);
+
+			// bail early if no ray exists, and quickly bail if we aren't inside the full model bbox
+			if ( IS_VEC_NULL(&Mc_direction) || ((Mc_pm->detail[0] == mn) && !mc_ray_boundingbox( &Mc_pm->mins, &Mc_pm->maxs, &Mc_p0, &Mc_direction, nullptr )) ) {
+				std::swap(rays[i], rays[--n_rays]);
+				continue;
+			}
+
+			if ( mc_ray_boundingbox(&sm->min, &sm->max, &Mc_p0, &Mc_direction, nullptr) ) {
+				std::swap(rays[i], rays[n_hits++]);
+			}
+
+			++i;
+		}
+
+		if ( n_hits > 0 ) {
+			bsp_info *lod_sm = sm;
+
+			if (first->lod > 0 && sm->num_details > 0) {
+				for (int j = first->lod - 1; j >= 0; j--) {
+					if (sm->details[j] != -1) {
+						lod_sm = &Mc_pm->submodel[sm->details[j]];
+						break;
+					}
+				}
+			}
+
+			// one ray after the other, while the tree is at hand
+			bsp_collision_tree *tree = model_get_bsp_collision_tree(lod_sm->collision_tree_index);
+			Mc_submodel = mn;
+
+			for ( i = 0; i < n_hits; ++i ) {
+				mc_batch_use_ray(rays[i]);
+				model_collide_bsp(tree);
+			}
+		}
+	}
+
+	// If we're only checking one submodel, return
+	if (first->flags & MC_SUBMODEL)	{
+		return;
+	}
+
+	// If this subobject doesn't have any children, or nothing is left to check against them, we're done checking it.
+	if ( sm->num_children < 1 || n_rays < 1 ) return;
+
+	matrix saved_orient = Mc_orient;
+	vec3d saved_base = Mc_base;
+
+	// Check all of this subobject's children
+	int i = sm->first_child;
+	while ( i >= 0 )	{
+		auto csm = &Mc_pm->submodel[i];
+		matrix instance_orient = vmd_identity_matrix;
+		vec3d instance_offset = csm->offset;
+		bool blown_off = false;
+
+		if ( Mc_pmi ) {
+			auto csmi = &Mc_pmi->submodel[i];
+			instance_orient = csmi->canonical_orient;
+			vm_vec_add2(&instance_offset, &csmi->canonical_offset);
+
+			blown_off = csmi->blown_off;
+		}
+
+		// Don't check it or its children if it is destroyed
+		// or if it's set to no collision
+		if ( !blown_off && !csm->flags[Model::Submodel_flags::No_collisions] )	{
+			vm_vec_unrotate(&Mc_base, &instance_offset, &saved_orient);
+			vm_vec_add2(&Mc_base, &saved_base);
+
+			vm_matrix_x_matrix(&Mc_orient, &saved_orient, &instance_orient);
+
+			mc_batch_check_subobj( i, rays, n_rays );
+		}
+
+		i = csm->next_sibling;
+	}
+}
+
+// See model.h for usage.
+int model_collide_batch(mc_info **mc_info_list, int count)
+{
+	const mc_info *first = nullptr;
+	SCP_vector<mc_info *> batched;
+
+	// anything which can't share the walk over the model is checked on its own
+	for ( int i = 0; i < count; ++i ) {
+		if ( mc_batch_compatible(mc_info_list[i], first) ) {
+			if ( first == nullptr ) {
+				first = mc_info_list[i];
+			}
+			batched.push_back(mc_info_list[i]);
+		} else {
+			model_collide(mc_info_list[i]);
+		}
+	}
+
+	// the quick checks against the bounding sphere, which also leave the globals set up for the model
+	SCP_vector<mc_batch_ray> rays;
+	rays.reserve(batched.size());
+
+	for ( auto mc : batched ) {
+		Mc = mc;
+		if ( mc_collide_start() ) {
+			rays.push_back({ mc, Mc_mag, vmd_zero_vector, vmd_zero_vector, vmd_zero_vector });
+		}
+	}
+
+	if ( !rays.empty() ) {
+		SCP_vector<mc_batch_ray *> ray_list;
+		ray_list.reserve(rays.size());
+		for ( auto &ray : rays ) {
+			ray_list.push_back(&ray);
+		}
+
+		Mc_orient = *first->orient;
+		Mc_base = *first->pos;
+
+		// Check only one subobject; or check submodel and any children
+		if ( (first->flags & MC_SUBMODEL) || (first->flags & MC_SUBMODEL_INSTANCE) ) {
+			mc_batch_check_subobj(first->submodel_num, ray_list.data(), ray_list.size());
+		}
+		// Don't check the highest detail model or its children if it is destroyed
+		else if ( !Mc_pmi || !Mc_pmi->submodel[Mc_pm->detail[0]].blown_off ) {
+			mc_batch_check_subobj(Mc_pm->detail[0], ray_list.data(), ray_list.size());
+		}
+
+		for ( auto &ray : rays ) {
+			Mc = ray.mc;
+			mc_collide_finish();
+		}
+	}
+
+	int num_hit = 0;
+	for ( int i = 0; i < count; ++i ) {
+		if ( mc_info_list[i]->num_hits > 0 ) {
+			++num_hit;
+		}
+	}
+
+	return num_hit;
+}
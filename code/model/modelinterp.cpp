@@ -1485,8 +1485,9 @@ void model_page_out_textures(polymodel* pm, bool release, const SCP_set<int>& sk
 
 
 //**********vertex buffer stuff**********//
-int tri_count[MAX_MODEL_TEXTURES];
-poly_list polygon_list[MAX_MODEL_TEXTURES];
+// per thread, since level paging builds the vertex buffers of several submodels at once
+thread_local int tri_count[MAX_MODEL_TEXTURES];
+thread_local poly_list polygon_list[MAX_MODEL_TEXTURES];
 
 void parse_defpoint(int off, ubyte *bsp_data)
 {
@@ -2101,7 +2102,13 @@ bool model_interp_config_buffer(indexed_vertex_source *vert_src, vertex_buffer *
 	return true;
 }
 
-void interp_configure_vertex_buffers(polymodel *pm, int mn, const model_read_deferred_tasks& deferredTasks)
+/**
+ * Generates the vertices and indices of a submodel from its BSP data
+ *
+ * @details This only touches the submodel itself, so it can run on a worker thread. Where the buffer ends up in the
+ * model's vertex and index lists is decided by interp_place_vertex_buffers() afterwards.
+ */
+void interp_build_vertex_buffers(polymodel *pm, int mn, const model_read_deferred_tasks& deferredTasks)
 {
 	TRACE_SCOPE(tracing::ModelConfigureVertexBuffers);
 
@@ -2243,6 +2250,16 @@ void interp_configure_vertex_buffers(polymodel *pm, int mn, const model_read_def
 
 		model->buffer.tex_buf.push_back( new_buffer );
 	}
+}
+
+// has to be called in submodel order, since every buffer goes after the ones before it
+void interp_place_vertex_buffers(polymodel *pm, int mn)
+{
+	bsp_info *model = &pm->submodel[mn];
+
+	if ( model->buffer.model_list == nullptr ) {
+		return;
+	}
 
 	bool rval = model_interp_config_buffer(&pm->vert_source, &model->buffer, false);
 
@@ -31,6 +31,7 @@
 #include "math/fvi.h"
 #include "math/vecmat.h"
 #include "model/model.h"
+#include "model/modelcache.h"
 #include "model/modelrender.h"
 #include "model/modelreplace.h"
 #include "model/modelsinc.h"
@@ -42,6 +43,7 @@
 #include "graphics/shadows.h"
 #include "weapon/weapon.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 
 #define MODEL_SDR_FLAG_MODE_CPP
 #include "def_files/data/effects/model_shader_flags.h"
@@ -72,7 +74,7 @@ SCP_vector<polymodel_instance*> Polygon_model_instances;
 
 SCP_vector<bsp_collision_tree> Bsp_collision_tree_list;
 
-const ubyte* Macro_ubyte_bounds = nullptr;
+thread_local const ubyte* Macro_ubyte_bounds = nullptr;
 
 //If true, CPU-side vertex buffers are deleted once the model is on-GPU.
 //This is typically desired for memory reasons, but will prevent certain type of particles.
@@ -121,7 +123,8 @@ static bool ss_warning_shown_mismatch = false;	// ditto but for a different warn
 
 static int Model_signature = 0;
 
-void interp_configure_vertex_buffers(polymodel*, int, const model_read_deferred_tasks& deferredTasks);
+void interp_build_vertex_buffers(polymodel *pm, int mn, const model_read_deferred_tasks& deferredTasks);
+void interp_place_vertex_buffers(polymodel *pm, int mn);
 void interp_pack_vertex_buffers(polymodel* pm, int mn);
 void interp_create_detail_index_buffer(polymodel *pm, int detail);
 void interp_create_transparency_index_buffer(polymodel *pm, int detail_num);
@@ -130,8 +133,8 @@ void model_interp_process_shield_mesh(polymodel * pm);
 void model_set_subsys_path_nums(polymodel *pm, int n_subsystems, model_subsystem *subsystems);
 void model_set_bay_path_nums(polymodel *pm);
 
-uint align_bsp_data(ubyte* bsp_in, ubyte* bsp_out, uint bsp_size);
-uint convert_sldc_to_slc2(ubyte* sldc, ubyte* slc2, uint tree_size);
+uint align_bsp_data(const ubyte* bsp_in, ubyte* bsp_out, uint bsp_size);
+uint convert_sldc_to_slc2(const ubyte* sldc, ubyte* slc2, uint tree_size);
 
 
 // Goober5000 - see SUBSYSTEM_X in model.h
@@ -192,10 +195,28 @@ public:
 
 SCP_unordered_map<int, intrinsic_motion> Intrinsic_motions;
 
+/**
+ * A model loaded while level paging, whose collision trees and vertex buffers are built by model_finish_deferred_loads()
+ */
+struct model_deferred_load {
+	int model_num = -1;
+	model_read_deferred_tasks tasks;	// only the texture replacements, for the vertex buffers
+	SCP_string cache_key;				// empty if the model cache is disabled
+	bool trees_parsed = false;
+	bool buffers_built = false;
+};
+
+static bool Model_defer_loads = false;
+static SCP_vector<model_deferred_load> Model_deferred_loads;
+
 void model_free(polymodel* pm)
 {
 	int i;
 
+	// nothing left to build for this one
+	Model_deferred_loads.erase(std::remove_if(Model_deferred_loads.begin(), Model_deferred_loads.end(),
+		[pm](const model_deferred_load& load) { return load.model_num == pm->id; }), Model_deferred_loads.end());
+
 	if (pm->submodel) {
 		for (i = 0; i < pm->n_models; i++) {
 			pm->submodel[i].buffer.clear();
@@ -418,6 +439,10 @@ void model_init()
 		Polygon_models[i] = NULL;
 	}
 
+	if (model_cache_enabled()) {
+		model_cache_purge_old();
+	}
+
 	model_initted = 1;
 }
 
@@ -1113,21 +1138,11 @@ void create_family_tree(polymodel *obj)
 	}
 }
 
-void create_vertex_buffer(polymodel *pm, const model_read_deferred_tasks& deferredTasks)
+// everything after the submodel buffers were configured, this needs bmpman and the renderer so it stays on the main thread
+static void submit_vertex_buffer(polymodel *pm)
 {
-	if (Is_standalone) {
-		return;
-	}
-
-	TRACE_SCOPE(tracing::ModelCreateVertexBuffers);
-
 	int i;
 
-	// determine the size and configuration of each buffer segment
-	for (i = 0; i < pm->n_models; i++) {
-		interp_configure_vertex_buffers(pm, i, deferredTasks);
-	}
-
 	// figure out which vertices are transparent
 	for ( i = 0; i < pm->n_models; i++ ) {
 		if ( !pm->submodel[i].flags[Model::Submodel_flags::Is_thruster] ) {
@@ -1183,6 +1198,49 @@ void create_vertex_buffer(polymodel *pm, const model_read_deferred_tasks& deferr
 	model_interp_process_shield_mesh(pm);
 }
 
+static void parse_collision_trees(polymodel *pm)
+{
+	TRACE_SCOPE(tracing::ModelParseAllBSPTrees);
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		bsp_collision_tree* tree = &Bsp_collision_tree_list[pm->submodel[i].collision_tree_index];
+
+		Macro_ubyte_bounds = pm->submodel[i].bsp_data.get() + pm->submodel[i].bsp_data_size;
+		model_collide_parse_bsp(tree, pm->submodel[i].bsp_data.get(), pm->version);
+		Macro_ubyte_bounds = nullptr;
+	}
+}
+
+static void build_vertex_buffers(polymodel *pm, const model_read_deferred_tasks& deferredTasks)
+{
+	if (Is_standalone) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::ModelCreateVertexBuffers);
+
+	for (int i = 0; i < pm->n_models; i++) {
+		interp_build_vertex_buffers(pm, i, deferredTasks);
+	}
+}
+
+// once the submodel buffers are built (or read from the cache), this decides where they go and hands them to the renderer
+void create_vertex_buffer(polymodel *pm)
+{
+	if (Is_standalone) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::ModelCreateVertexBuffers);
+
+	// determine the size and configuration of each buffer segment
+	for (int i = 0; i < pm->n_models; i++) {
+		interp_place_vertex_buffers(pm, i);
+	}
+
+	submit_vertex_buffer(pm);
+}
+
 // Goober5000
 bool maybe_swap_mins_maxs(vec3d *mins, vec3d *maxs)
 {
@@ -2065,24 +2123,39 @@ modelread_status read_model_file_no_subsys(polymodel * pm, const char* filename,
 					sm->bsp_data_size = cfread_int(fp);
 
 					if (sm->bsp_data_size > 0) {
-						auto bsp_data = make_shared<ubyte[]>(sm->bsp_data_size);
+						extern bool Cmdline_no_bsp_align;
 
-						cfread(bsp_data.get(), 1, sm->bsp_data_size, fp);
+						std::shared_ptr<ubyte[]> bsp_data;
+						const ubyte *bsp_in = nullptr;
 
-						// byte swap first thing
-						swap_bsp_data(pm, bsp_data.get());
+#if BYTE_ORDER == LITTLE_ENDIAN
+						// there's nothing to swap here, so if the model is in memory it can be aligned straight from there
+						if (!Cmdline_no_bsp_align) {
+							bsp_in = static_cast<const ubyte*>(cfread_span(fp, sm->bsp_data_size));
+						}
+#endif
+
+						if (bsp_in == nullptr) {
+							bsp_data = make_shared<ubyte[]>(sm->bsp_data_size);
+
+							cfread(bsp_data.get(), 1, sm->bsp_data_size, fp);
+
+							// byte swap first thing
+							swap_bsp_data(pm, bsp_data.get());
+
+							bsp_in = bsp_data.get();
+						}
 
-						extern bool Cmdline_no_bsp_align;
 						if (Cmdline_no_bsp_align) {
 							sm->bsp_data = bsp_data;
 						}
 						else {
-							auto bsp_data_size_aligned = align_bsp_data(bsp_data.get(), nullptr, sm->bsp_data_size);
+							auto bsp_data_size_aligned = align_bsp_data(bsp_in, nullptr, sm->bsp_data_size);
 
 							if (bsp_data_size_aligned != static_cast<uint>(sm->bsp_data_size)) {
 								auto bsp_data_aligned = make_shared<ubyte[]>(bsp_data_size_aligned);
 
-								align_bsp_data(bsp_data.get(), bsp_data_aligned.get(), sm->bsp_data_size);
+								align_bsp_data(bsp_in, bsp_data_aligned.get(), sm->bsp_data_size);
 
 								// release unaligned data
 								bsp_data.reset();
@@ -2092,9 +2165,13 @@ modelread_status read_model_file_no_subsys(polymodel * pm, const char* filename,
 								sm->bsp_data = bsp_data_aligned;
 								sm->bsp_data_size = bsp_data_size_aligned;
 							}
-							else {
+							else if (bsp_data) {
 								sm->bsp_data = bsp_data;
 							}
+							else {
+								sm->bsp_data = make_shared<ubyte[]>(sm->bsp_data_size);
+								memcpy(sm->bsp_data.get(), bsp_in, sm->bsp_data_size);
+							}
 						}
 					}
 					else {
@@ -2123,12 +2200,18 @@ modelread_status read_model_file_no_subsys(polymodel * pm, const char* filename,
 					//mprintf(("SLDC data is being converted to SLC2.\n"));
 					pm->sldc_size = cfread_int(fp);
 
-					std::unique_ptr<ubyte[]> sldc_tree(new ubyte[pm->sldc_size]);
+					std::unique_ptr<ubyte[]> sldc_tree;
 					std::unique_ptr<ubyte[]> slc2_tree(new ubyte[pm->sldc_size * 2]);
 
-					cfread(sldc_tree.get(), 1, pm->sldc_size, fp);
+					// convert straight from the file if it's in memory
+					auto sldc_data = static_cast<const ubyte*>(cfread_span(fp, pm->sldc_size));
+					if (sldc_data == nullptr) {
+						sldc_tree.reset(new ubyte[pm->sldc_size]);
+						cfread(sldc_tree.get(), 1, pm->sldc_size, fp);
+						sldc_data = sldc_tree.get();
+					}
 					//mprintf(("SLDC Shield Collision Tree was %d bytes in size\n", pm->sldc_size));
-					pm->sldc_size = convert_sldc_to_slc2(sldc_tree.get(), slc2_tree.get(), pm->sldc_size);
+					pm->sldc_size = convert_sldc_to_slc2(sldc_data, slc2_tree.get(), pm->sldc_size);
 					//mprintf(("SLC2 Shield Collision Tree is %d bytes in size\n", pm->sldc_size));
 					pm->shield_collision_tree = make_shared<ubyte[]>(pm->sldc_size); //sldc_size is slc2 size, reused variable
 					memcpy(pm->shield_collision_tree.get(), slc2_tree.get(), pm->sldc_size);
@@ -3388,8 +3471,39 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 		}
 	}
 
-	// maybe generate vertex buffers
-	create_vertex_buffer(pm, deferredTasks);
+	for (i = 0; i < pm->n_models; ++i) {
+		pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
+	}
+
+	// the collision trees and submodel vertex buffers of a model which was built before can come from the cache
+	SCP_string cache_key;
+	bool cached = false;
+	if (model_cache_enabled()) {
+		cache_key = model_cache_key(pm, deferredTasks);
+		cached = !Cmdline_verify_model_cache && model_cache_read(pm, cache_key);
+	}
+
+	// otherwise build them, unless level paging does that for all models at once later on
+	if (Model_defer_loads) {
+		model_deferred_load load;
+		load.model_num = pm->id;
+		load.tasks.texture_replacements = deferredTasks.texture_replacements;
+		load.cache_key = std::move(cache_key);
+		load.trees_parsed = cached;
+		load.buffers_built = cached;
+		Model_deferred_loads.push_back(std::move(load));
+	} else {
+		if (!cached) {
+			parse_collision_trees(pm);
+			build_vertex_buffers(pm, deferredTasks);
+
+			if (!cache_key.empty()) {
+				model_cache_write(pm, cache_key);
+			}
+		}
+
+		create_vertex_buffer(pm);
+	}
 
 	//==============================
 	// Find all the lower detail versions of the hires model
@@ -3502,17 +3616,6 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 	}
 #endif
 
-	TRACE_SCOPE(tracing::ModelParseAllBSPTrees);
-
-	for (i = 0; i < pm->n_models; ++i) {
-		pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
-		bsp_collision_tree* tree             = model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index);
-
-		Macro_ubyte_bounds = pm->submodel[i].bsp_data.get() + pm->submodel[i].bsp_data_size;
-		model_collide_parse_bsp(tree, pm->submodel[i].bsp_data.get(), pm->version);
-		Macro_ubyte_bounds = nullptr;
-	}
-
 	// Find the core_radius... the minimum of 
 	float rx, ry, rz;
 	rx = fl_abs( pm->submodel[pm->detail[0]].max.xyz.x - pm->submodel[pm->detail[0]].min.xyz.x );
@@ -3541,11 +3644,129 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 	if (sip != nullptr)
 		sip->model_num = pm->id;
 
-	gr_model_loaded(pm->id);
+	if (!Model_defer_loads)
+		gr_model_loaded(pm->id);
 
 	return pm->id;
 }
 
+void model_defer_loads()
+{
+	Model_defer_loads = true;
+}
+
+// parses the collision trees of all deferred models which don't have them yet
+static void model_parse_deferred_collision_trees()
+{
+	struct tree_job {
+		bsp_collision_tree* tree;
+		ubyte* bsp_data;
+		int bsp_data_size;
+		int version;
+	};
+	SCP_vector<tree_job> jobs;
+
+	for (auto& load : Model_deferred_loads) {
+		if (load.trees_parsed)
+			continue;
+		load.trees_parsed = true;
+
+		auto pm = model_get(load.model_num);
+		for (int i = 0; i < pm->n_models; ++i) {
+			auto sm = &pm->submodel[i];
+			jobs.push_back({ &Bsp_collision_tree_list[sm->collision_tree_index], sm->bsp_data.get(), sm->bsp_data_size, pm->version });
+		}
+	}
+
+	if (jobs.empty())
+		return;
+
+	TRACE_SCOPE(tracing::ModelParseAllBSPTrees);
+
+	// biggest first, so that a big hull isn't what the other threads end up waiting on
+	std::stable_sort(jobs.begin(), jobs.end(), [](const tree_job& a, const tree_job& b) { return a.bsp_data_size > b.bsp_data_size; });
+
+	threading::parallel_for(0, jobs.size(), 1, [&jobs](size_t begin, size_t end) {
+		for (auto i = begin; i < end; ++i) {
+			const auto& job = jobs[i];
+
+			Macro_ubyte_bounds = job.bsp_data + job.bsp_data_size;
+			model_collide_parse_bsp(job.tree, job.bsp_data, job.version);
+			Macro_ubyte_bounds = nullptr;
+		}
+	});
+}
+
+void model_finish_deferred_loads()
+{
+	Model_defer_loads = false;
+
+	if (Model_deferred_loads.empty())
+		return;
+
+	TRACE_SCOPE(tracing::ModelFinishDeferredLoads);
+
+	auto start = timer_get_nanoseconds();
+	int n_submodels = 0;
+
+	model_parse_deferred_collision_trees();
+
+	if (!Is_standalone) {
+		struct buffer_job {
+			polymodel* pm;
+			int submodel;
+			const model_read_deferred_tasks* tasks;
+		};
+		SCP_vector<buffer_job> jobs;
+
+		for (const auto& load : Model_deferred_loads) {
+			if (load.buffers_built)
+				continue;
+
+			auto pm = model_get(load.model_num);
+			for (int i = 0; i < pm->n_models; ++i) {
+				jobs.push_back({ pm, i, &load.tasks });
+			}
+		}
+
+		threading::parallel_for(0, jobs.size(), 1, [&jobs](size_t begin, size_t end) {
+			for (auto i = begin; i < end; ++i) {
+				interp_build_vertex_buffers(jobs[i].pm, jobs[i].submodel, *jobs[i].tasks);
+			}
+		});
+
+		for (const auto& load : Model_deferred_loads) {
+			if (!load.buffers_built && !load.cache_key.empty()) {
+				model_cache_write(model_get(load.model_num), load.cache_key);
+			}
+		}
+
+		// the rest goes through bmpman and the renderer, in the order the models were loaded in
+		for (const auto& load : Model_deferred_loads) {
+			auto pm = model_get(load.model_num);
+
+			TRACE_SCOPE(tracing::ModelCreateVertexBuffers);
+
+			for (int i = 0; i < pm->n_models; ++i) {
+				interp_place_vertex_buffers(pm, i);
+			}
+
+			submit_vertex_buffer(pm);
+		}
+
+		n_submodels = (int)jobs.size();
+	}
+
+	for (const auto& load : Model_deferred_loads) {
+		gr_model_loaded(load.model_num);
+	}
+
+	mprintf(("Finished %d models (%d submodels) on %d threads in %.1f ms\n", (int)Model_deferred_loads.size(), n_submodels,
+		(int)threading::get_num_workers() + 1, (timer_get_nanoseconds() - start) / 1000000.0));
+
+	Model_deferred_loads.clear();
+}
+
 int model_create_instance(int objnum, int model_num)
 {
 	Assertion(objnum > OBJNUM_SPECIAL_MIN && objnum < MAX_OBJECTS, "objnum must be -1 (none), -2 (player cockpit) or a valid object index!");
@@ -4086,6 +4307,8 @@ void submodel_canonicalize_rotation(bsp_info *sm, submodel_instance *smi, bool c
 			vm_quaternion_rotate(&smi->canonical_orient, smi->cur_angle, &sm->rotation_axis);
 			break;
 	}
+
+	submodel_instance_transform_changed(smi);
 }
 
 // Convert float displacement to vector, but no normalization (clamping) is needed
@@ -4112,6 +4335,8 @@ void submodel_canonicalize_translation(bsp_info *sm, submodel_instance *smi)
 			vm_vec_copy_scale(&smi->canonical_offset, &sm->translation_axis, smi->cur_offset);
 			break;
 	}
+
+	submodel_instance_transform_changed(smi);
 }
 
 // Does stepped rotation of a submodel
@@ -4455,6 +4680,7 @@ bool model_rotate_gun(const object *objp, const polymodel *pm, const polymodel_i
 		// Pretend the base is pointing directly at the target
 		save_base_orient = base_smi->canonical_orient;
 		vm_quaternion_rotate(&base_smi->canonical_orient, desired_base_angle, &base_sm->rotation_axis);
+		submodel_instance_transform_changed(base_smi);
 
 		//------------
 		// Project the destination point onto the turret gun plane with the base in the desired orientation
@@ -4478,6 +4704,7 @@ bool model_rotate_gun(const object *objp, const polymodel *pm, const polymodel_i
 		//------------
 		// Restore the base
 		base_smi->canonical_orient = save_base_orient;
+		submodel_instance_transform_changed(base_smi);
 
 	} else {
 		desired_base_angle = base_smi->turret_idle_angle;
@@ -4597,6 +4824,70 @@ void model_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, const polymod
 	}
 }
 
+static const submodel_transform Submodel_transform_identity;
+
+static const submodel_transform *model_instance_cache_submodel_transform(const polymodel *pm, const polymodel_instance *pmi, int submodel_num)
+{
+	// the transforms stop at the first submodel without a parent, just like the loops which go up the tree do
+	if ( (submodel_num < 0) || (pm->submodel[submodel_num].parent < 0) )
+		return &Submodel_transform_identity;
+
+	auto sm = &pm->submodel[submodel_num];
+	auto smi = &pmi->submodel[submodel_num];
+	auto parent = model_instance_cache_submodel_transform(pm, pmi, sm->parent);
+	auto transform = &pmi->transform_cache[submodel_num];
+
+	if (transform->framecount == Framecount && transform->transform_changes == smi->transform_changes && transform->parent_version == parent->version)
+		return transform;
+
+	// one step up the tree, like model_instance_local_to_global_point() takes it, then the parent's transform
+	vec3d offset;
+	vm_vec_add(&offset, &smi->canonical_offset, &sm->offset);
+	vm_vec_unrotate(&transform->offset, &offset, &parent->orient);
+	vm_vec_add2(&transform->offset, &parent->offset);
+
+	transform->orient = smi->canonical_orient * parent->orient;
+
+	transform->framecount = Framecount;
+	transform->transform_changes = smi->transform_changes;
+	transform->parent_version = parent->version;
+	transform->version = ++pmi->transform_cache_version;
+
+	return transform;
+}
+
+const submodel_transform *model_instance_get_submodel_transform(const polymodel *pm, const polymodel_instance *pmi, int submodel_num)
+{
+	Assert(pm->id == pmi->model_num);
+
+	// other threads (like the collision workers) may look at the same instance at the same time
+	if (pmi->submodel == nullptr || submodel_num >= pm->n_models || !threading::is_main_thread())
+		return nullptr;
+
+	if (pmi->transform_cache.size() != static_cast<size_t>(pm->n_models))
+		pmi->transform_cache.assign(pm->n_models, submodel_transform());
+
+	return model_instance_cache_submodel_transform(pm, pmi, submodel_num);
+}
+
+// Used by -check_transforms to make sure that the cached transforms are up to date
+static void model_check_submodel_transform(const vec3d *cached, const vec3d *expected, const polymodel *pm, int submodel_num)
+{
+	static bool warned = false;
+
+	float error = vm_vec_dist(cached, expected);
+	if (error <= 0.0001f * (1.0f + vm_vec_mag(expected)))
+		return;
+
+	const char *submodel_name = (submodel_num >= 0) ? pm->submodel[submodel_num].name : "<none>";
+	if (!warned) {
+		warned = true;
+		Warning(LOCATION, "The cached transform of submodel %s of model %s is off by %f!  Was submodel_instance_transform_changed() not called after moving it?", submodel_name, pm->filename, error);
+	} else {
+		mprintf(("The cached transform of submodel %s of model %s is off by %f!\n", submodel_name, pm->filename, error));
+	}
+}
+
 void model_instance_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, int model_instance_num, int submodel_num, const matrix *objorient, const vec3d *objpos, bool use_last_frame)
 {
 	auto pmi = model_get_instance(model_instance_num);
@@ -4604,7 +4895,7 @@ void model_instance_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, int
 	return model_instance_local_to_global_point(outpnt, mpnt, pm, pmi, submodel_num, objorient, objpos, use_last_frame);
 }
 
-void model_instance_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient, const vec3d *objpos, bool use_last_frame)
+static void model_instance_local_to_global_point_uncached(vec3d *outpnt, const vec3d *mpnt, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient, const vec3d *objpos, bool use_last_frame)
 {
 	vec3d pnt;
 	vec3d tpnt;
@@ -4632,7 +4923,34 @@ void model_instance_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, cons
 	}
 }
 
-void model_instance_local_to_global_point_dir(vec3d *out_pnt, vec3d *out_dir, const vec3d *in_pnt, const vec3d *in_dir, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient, const vec3d *objpos)
+void model_instance_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient, const vec3d *objpos, bool use_last_frame)
+{
+	auto transform = use_last_frame ? nullptr : model_instance_get_submodel_transform(pm, pmi, submodel_num);
+	if (transform == nullptr) {
+		model_instance_local_to_global_point_uncached(outpnt, mpnt, pm, pmi, submodel_num, objorient, objpos, use_last_frame);
+		return;
+	}
+
+	vec3d pnt;
+	vm_vec_unrotate(&pnt, mpnt, &transform->orient);
+	vm_vec_add2(&pnt, &transform->offset);
+
+	if (Cmdline_check_transforms) {
+		vec3d expected;
+		model_instance_local_to_global_point_uncached(&expected, mpnt, pm, pmi, submodel_num, nullptr, nullptr, false);
+		model_check_submodel_transform(&pnt, &expected, pm, submodel_num);
+	}
+
+	//now instance for the entire object
+	if (objorient && objpos) {
+		vm_vec_unrotate(outpnt, &pnt, objorient);
+		vm_vec_add2(outpnt, objpos);
+	} else {
+		*outpnt = pnt;
+	}
+}
+
+static void model_instance_local_to_global_point_dir_uncached(vec3d *out_pnt, vec3d *out_dir, const vec3d *in_pnt, const vec3d *in_dir, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient, const vec3d *objpos)
 {
 	vec3d pnt, tpnt, dir, tdir;
 	int mn;
@@ -4666,6 +4984,38 @@ void model_instance_local_to_global_point_dir(vec3d *out_pnt, vec3d *out_dir, co
 	}
 }
 
+void model_instance_local_to_global_point_dir(vec3d *out_pnt, vec3d *out_dir, const vec3d *in_pnt, const vec3d *in_dir, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient, const vec3d *objpos)
+{
+	auto transform = model_instance_get_submodel_transform(pm, pmi, submodel_num);
+	if (transform == nullptr) {
+		model_instance_local_to_global_point_dir_uncached(out_pnt, out_dir, in_pnt, in_dir, pm, pmi, submodel_num, objorient, objpos);
+		return;
+	}
+
+	vec3d pnt, dir;
+	vm_vec_unrotate(&pnt, in_pnt, &transform->orient);
+	vm_vec_add2(&pnt, &transform->offset);
+	vm_vec_unrotate(&dir, in_dir, &transform->orient);
+
+	if (Cmdline_check_transforms) {
+		vec3d expected_pnt, expected_dir;
+		model_instance_local_to_global_point_dir_uncached(&expected_pnt, &expected_dir, in_pnt, in_dir, pm, pmi, submodel_num, nullptr, nullptr);
+		model_check_submodel_transform(&pnt, &expected_pnt, pm, submodel_num);
+		model_check_submodel_transform(&dir, &expected_dir, pm, submodel_num);
+	}
+
+	// now instance for the entire object
+	if (objorient && objpos) {
+		vm_vec_unrotate(out_pnt, &pnt, objorient);
+		vm_vec_add2(out_pnt, objpos);
+
+		vm_vec_unrotate(out_dir, &dir, objorient);
+	} else {
+		*out_pnt = pnt;
+		*out_dir = dir;
+	}
+}
+
 void model_instance_local_to_global_point_orient(vec3d *outpnt, matrix *outorient, const vec3d *submodel_pnt, const matrix *submodel_orient, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient, const vec3d *objpos)
 {
 	vec3d pnt, tpnt;
@@ -4706,7 +5056,7 @@ void model_instance_global_to_local_point(vec3d* outpnt, const vec3d* mpnt, int
 	return model_instance_global_to_local_point(outpnt, mpnt, pm, pmi, submodel_num, objorient, objpos, use_last_frame);
 }
 
-void model_instance_global_to_local_point(vec3d* outpnt, const vec3d* mpnt, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, const vec3d* objpos, bool use_last_frame) {
+static void model_instance_global_to_local_point_uncached(vec3d* outpnt, const vec3d* mpnt, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, const vec3d* objpos, bool use_last_frame) {
 	Assert(pm->id == pmi->model_num);
 
 	constexpr int preallocatedStackDepth = 5;
@@ -4753,13 +5103,40 @@ void model_instance_global_to_local_point(vec3d* outpnt, const vec3d* mpnt, cons
 		delete[] submodelStack;
 }
 
+void model_instance_global_to_local_point(vec3d* outpnt, const vec3d* mpnt, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, const vec3d* objpos, bool use_last_frame) {
+	auto transform = use_last_frame ? nullptr : model_instance_get_submodel_transform(pm, pmi, submodel_num);
+	if (transform == nullptr) {
+		model_instance_global_to_local_point_uncached(outpnt, mpnt, pm, pmi, submodel_num, objorient, objpos, use_last_frame);
+		return;
+	}
+
+	// into the model's frame of reference first
+	vec3d model_pnt = *mpnt;
+	if (objorient != nullptr && objpos != nullptr) {
+		vm_vec_sub2(&model_pnt, objpos);
+		vm_vec_rotate(&model_pnt, &model_pnt, objorient);
+	}
+
+	vec3d resultPnt;
+	vm_vec_sub(&resultPnt, &model_pnt, &transform->offset);
+	vm_vec_rotate(&resultPnt, &resultPnt, &transform->orient);
+
+	if (Cmdline_check_transforms) {
+		vec3d expected;
+		model_instance_global_to_local_point_uncached(&expected, &model_pnt, pm, pmi, submodel_num, nullptr, nullptr, false);
+		model_check_submodel_transform(&resultPnt, &expected, pm, submodel_num);
+	}
+
+	*outpnt = resultPnt;
+}
+
 void model_instance_global_to_local_dir(vec3d* out_dir, const vec3d* in_dir, int model_instance_num, int submodel_num, const matrix* objorient, bool use_submodel_parent, bool use_last_frame) {
 	auto pmi = model_get_instance(model_instance_num);
 	auto pm = model_get(pmi->model_num);
 	model_instance_global_to_local_dir(out_dir, in_dir, pm, pmi, use_submodel_parent ? pm->submodel[submodel_num].parent : submodel_num, objorient, use_last_frame);
 }
 
-void model_instance_global_to_local_dir(vec3d* out_dir, const vec3d* in_dir, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, bool use_last_frame) {
+static void model_instance_global_to_local_dir_uncached(vec3d* out_dir, const vec3d* in_dir, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, bool use_last_frame) {
 	Assert(pm->id == pmi->model_num);
 
 	constexpr int preallocatedStackDepth = 5;
@@ -4798,6 +5175,30 @@ void model_instance_global_to_local_dir(vec3d* out_dir, const vec3d* in_dir, con
 		delete[] submodelStack;
 }
 
+void model_instance_global_to_local_dir(vec3d* out_dir, const vec3d* in_dir, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, bool use_last_frame) {
+	auto transform = use_last_frame ? nullptr : model_instance_get_submodel_transform(pm, pmi, submodel_num);
+	if (transform == nullptr) {
+		model_instance_global_to_local_dir_uncached(out_dir, in_dir, pm, pmi, submodel_num, objorient, use_last_frame);
+		return;
+	}
+
+	// into the model's frame of reference first
+	vec3d model_dir = *in_dir;
+	if (objorient != nullptr)
+		vm_vec_rotate(&model_dir, &model_dir, objorient);
+
+	vec3d resultDir;
+	vm_vec_rotate(&resultDir, &model_dir, &transform->orient);
+
+	if (Cmdline_check_transforms) {
+		vec3d expected;
+		model_instance_global_to_local_dir_uncached(&expected, &model_dir, pm, pmi, submodel_num, nullptr, false);
+		model_check_submodel_transform(&resultDir, &expected, pm, submodel_num);
+	}
+
+	*out_dir = resultDir;
+}
+
 void model_instance_global_to_local_point_orient(vec3d* outpnt, matrix* outorient, const vec3d* submodel_pnt, const matrix* submodel_orient, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, const vec3d* objpos) {
 	Assert(pm->id == pmi->model_num);
 
@@ -4952,7 +5353,7 @@ void model_instance_local_to_global_dir(vec3d *out_dir, const vec3d *in_dir, int
 	model_instance_local_to_global_dir(out_dir, in_dir, pm, pmi, use_submodel_parent ? pm->submodel[submodel_num].parent : submodel_num, objorient);
 }
 
-void model_instance_local_to_global_dir(vec3d *out_dir, const vec3d *in_dir, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient)
+static void model_instance_local_to_global_dir_uncached(vec3d *out_dir, const vec3d *in_dir, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient)
 {
 	vec3d pnt;
 	vec3d tpnt;
@@ -4978,6 +5379,31 @@ void model_instance_local_to_global_dir(vec3d *out_dir, const vec3d *in_dir, con
 	}
 }
 
+void model_instance_local_to_global_dir(vec3d *out_dir, const vec3d *in_dir, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient)
+{
+	auto transform = model_instance_get_submodel_transform(pm, pmi, submodel_num);
+	if (transform == nullptr) {
+		model_instance_local_to_global_dir_uncached(out_dir, in_dir, pm, pmi, submodel_num, objorient);
+		return;
+	}
+
+	vec3d dir;
+	vm_vec_unrotate(&dir, in_dir, &transform->orient);
+
+	if (Cmdline_check_transforms) {
+		vec3d expected;
+		model_instance_local_to_global_dir_uncached(&expected, in_dir, pm, pmi, submodel_num, nullptr);
+		model_check_submodel_transform(&dir, &expected, pm, submodel_num);
+	}
+
+	// now instance for the entire object
+	if (objorient) {
+		vm_vec_unrotate(out_dir, &dir, objorient);
+	} else {
+		*out_dir = dir;
+	}
+}
+
 
 // Clears all the submodel instances stored in a model to their defaults.
 void model_clear_instance(int model_num)
@@ -5067,6 +5493,8 @@ void model_replicate_submodel_instance_sub(polymodel *pm, polymodel_instance *pm
 				r_smi->cur_offset = copy_from->cur_offset;
 				r_smi->canonical_offset = copy_from->canonical_offset;
 				r_smi->canonical_prev_offset = copy_from->canonical_prev_offset;
+
+				submodel_instance_transform_changed(r_smi);
 			} else {
 				r_smi->cur_angle = smi->cur_angle;
 				r_smi->canonical_orient = smi->canonical_orient;
@@ -5075,6 +5503,8 @@ void model_replicate_submodel_instance_sub(polymodel *pm, polymodel_instance *pm
 				r_smi->cur_offset = smi->cur_offset;
 				r_smi->canonical_offset = smi->canonical_offset;
 				r_smi->canonical_prev_offset = smi->canonical_prev_offset;
+
+				submodel_instance_transform_changed(r_smi);
 			}
 		}
 	} else {
@@ -5095,6 +5525,8 @@ void model_replicate_submodel_instance_sub(polymodel *pm, polymodel_instance *pm
 		smi->cur_offset = copy_from->cur_offset;
 		smi->canonical_offset = copy_from->canonical_offset;
 		smi->canonical_prev_offset = copy_from->canonical_prev_offset;
+
+		submodel_instance_transform_changed(smi);
 	}
 
 	// For all the detail levels of this submodel, set them also.
@@ -5408,6 +5840,11 @@ int model_create_bsp_collision_tree()
 
 bsp_collision_tree *model_get_bsp_collision_tree(int tree_index)
 {
+	// someone needs a tree of a model that was loaded while level paging before the rest is finished
+	if (!Model_deferred_loads.empty() && threading::is_main_thread()) {
+		model_parse_deferred_collision_trees();
+	}
+
 	Assert(tree_index >= 0);
 	Assert((uint) tree_index < Bsp_collision_tree_list.size());
 
@@ -5420,19 +5857,33 @@ void model_remove_bsp_collision_tree(int tree_index)
 
 	if ( Bsp_collision_tree_list[tree_index].node_list ) {
 		vm_free(Bsp_collision_tree_list[tree_index].node_list);
+		Bsp_collision_tree_list[tree_index].node_list = nullptr;
 	}
 
 	if ( Bsp_collision_tree_list[tree_index].leaf_list ) {
 		vm_free(Bsp_collision_tree_list[tree_index].leaf_list);
+		Bsp_collision_tree_list[tree_index].leaf_list = nullptr;
 	}
 	
 	if ( Bsp_collision_tree_list[tree_index].point_list ) {
 		vm_free( Bsp_collision_tree_list[tree_index].point_list );
+		Bsp_collision_tree_list[tree_index].point_list = nullptr;
 	}
 	
 	if ( Bsp_collision_tree_list[tree_index].vert_list ) {
 		vm_free( Bsp_collision_tree_list[tree_index].vert_list);
-	}
+		Bsp_collision_tree_list[tree_index].vert_list = nullptr;
+	}
+
+	// the slot gets reused by the next tree, which may not set all of these (or, like the cache, only sets them once it knows it can)
+	Bsp_collision_tree_list[tree_index].n_nodes = 0;
+	Bsp_collision_tree_list[tree_index].n_leaves = 0;
+	Bsp_collision_tree_list[tree_index].n_verts = 0;
+	Bsp_collision_tree_list[tree_index].poly_centers = SCP_vector<vec3d>();
+	Bsp_collision_tree_list[tree_index].flat_nodes = SCP_vector<bsp_collision_flat_node>();
+	Bsp_collision_tree_list[tree_index].flat_polys = SCP_vector<bsp_collision_poly>();
+	Bsp_collision_tree_list[tree_index].flat_points = SCP_vector<vec3d>();
+	Bsp_collision_tree_list[tree_index].flat_uvs = SCP_vector<uv_pair>();
 }
 
 #if BYTE_ORDER == BIG_ENDIAN
@@ -6137,7 +6588,7 @@ model_subsystem::model_subsystem() {
 	reset();
 }
 
-uint convert_sldc_to_slc2(ubyte* sldc, ubyte* slc2, uint tree_size)
+uint convert_sldc_to_slc2(const ubyte* sldc, ubyte* slc2, uint tree_size)
 {
 	//ShivanSpS SLDC must be converted to SLC2 in order to be used by shield collision system
 	//Convert SLDC to SLC2
@@ -6170,7 +6621,7 @@ uint convert_sldc_to_slc2(ubyte* sldc, ubyte* slc2, uint tree_size)
 		if (node_type_char == 0) {
 			//Front and back offsets must be adjusted
 			uint front, back, newback = 0;
-			ubyte* p;
+			const ubyte* p;
 
 			p = sldc - 29;
 			memcpy(&back, p + 33, 4);
@@ -6209,10 +6660,10 @@ uint convert_sldc_to_slc2(ubyte* sldc, ubyte* slc2, uint tree_size)
 }
 
 // if bsp_out is NULL then we just calculate new size
-uint align_bsp_data(ubyte* bsp_in, ubyte* bsp_out, uint bsp_size)
+uint align_bsp_data(const ubyte* bsp_in, ubyte* bsp_out, uint bsp_size)
 {
 	//ShivanSpS 
-	ubyte* end;
+	const ubyte* end;
 	uint copied = 0;
 	end = bsp_in + bsp_size;
 
@@ -60,7 +60,7 @@ class polymodel;
 #define ID_SLDC 0x43444c53				// CDLS (SLDC): Shield Collision Tree
 #define ID_SLC2 0x32434c53				// 2CLS (SLC2): Shield Collision Tree with ints instead of char - ShivanSpS
 
-extern const ubyte* Macro_ubyte_bounds;
+extern thread_local const ubyte* Macro_ubyte_bounds;
 
 #ifndef NDEBUG
 #define us(p)	(AssertExpr(p < Macro_ubyte_bounds), *reinterpret_cast<ushort*>(p))
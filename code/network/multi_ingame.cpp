@@ -1094,6 +1094,7 @@ void process_ingame_ships_packet( ubyte *data, header *hinfo )
 
 		// assign any common data
 		strcpy_s(Ships[ship_num].ship_name, ship_name);
+		ship_name_changed(ship_num);
 		Ships[ship_num].flags.reset();
 		Ships[ship_num].flags.set_from_vector(ship_flags);
 		Ships[ship_num].team = team;
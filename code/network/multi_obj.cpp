@@ -2084,18 +2084,21 @@ int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delt
 					if (flags[i] & OO_SUBSYS_ROTATION_1) {
 						vm_angles_2_matrix(&subsysp->submodel_instance_1->canonical_prev_orient, &prev_angs_1);
 						vm_angles_2_matrix(&subsysp->submodel_instance_1->canonical_orient, &angs_1);
+						submodel_instance_transform_changed(subsysp->submodel_instance_1);
 					}
 
 					// fix up the subsystem orientation matrixes based on received data
 					if (flags[i] & OO_SUBSYS_ROTATION_2) {
 						vm_angles_2_matrix(&subsysp->submodel_instance_2->canonical_prev_orient, &prev_angs_2);
 						vm_angles_2_matrix(&subsysp->submodel_instance_2->canonical_orient, &angs_2);
+						submodel_instance_transform_changed(subsysp->submodel_instance_2);
 					}
 
 					if (flags[i] & OO_SUBSYS_TRANSLATION_x) {
 						if (animations_valid) {
 							subsysp->submodel_instance_1->canonical_prev_offset.xyz.x = subsysp->submodel_instance_1->canonical_offset.xyz.x;
 							subsysp->submodel_instance_1->canonical_offset.xyz.x = subsys_data[data_idx];
+							submodel_instance_transform_changed(subsysp->submodel_instance_1);
 						}
 
 						data_idx++;
@@ -2105,6 +2108,7 @@ int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delt
 						if (animations_valid) {						
 							subsysp->submodel_instance_1->canonical_prev_offset.xyz.y = subsysp->submodel_instance_1->canonical_offset.xyz.y;
 							subsysp->submodel_instance_1->canonical_offset.xyz.y = subsys_data[data_idx];
+							submodel_instance_transform_changed(subsysp->submodel_instance_1);
 						}
 
 						data_idx++;
@@ -2114,6 +2118,7 @@ int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delt
 						if (animations_valid) {						
 							subsysp->submodel_instance_1->canonical_prev_offset.xyz.z = subsysp->submodel_instance_1->canonical_offset.xyz.z;
 							subsysp->submodel_instance_1->canonical_offset.xyz.z = subsys_data[data_idx];
+							submodel_instance_transform_changed(subsysp->submodel_instance_1);
 						}
 
 						data_idx++;
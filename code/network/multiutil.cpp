@@ -1580,6 +1580,7 @@ void multi_create_standalone_object()
 	// one observer, and one "Player_ship".  Observer needs to ignore the Player_ship.
     Player_ship->flags.set(Ship::Ship_Flags::Hidden_from_sensors);
 	strcpy_s(Player_ship->ship_name, XSTR("Standalone Ship",904));
+	ship_name_changed(Objects[pobj_num].instance);
 	Player_ai = &Ai_info[Ships[Objects[pobj_num].instance].ai_index];		
 
 }
@@ -0,0 +1,105 @@
+#include "object/collidebroadphase.h"
+
+void collider_broadphase::add(int id)
+{
+	Assertion(id >= 0, "Invalid collider id %d!", id);
+
+	if (static_cast<size_t>(id) >= m_index_of.size()) {
+		m_index_of.resize(id + 1, -1);
+	}
+
+	if (m_index_of[id] >= 0) {
+		return;
+	}
+
+	// the bounds get filled in by the next update
+	entry e{};
+	e.id = id;
+
+	m_index_of[id] = static_cast<int>(m_entries.size());
+	m_entries.push_back(e);
+	++m_num_added;
+}
+
+void collider_broadphase::remove(int id)
+{
+	if (id < 0 || static_cast<size_t>(id) >= m_index_of.size() || m_index_of[id] < 0) {
+		return;
+	}
+
+	// just mark the slot, it is cleaned up by the next update so the order stays intact in the meantime
+	m_entries[m_index_of[id]].id = -1;
+	m_index_of[id] = -1;
+	++m_num_removed;
+}
+
+void collider_broadphase::clear()
+{
+	m_entries.clear();
+	m_index_of.clear();
+	m_num_added = 0;
+	m_num_removed = 0;
+}
+
+size_t collider_broadphase::size() const
+{
+	return m_entries.size() - m_num_removed;
+}
+
+void collider_broadphase::update(bounds_func get_bounds)
+{
+	if (m_num_removed > 0) {
+		remove_dead_entries();
+	}
+
+	for (auto& e : m_entries) {
+		get_bounds(e.id, &e.bounds);
+	}
+
+	// A handful of new colliders at the end of the array are cheap to move into place but if a large part of the
+	// array is new (e.g. right after a mission was loaded) a full sort is much faster
+	if (m_num_added * 8 > m_entries.size()) {
+		std::sort(m_entries.begin(), m_entries.end(), [](const entry& a, const entry& b) {
+			return a.bounds.min.xyz.x < b.bounds.min.xyz.x;
+		});
+	} else {
+		insertion_sort();
+	}
+	m_num_added = 0;
+
+	rebuild_index();
+}
+
+void collider_broadphase::remove_dead_entries()
+{
+	m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [](const entry& e) { return e.id < 0; }),
+		m_entries.end());
+	m_num_removed = 0;
+}
+
+void collider_broadphase::insertion_sort()
+{
+	for (size_t i = 1; i < m_entries.size(); ++i) {
+		const float key = m_entries[i].bounds.min.xyz.x;
+
+		if (m_entries[i - 1].bounds.min.xyz.x <= key) {
+			// the common case, nothing moved past its neighbor
+			continue;
+		}
+
+		entry moving = m_entries[i];
+		size_t j = i;
+		while (j > 0 && m_entries[j - 1].bounds.min.xyz.x > key) {
+			m_entries[j] = m_entries[j - 1];
+			--j;
+		}
+		m_entries[j] = moving;
+	}
+}
+
+void collider_broadphase::rebuild_index()
+{
+	for (size_t i = 0; i < m_entries.size(); ++i) {
+		m_index_of[m_entries[i].id] = static_cast<int>(i);
+	}
+}
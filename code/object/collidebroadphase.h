@@ -0,0 +1,94 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+// Persistent sweep-and-prune broadphase used by obj_sort_and_collide().
+//
+// The colliders are kept in an array sorted by the minimum x extent of their bounding box. That array survives from
+// one frame to the next and since objects barely change their relative order between two frames, an insertion sort
+// brings it back into order in close to linear time. The bounds of every collider are computed only once per frame
+// and cached in the array so the sort and the sweep never have to go back to the objects themselves.
+class collider_broadphase
+{
+  public:
+	struct collider_bounds {
+		vec3d min;
+		vec3d max;
+	};
+
+	using bounds_func = void (*)(int id, collider_bounds* bounds_out);
+
+	// Adding an id that is already present or removing one that isn't are no-ops. Both are safe to call while
+	// find_overlaps() is running, an added collider will only be considered in the next frame.
+	void add(int id);
+	void remove(int id);
+	void clear();
+
+	size_t size() const;
+
+	// Refreshes the cached bounds of all colliders and restores the sort order
+	void update(bounds_func get_bounds);
+
+	// Calls on_pair(a, b) for every pair of colliders whose cached bounds overlap on all three axes. a is the
+	// collider which comes later in the sort order. update() must have been called before.
+	template <typename PairFunc>
+	void find_overlaps(PairFunc on_pair) const;
+
+  private:
+	struct entry {
+		collider_bounds bounds;
+		int id;
+	};
+
+	void remove_dead_entries();
+	void insertion_sort();
+	void rebuild_index();
+
+	SCP_vector<entry> m_entries;
+	SCP_vector<int> m_index_of;		// position of each id in m_entries, or -1
+
+	size_t m_num_added = 0;		// colliders added since the last update, these are unsorted
+	size_t m_num_removed = 0;	// entries which were removed but are still taking up a slot in m_entries
+};
+
+template <typename PairFunc>
+void collider_broadphase::find_overlaps(PairFunc on_pair) const
+{
+	// on_pair may add colliders which appends to m_entries so only look at what was there when we started and don't
+	// hold on to any references across the call
+	const size_t count = m_entries.size() - m_num_added;
+
+	for (size_t i = 0; i < count; ++i) {
+		if (m_entries[i].id < 0) {
+			continue;
+		}
+
+		for (size_t j = i + 1; j < count; ++j) {
+			const auto& a = m_entries[j];
+			const auto& b = m_entries[i];
+
+			// everything after this starts further along the x axis
+			if (a.bounds.min.xyz.x > b.bounds.max.xyz.x) {
+				break;
+			}
+
+			if (a.id < 0) {
+				continue;
+			}
+
+			if (a.bounds.min.xyz.y > b.bounds.max.xyz.y || b.bounds.min.xyz.y > a.bounds.max.xyz.y) {
+				continue;
+			}
+			if (a.bounds.min.xyz.z > b.bounds.max.xyz.z || b.bounds.min.xyz.z > a.bounds.max.xyz.z) {
+				continue;
+			}
+
+			on_pair(a.id, b.id);
+
+			// on_pair may have removed the outer collider
+			if (m_entries[i].id < 0) {
+				break;
+			}
+		}
+	}
+}
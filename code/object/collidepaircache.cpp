@@ -0,0 +1,189 @@
+#include "object/collidepaircache.h"
+
+#include "object/objcollide.h"
+
+namespace {
+// Keep the table at most half full, linear probing degrades quickly beyond that
+const size_t INITIAL_CAPACITY = 1024;
+const int INITIAL_SHIFT = 32 - 10;
+}
+
+collider_pair_cache::collider_pair_cache()
+{
+	clear();
+}
+
+uint collider_pair_cache::make_key(int objnum_a, int objnum_b)
+{
+	return (static_cast<uint>(objnum_a) << collision_cache_bitshift) + static_cast<uint>(objnum_b);
+}
+
+size_t collider_pair_cache::home_slot(uint key) const
+{
+	// Fibonacci hashing, the object indices in the keys are far from uniformly distributed
+	return static_cast<size_t>((key * 2654435769u) >> m_shift);
+}
+
+size_t collider_pair_cache::find_slot(uint key) const
+{
+	for (auto index = home_slot(key);; index = (index + 1) & m_mask) {
+		const auto& s = m_slots[index];
+		if (s.key == key) {
+			return index;
+		}
+		if (s.key == EMPTY_KEY) {
+			return m_slots.size();
+		}
+	}
+}
+
+collider_pair* collider_pair_cache::find(int objnum_a, int objnum_b)
+{
+	auto index = find_slot(make_key(objnum_a, objnum_b));
+	if (index == m_slots.size()) {
+		return nullptr;
+	}
+
+	return &m_slots[index].pair;
+}
+
+collider_pair* collider_pair_cache::find_or_insert(int objnum_a, int objnum_b, bool* created)
+{
+	const auto key = make_key(objnum_a, objnum_b);
+
+	auto index = home_slot(key);
+	for (;; index = (index + 1) & m_mask) {
+		auto& s = m_slots[index];
+		if (s.key == key) {
+			*created = false;
+			return &s.pair;
+		}
+		if (s.key == EMPTY_KEY) {
+			break;
+		}
+	}
+
+	if ((m_size + 1) * 2 > m_slots.size()) {
+		grow();
+
+		index = home_slot(key);
+		while (m_slots[index].key != EMPTY_KEY) {
+			index = (index + 1) & m_mask;
+		}
+	}
+
+	m_slots[index].key = key;
+	++m_size;
+
+	track_key(objnum_a, key);
+	track_key(objnum_b, key);
+
+	*created = true;
+	return &m_slots[index].pair;
+}
+
+void collider_pair_cache::remove(int objnum_a, int objnum_b)
+{
+	auto index = find_slot(make_key(objnum_a, objnum_b));
+	if (index != m_slots.size()) {
+		erase_slot(index);
+	}
+}
+
+void collider_pair_cache::remove_object(int objnum)
+{
+	if (objnum < 0 || static_cast<size_t>(objnum) >= m_object_keys.size()) {
+		return;
+	}
+
+	auto& keys = m_object_keys[objnum];
+	for (auto key : keys) {
+		auto index = find_slot(key);
+		if (index != m_slots.size()) {
+			erase_slot(index);
+		}
+	}
+	keys.clear();
+}
+
+void collider_pair_cache::clear()
+{
+	m_slots.assign(INITIAL_CAPACITY, slot{EMPTY_KEY, {}});
+	m_mask = INITIAL_CAPACITY - 1;
+	m_shift = INITIAL_SHIFT;
+	m_size = 0;
+
+	for (auto& keys : m_object_keys) {
+		keys.clear();
+	}
+}
+
+size_t collider_pair_cache::size() const
+{
+	return m_size;
+}
+
+void collider_pair_cache::erase_slot(size_t index)
+{
+	// Move every following entry of this cluster which would be unreachable with the hole left here one step back
+	auto hole = index;
+	for (auto next = (hole + 1) & m_mask; m_slots[next].key != EMPTY_KEY; next = (next + 1) & m_mask) {
+		const auto home = home_slot(m_slots[next].key);
+
+		// entries whose home lies cyclically within (hole, next] are still reachable
+		const bool reachable = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+		if (reachable) {
+			continue;
+		}
+
+		m_slots[hole] = m_slots[next];
+		hole = next;
+	}
+
+	m_slots[hole].key = EMPTY_KEY;
+	--m_size;
+}
+
+void collider_pair_cache::grow()
+{
+	SCP_vector<slot> old_slots(m_slots.size() * 2, slot{EMPTY_KEY, {}});
+	std::swap(old_slots, m_slots);
+	m_mask = m_slots.size() - 1;
+	--m_shift;
+
+	for (const auto& s : old_slots) {
+		if (s.key == EMPTY_KEY) {
+			continue;
+		}
+
+		auto index = home_slot(s.key);
+		while (m_slots[index].key != EMPTY_KEY) {
+			index = (index + 1) & m_mask;
+		}
+		m_slots[index] = s;
+	}
+}
+
+void collider_pair_cache::track_key(int objnum, uint key)
+{
+	if (static_cast<size_t>(objnum) >= m_object_keys.size()) {
+		m_object_keys.resize(objnum + 1);
+	}
+
+	auto& keys = m_object_keys[objnum];
+
+	// before the list has to grow, see if there is anything left behind by removals through other objects
+	if (keys.size() == keys.capacity() && keys.size() >= 16) {
+		compact_object_keys(keys);
+	}
+
+	keys.push_back(key);
+}
+
+void collider_pair_cache::compact_object_keys(SCP_vector<uint>& keys)
+{
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	keys.erase(std::remove_if(keys.begin(), keys.end(), [this](uint key) { return find_slot(key) == m_slots.size(); }),
+		keys.end());
+}
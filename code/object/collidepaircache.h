@@ -0,0 +1,122 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include <limits>
+
+class object;
+
+struct collider_pair
+{
+	object *a;
+	object *b;
+	int signature_a;
+	int signature_b;
+	int next_check_time;
+};
+
+// Cache of the collision pair timing data, keyed by the object indices of the two objects.
+//
+// This is a flat open-addressing hash table using linear probing. Entries are deleted by shifting the following
+// entries of the probe sequence back so no tombstones are ever left behind and lookups never slow down over the
+// course of a mission. Additionally, the keys of every pair are tracked per object so all pairs of a single object
+// can be visited or dropped without looking at the rest of the table.
+//
+// Entries move around when other entries are added or deleted so pointers returned by this class are only valid
+// until the next call to a non-const function.
+class collider_pair_cache
+{
+  public:
+	collider_pair_cache();
+
+	// Returns the pair of the two objects, or nullptr if it isn't cached
+	collider_pair* find(int objnum_a, int objnum_b);
+
+	// Returns the pair of the two objects, adding an entry if it isn't cached yet. created is set accordingly and
+	// a new entry has to be initialized by the caller.
+	collider_pair* find_or_insert(int objnum_a, int objnum_b, bool* created);
+
+	void remove(int objnum_a, int objnum_b);
+
+	// Drops all pairs the object is part of
+	void remove_object(int objnum);
+
+	void clear();
+
+	size_t size() const;
+
+	// Calls func(pair) for all pairs the object is part of. If func returns false, the pair is removed.
+	template <typename Func>
+	void for_each_pair_of(int objnum, Func func);
+
+	// Calls func(pair) for all cached pairs. The cache must not be modified from within func.
+	template <typename Func>
+	void for_each(Func func);
+
+  private:
+	static constexpr uint EMPTY_KEY = std::numeric_limits<uint>::max();
+
+	struct slot {
+		uint key;
+		collider_pair pair;
+	};
+
+	static uint make_key(int objnum_a, int objnum_b);
+
+	size_t home_slot(uint key) const;
+	size_t find_slot(uint key) const;
+	void erase_slot(size_t index);
+	void grow();
+
+	void track_key(int objnum, uint key);
+	void compact_object_keys(SCP_vector<uint>& keys);
+
+	SCP_vector<slot> m_slots;
+	size_t m_mask;
+	int m_shift;
+	size_t m_size = 0;
+
+	// keys of all pairs each object took part in. Keys of pairs which were removed through the other object are only
+	// cleaned up lazily so these may contain keys which are not in the table anymore, or duplicates.
+	SCP_vector<SCP_vector<uint>> m_object_keys;
+};
+
+template <typename Func>
+void collider_pair_cache::for_each_pair_of(int objnum, Func func)
+{
+	if (objnum < 0 || static_cast<size_t>(objnum) >= m_object_keys.size()) {
+		return;
+	}
+
+	auto& keys = m_object_keys[objnum];
+	for (size_t i = 0; i < keys.size();) {
+		auto index = find_slot(keys[i]);
+
+		if (index == m_slots.size()) {
+			// this pair was removed through the other object, forget about it
+			keys[i] = keys.back();
+			keys.pop_back();
+			continue;
+		}
+
+		if (!func(m_slots[index].pair)) {
+			erase_slot(index);
+
+			keys[i] = keys.back();
+			keys.pop_back();
+			continue;
+		}
+
+		++i;
+	}
+}
+
+template <typename Func>
+void collider_pair_cache::for_each(Func func)
+{
+	for (auto& s : m_slots) {
+		if (s.key != EMPTY_KEY) {
+			func(s.pair);
+		}
+	}
+}
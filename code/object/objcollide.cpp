@@ -11,6 +11,8 @@
 #include "cmdline/cmdline.h"
 #include "globalincs/linklist.h"
 #include "io/timer.h"
+#include "object/collidebroadphase.h"
+#include "object/collidepaircache.h"
 #include "object/objcollide.h"
 #include "object/object.h"
 #include "object/objectdock.h"
@@ -31,27 +33,13 @@ int Num_pairs_checked = 0;
 
 SCP_vector<int> Collision_sort_list;
 
-static_assert(1 << collision_cache_bitshift > MAX_OBJECTS, "Collision pair caching currently relies on the highest possible objnum being less than 2^collision_cache_bitshift.");
+// persistent sweep-and-prune state for everything in Collision_sort_list
+static collider_broadphase Collision_broadphase;
 
-class collider_pair
-{
-public:
-	object *a;
-	object *b;
-	int signature_a;
-	int signature_b;
-	int next_check_time;
-	bool initialized;
-
-	// we need to define a constructor because the hash map can
-	// implicitly insert an object when we use the [] operator
-	collider_pair()
-		: a(nullptr), b(nullptr), signature_a(-1), signature_b(-1), next_check_time(-1), initialized(false)
-	{}
-};
+static_assert(1 << collision_cache_bitshift > MAX_OBJECTS, "Collision pair caching currently relies on the highest possible objnum being less than 2^collision_cache_bitshift.");
 
 static SCP_set<object*> Collision_cache_stale_objects;
-static SCP_unordered_map<uint, collider_pair> Collision_cached_pairs;
+static collider_pair_cache Collision_cached_pairs;
 
 class checkobject;
 extern checkobject CheckObjects[MAX_OBJECTS];
@@ -511,29 +499,16 @@ int collide_remove_weapons( )
 	}
 
 	// first pass is to see if any of the weapons don't have collision pairs.
-	for (auto& pair : Collision_cached_pairs) {
-        collider_pair* pair_obj = &pair.second;
-
-		if (!pair_obj->initialized) {
-			continue;
-		}
-
-		if (pair_obj->a->type == OBJ_WEAPON && pair_obj->signature_a == pair_obj->a->signature) {
-			crw_check_weapon(pair_obj->a->instance, pair_obj->next_check_time);
-
-			if (crw_status[pair_obj->a->instance] == CRW_CAN_DELETE) {
-				pair_obj->initialized = false;
-			}
+	// the pairs of weapons which can be deleted don't need to be touched here, deleting the weapon removes them
+	Collision_cached_pairs.for_each([](collider_pair& pair) {
+		if (pair.a->type == OBJ_WEAPON && pair.signature_a == pair.a->signature) {
+			crw_check_weapon(pair.a->instance, pair.next_check_time);
 		}
 
-		if (pair_obj->b->type == OBJ_WEAPON && pair_obj->signature_b == pair_obj->b->signature) {
-			crw_check_weapon(pair_obj->b->instance, pair_obj->next_check_time);
-
-			if (crw_status[pair_obj->b->instance] == CRW_CAN_DELETE) {
-				pair_obj->initialized = false;
-			}
+		if (pair.b->type == OBJ_WEAPON && pair.signature_b == pair.b->signature) {
+			crw_check_weapon(pair.b->instance, pair.next_check_time);
 		}
-	}
+	});
 
 	// for each weapon which could be removed, delete the object
 	int num_deleted = 0;
@@ -586,6 +561,7 @@ void obj_add_collider(int obj_index)
 	}
 
 	Collision_sort_list.push_back(obj_index);
+	Collision_broadphase.add(obj_index);
 
 	objp->flags.remove(Object::Object_Flags::Not_in_coll);
 }
@@ -603,6 +579,8 @@ void obj_remove_collider(int obj_index)
 			break;
 		}
 	}
+	Collision_broadphase.remove(obj_index);
+	Collision_cached_pairs.remove_object(obj_index);
 
 	Objects[obj_index].flags.set(Object::Object_Flags::Not_in_coll);
 }
@@ -610,6 +588,7 @@ void obj_remove_collider(int obj_index)
 void obj_reset_colliders()
 {
 	Collision_sort_list.clear();
+	Collision_broadphase.clear();
 	Collision_cached_pairs.clear();
 }
 
@@ -617,16 +596,15 @@ void obj_collide_retime_stale_pairs()
 {
 	TRACE_SCOPE(tracing::RetimeCollisionCache);
 
-	auto it = Collision_cached_pairs.begin();
-	while (it != Collision_cached_pairs.end()) {
-		auto &pair = it->second;
-		if (pair.signature_a != pair.a->signature || pair.signature_b != pair.b->signature) {
-			it = Collision_cached_pairs.erase(it);
-		} else {
-			if (pair.a->flags[Object::Object_Flags::Collision_cache_stale] || pair.b->flags[Object::Object_Flags::Collision_cache_stale])
-				pair.next_check_time = timestamp(0);
-			it++;
-		}
+	// only the pairs of the stale objects need to be looked at
+	for (auto objp : Collision_cache_stale_objects) {
+		Collision_cached_pairs.for_each_pair_of(OBJ_INDEX(objp), [](collider_pair& pair) {
+			if (pair.signature_a != pair.a->signature || pair.signature_b != pair.b->signature)
+				return false;
+
+			pair.next_check_time = timestamp(0);
+			return true;
+		});
 	}
 
 	for (auto objp : Collision_cache_stale_objects)
@@ -644,86 +622,30 @@ void obj_collide_obj_cache_stale(object* objp)
 namespace
 {
 
-float obj_get_collider_endpoint(int obj_num, int axis, bool min)
-{
-    if ( Objects[obj_num].type == OBJ_BEAM ) {
-        beam *b = &Beams[Objects[obj_num].instance];
-
-        // use the last start and last shot as endpoints
-        float min_end, max_end;
-        if ( b->last_start.a1d[axis] > b->last_shot.a1d[axis] ) {
-            min_end = b->last_shot.a1d[axis];
-            max_end = b->last_start.a1d[axis];
-        } else {
-            min_end = b->last_start.a1d[axis];
-            max_end = b->last_shot.a1d[axis];
-        }
-
-        if ( min ) {
-            return min_end;
-        } else {
-            return max_end;
-        }
-    } else if ( Objects[obj_num].type == OBJ_WEAPON ) {
-        float min_end, max_end;
-
-        if ( Objects[obj_num].pos.a1d[axis] > Objects[obj_num].last_pos.a1d[axis] ) {
-            min_end = Objects[obj_num].last_pos.a1d[axis];
-            max_end = Objects[obj_num].pos.a1d[axis];
-        } else {
-            min_end = Objects[obj_num].pos.a1d[axis];
-            max_end = Objects[obj_num].last_pos.a1d[axis];
-        }
-
-        if ( min ) {
-            return min_end - Objects[obj_num].radius;
-        } else {
-            return max_end + Objects[obj_num].radius;
-        }
-    } else {
-        vec3d *pos = &Objects[obj_num].pos;
-
-        if ( min ) {
-            return pos->a1d[axis] - Objects[obj_num].radius;
-        } else {
-            return pos->a1d[axis] + Objects[obj_num].radius;
-        }
-    }
-}
-
-void obj_quicksort_colliders(SCP_vector<int> *list, int left, int right, int axis)
+void obj_get_collider_bounds(int obj_num, collider_broadphase::collider_bounds* bounds)
 {
-    Assert( axis >= 0 );
-    Assert( axis <= 2 );
+	const object* objp = &Objects[obj_num];
 
-    if ( right > left ) {
-        int pivot_index = left + (right - left) / 2;
+	if ( objp->type == OBJ_BEAM ) {
+		const beam *b = &Beams[objp->instance];
 
-        float pivot_value = obj_get_collider_endpoint((*list)[pivot_index], axis, true);
-
-        // swap!
-        int temp = (*list)[pivot_index];
-        (*list)[pivot_index] = (*list)[right];
-        (*list)[right] = temp;
-
-        int store_index = left;
-
-        for (int i = left; i < right; ++i ) {
-            if ( obj_get_collider_endpoint((*list)[i], axis, true) <= pivot_value ) {
-                temp = (*list)[i];
-                (*list)[i] = (*list)[store_index];
-                (*list)[store_index] = temp;
-                store_index++;
-            }
-        }
-
-        temp = (*list)[right];
-        (*list)[right] = (*list)[store_index];
-        (*list)[store_index] = temp;
-
-        obj_quicksort_colliders(list, left, store_index - 1, axis);
-        obj_quicksort_colliders(list, store_index + 1, right, axis);
-    }
+		// use the last start and last shot as endpoints
+		for (int axis = 0; axis < 3; ++axis) {
+			bounds->min.a1d[axis] = MIN(b->last_start.a1d[axis], b->last_shot.a1d[axis]);
+			bounds->max.a1d[axis] = MAX(b->last_start.a1d[axis], b->last_shot.a1d[axis]);
+		}
+	} else if ( objp->type == OBJ_WEAPON ) {
+		// cover everything the weapon went through this frame
+		for (int axis = 0; axis < 3; ++axis) {
+			bounds->min.a1d[axis] = MIN(objp->pos.a1d[axis], objp->last_pos.a1d[axis]) - objp->radius;
+			bounds->max.a1d[axis] = MAX(objp->pos.a1d[axis], objp->last_pos.a1d[axis]) + objp->radius;
+		}
+	} else {
+		for (int axis = 0; axis < 3; ++axis) {
+			bounds->min.a1d[axis] = objp->pos.a1d[axis] - objp->radius;
+			bounds->max.a1d[axis] = objp->pos.a1d[axis] + objp->radius;
+		}
+	}
 }
 
 struct collision_thread_data {
@@ -806,12 +728,14 @@ void post_process_threaded_collisions() {
 					thread.queue_results.swap(thread.queue_send);
 				}
 				for (auto& collision : *thread.queue_send) {
-					uint key = (OBJ_INDEX(collision.objs.a) << collision_cache_bitshift) + OBJ_INDEX(collision.objs.b);
-					collider_pair *collision_info = &Collision_cached_pairs[key];
-
 					if (collision.collision_data.has_value())
 						collision.process_collision(&collision.objs, collision.collision_data);
 
+					// look the pair up only now since processing the collision may have changed the cache
+					collider_pair *collision_info = Collision_cached_pairs.find(OBJ_INDEX(collision.objs.a), OBJ_INDEX(collision.objs.b));
+					if (collision_info == nullptr)
+						continue;
+
 					if (collision.never_recheck) {
 						collision_info->next_check_time = -1;
 					} else {
@@ -1031,11 +955,11 @@ void obj_collide_pair(object *A, object *B)
     }
 
     bool valid = false;
-    uint key = (OBJ_INDEX(A) << collision_cache_bitshift) + OBJ_INDEX(B);
+    bool created;
 
-    collider_pair* collision_info = &Collision_cached_pairs[key];
+    collider_pair* collision_info = Collision_cached_pairs.find_or_insert(OBJ_INDEX(A), OBJ_INDEX(B), &created);
 
-    if ( collision_info->initialized ) {
+    if ( !created ) {
         // make sure we're referring to the correct objects in case the original pair was deleted
         if ( collision_info->signature_a == collision_info->a->signature &&
              collision_info->signature_b == collision_info->b->signature ) {
@@ -1052,7 +976,6 @@ void obj_collide_pair(object *A, object *B)
         collision_info->b = B;
         collision_info->signature_a = A->signature;
         collision_info->signature_b = B->signature;
-        collision_info->initialized = true;
         collision_info->next_check_time = timestamp(0);
     }
 
@@ -1133,7 +1056,14 @@ void obj_collide_pair(object *A, object *B)
 		queue_mp_collision(ctype, new_pair);
 	}
 	else {
-		if (check_collision(&new_pair)) {
+		int never_check_again = check_collision(&new_pair);
+
+		// the collision check may have created or deleted objects, so the pair has to be looked up again
+		collision_info = Collision_cached_pairs.find(OBJ_INDEX(A), OBJ_INDEX(B));
+		if (collision_info == nullptr)
+			return;
+
+		if (never_check_again) {
 			// don't have to check ever again
 			collision_info->next_check_time = -1;
 		} else {
@@ -1142,52 +1072,6 @@ void obj_collide_pair(object *A, object *B)
 	}
 }
 
-void obj_find_overlap_colliders(SCP_vector<int> &overlap_list_out, SCP_vector<int> &list, int axis, bool collide)
-{
-    TRACE_SCOPE(tracing::FindOverlapColliders);
-
-    bool first_not_added = true;
-    SCP_vector<int> overlappers;
-
-    for (int in_index : list){
-        bool overlapped = false;
-
-        const float min = obj_get_collider_endpoint(in_index, axis, true);
-
-        for (size_t j = 0; j < overlappers.size(); ) {
-            const float overlap_max = obj_get_collider_endpoint(overlappers[j], axis, false);
-            if ( min <= overlap_max ) {
-                overlapped = true;
-
-                if ( overlappers.size() == 1 && first_not_added ) {
-                    first_not_added = false;
-                    overlap_list_out.push_back(overlappers[j]);
-                }
-
-                if ( collide ) {
-                    obj_collide_pair(&Objects[in_index], &Objects[overlappers[j]]);
-                }
-            } else {
-                overlappers[j] = overlappers.back();
-                overlappers.pop_back();
-                continue;
-            }
-
-            ++j;
-        }
-
-        if ( overlappers.empty() ) {
-            first_not_added = true;
-        }
-
-        if ( overlapped ) {
-            overlap_list_out.push_back(in_index);
-        }
-
-        overlappers.push_back(in_index);
-    }
-}
-
 } //anon namespace
 
 void collide_mp_worker_thread(size_t threadIdx) {
@@ -1239,9 +1123,8 @@ void collide_init() {
 		collision_thread_data_buffer = std::make_unique<collision_thread_data[]>(threading::get_num_workers());
 }
 
-// used only in obj_sort_and_collide()
-static SCP_vector<int> sort_list_y;
-static SCP_vector<int> sort_list_z;
+// used only in obj_sort_and_collide() for lists other than Collision_sort_list
+static collider_broadphase Collision_list_broadphase;
 
 void obj_sort_and_collide(SCP_vector<int>* Collision_list)
 {
@@ -1258,32 +1141,28 @@ void obj_sort_and_collide(SCP_vector<int>* Collision_list)
 		obj_collide_retime_stale_pairs();
 	}
 
-	// the main use case is to go through the main Collision detection list, so use that if
-	// nothing is defined.
-	if (Collision_list == nullptr) {
-		Collision_list = &Collision_sort_list;
-	}
-
-	sort_list_y.clear();
-	{
-		TRACE_SCOPE(tracing::SortColliders);
-		obj_quicksort_colliders(Collision_list, 0, (int)(Collision_list->size() - 1), 0);
+	// the main use case is to go through the main Collision detection list, which is tracked persistently
+	// across frames.  Any other list gets sorted from scratch.
+	collider_broadphase* broadphase = &Collision_broadphase;
+	if (Collision_list != nullptr) {
+		broadphase = &Collision_list_broadphase;
+		broadphase->clear();
+		for (int objnum : *Collision_list) {
+			broadphase->add(objnum);
+		}
 	}
-	obj_find_overlap_colliders(sort_list_y, *Collision_list, 0, false);
 
-	sort_list_z.clear();
 	{
 		TRACE_SCOPE(tracing::SortColliders);
-		obj_quicksort_colliders(&sort_list_y, 0, (int)(sort_list_y.size() - 1), 1);
+		broadphase->update(obj_get_collider_bounds);
 	}
-	obj_find_overlap_colliders(sort_list_z, sort_list_y, 1, false);
 
-	sort_list_y.clear();
 	{
-		TRACE_SCOPE(tracing::SortColliders);
-		obj_quicksort_colliders(&sort_list_z, 0, (int)(sort_list_z.size() - 1), 2);
+		TRACE_SCOPE(tracing::FindOverlapColliders);
+		broadphase->find_overlaps([](int a, int b) {
+			obj_collide_pair(&Objects[a], &Objects[b]);
+		});
 	}
-	obj_find_overlap_colliders(sort_list_y, sort_list_z, 2, true);
 
 	if (threading::is_threading())
 		post_process_threaded_collisions();
@@ -11,6 +11,7 @@
 
 
 #include "asteroid/asteroid.h"
+#include "cmdline/cmdline.h"
 #include "cmeasure/cmeasure.h"
 #include "debris/debris.h"
 #include "debugconsole/console.h"
@@ -47,6 +48,7 @@
 #include "ship/ship.h"
 #include "starfield/starfield.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 #include "weapon/beam.h"
 #include "weapon/shockwave.h"
 #include "weapon/swarm.h"
@@ -833,6 +835,11 @@ void obj_merge_created_list(void)
 	// creates object pairs for it, and then adds it to the used list.
 	//	OLD WAY: list_merge( &obj_used_list, &obj_create_list );
 	object *objp = GET_FIRST(&obj_create_list);
+
+	// homing weapons wouldn't find the new objects until the next rebuild
+	if (objp != END_OF_LIST(&obj_create_list))
+		weapon_homing_grid_invalidate();
+
 	while( objp !=END_OF_LIST(&obj_create_list) )	{
 		list_remove( obj_create_list, objp );
 
@@ -981,10 +988,10 @@ void obj_player_fire_stuff( object *objp, control_info ci )
 	
 }
 
-void obj_move_call_physics(object *objp, float frametime)
+// The actual work of obj_move_call_physics().  This is kept separate since it may also run on a worker thread, where
+// it must not be traced.
+static void obj_move_do_physics(object *objp, float frametime)
 {
-	TRACE_SCOPE(tracing::Physics);
-
 	//	Do physics for objects with OF_PHYSICS flag set and with some engine strength remaining.
 	if ( objp->flags[Object::Object_Flags::Physics] ) {
 		// only set phys info if ship is not dead
@@ -1088,6 +1095,13 @@ void obj_move_call_physics(object *objp, float frametime)
 	}
 }
 
+void obj_move_call_physics(object *objp, float frametime)
+{
+	TRACE_SCOPE(tracing::Physics);
+
+	obj_move_do_physics(objp, frametime);
+}
+
 
 #ifdef OBJECT_CHECK 
 
@@ -1570,168 +1584,355 @@ int Collisions_enabled = 1;
 
 DCF_BOOL( collisions, Collisions_enabled )
 
+// If set, the physics which -threaded_physics runs on the worker threads are run a second time on the main thread every
+// frame to catch data races between the workers
+bool Physics_race_check = false;
+
+DCF_BOOL( physics_race_check, Physics_race_check )
+
 MONITOR( NumObjects )
 
+// What obj_move_all() needs to remember about an object between moving it and the post-move
+struct obj_move_info {
+	object *objp;
+	bool interpolation_object;
+	bool dont_change_position;
+	bool dont_change_orientation;
+};
+
+// the part of an object which is written by obj_move_do_physics()
+struct obj_physics_state {
+	vec3d pos;
+	matrix orient;
+	physics_info phys_info;
+};
+
+static SCP_vector<obj_move_info> Obj_move_infos;
+static SCP_vector<size_t> Obj_move_threaded;		// indices into Obj_move_infos of the objects whose physics run on the worker threads
+static SCP_vector<obj_physics_state> Obj_move_saved_states;
+
 /**
- * Move all objects for the current frame
+ * Everything that happens to an object before its physics: countermeasure gathering, the pre-move and saving the last position.
+ * Returns false if the object isn't moved this frame.
  */
-void obj_move_all(float frametime)
+static bool obj_move_all_begin(object *objp, float frametime, bool global_cmeasure_timer, SCP_vector<object*> &cmeasure_list, obj_move_info *info)
 {
-	TRACE_SCOPE(tracing::MoveObjects);
+	// skip objects which should be dead
+	if (objp->flags[Object::Object_Flags::Should_be_dead]) {
+		return false;
+	}
 
-	object *objp;	
-	SCP_vector<object*> cmeasure_list;
-	const bool global_cmeasure_timer = (Cmeasures_homing_check > 0);
+	// if this is an observer object, skip it
+	if (objp->type == OBJ_OBSERVER) {
+		return false;
+	}
 
-	Assertion(Cmeasures_homing_check >= 0, "Cmeasures_homing_check is %d in obj_move_all(); it should never be negative. Get a coder!\n", Cmeasures_homing_check);
+	// Compile a list of active countermeasures during an existing traversal of obj_used_list
+	if (objp->type == OBJ_WEAPON) {
+		weapon *wp = &Weapons[objp->instance];
+		weapon_info *wip = &Weapon_info[wp->weapon_info_index];
 
-	if (global_cmeasure_timer)
-		Cmeasures_homing_check--;
+		if (wip->wi_flags[Weapon::Info_Flags::Cmeasure]) {
+			if ((wip->cmeasure_timer_interval > 0 && timestamp_elapsed(wp->cmeasure_timer))	// If it's timer-based and ready to pulse...
+				|| (wip->cmeasure_timer_interval <= 0 && global_cmeasure_timer)) {	// ...or it's not and the global counter is active...
+				// ...then it's actively pulsing and we need to add objp to cmeasure_list.
+				cmeasure_list.push_back(objp);
+				if (wip->cmeasure_timer_interval > 0) {
+					// Reset the timer
+					wp->cmeasure_timer = timestamp(wip->cmeasure_timer_interval);
+				}
+			}
+		}
+	}
 
-	// Goober5000 - HACK HACK HACK
-	// this function also resets the OF_DOCKED_ALREADY_HANDLED flag, to save trips
-	// through the used object list
-	obj_delete_all_that_should_be_dead();
+	vec3d cur_pos = objp->pos;			// Save the current position
 
-	obj_merge_created_list();
+#ifdef OBJECT_CHECK 
+		obj_check_object( objp );
+#endif
 
-	// Clear the table that tells which groups of weapons have cast light so far.
-	if(!(Game_mode & GM_MULTIPLAYER) || (MULTIPLAYER_MASTER)) {
-		obj_clear_weapon_group_id_list();
+	// pre-move
+	obj_move_all_pre(objp, frametime);
+
+	info->objp = objp;
+	info->interpolation_object = multi_oo_is_interp_object(objp);
+
+	// store last pos and orient, but only for non-interpolation objects
+	// interpolation objects will need to to work backwards from the last good position
+	// to prevent collision issues
+	if (!info->interpolation_object){
+		objp->last_pos = cur_pos;
+		objp->last_orient = objp->orient;
 	}
 
-	MONITOR_INC( NumObjects, Num_objects );	
+	// Goober5000 - accommodate objects that aren't supposed to move in some way (at least until they're destroyed)
+	info->dont_change_position =
+		objp->flags.any_of(Object::Object_Flags::Dont_change_position, Object::Object_Flags::Immobile) &&
+		objp->hull_strength > 0.0f;
+	info->dont_change_orientation =
+		objp->flags.any_of(Object::Object_Flags::Dont_change_orientation, Object::Object_Flags::Immobile) &&
+		objp->hull_strength > 0.0f;
 
-	for (objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
-		// skip objects which should be dead
-		if (objp->flags[Object::Object_Flags::Should_be_dead]) {
-			continue;
-		}
+	return true;
+}
 
-		// if this is an observer object, skip it
-		if (objp->type == OBJ_OBSERVER) {
-			continue;
-		}
+static void obj_move_all_physics(const obj_move_info &info, float frametime)
+{
+	object *objp = info.objp;
 
-		// Compile a list of active countermeasures during an existing traversal of obj_used_list
-		if (objp->type == OBJ_WEAPON) {
-			weapon *wp = &Weapons[objp->instance];
-			weapon_info *wip = &Weapon_info[wp->weapon_info_index];
-
-			if (wip->wi_flags[Weapon::Info_Flags::Cmeasure]) {
-				if ((wip->cmeasure_timer_interval > 0 && timestamp_elapsed(wp->cmeasure_timer))	// If it's timer-based and ready to pulse...
-					|| (wip->cmeasure_timer_interval <= 0 && global_cmeasure_timer)) {	// ...or it's not and the global counter is active...
-					// ...then it's actively pulsing and we need to add objp to cmeasure_list.
-					cmeasure_list.push_back(objp);
-					if (wip->cmeasure_timer_interval > 0) {
-						// Reset the timer
-						wp->cmeasure_timer = timestamp(wip->cmeasure_timer_interval);
-					}
-				}
-			}
-		}
+	// skip the physics if we're totally immobile
+	if (info.dont_change_position && info.dont_change_orientation) {
+		return;
+	}
 
-		vec3d cur_pos = objp->pos;			// Save the current position
+	// if this is an object which should be interpolated in multiplayer, do so
+	if (info.interpolation_object) {
+		extern void interpolate_main_helper(int objnum, vec3d* pos, matrix* ori, physics_info* pip, vec3d* last_pos, matrix* last_orient, vec3d* gravity, bool player_ship);
 
-#ifdef OBJECT_CHECK 
-			obj_check_object( objp );
-#endif
+		interpolate_main_helper(OBJ_INDEX(objp), &objp->pos, &objp->orient, &objp->phys_info, &objp->last_pos, &objp->last_orient, &The_mission.gravity, objp->flags[Object::Object_Flags::Player_ship]);
+	} else {
+		// physics
+		obj_move_call_physics(objp, frametime);
+	}
+}
+
+/**
+ * Everything that happens to an object after its physics: enforcing immobility, submodel movement and the post-move.
+ */
+static void obj_move_all_end(const obj_move_info &info, float frametime)
+{
+	object *objp = info.objp;
+
+	// If the object isn't supposed to move, roll back any movement that occurred.  Most of the movement should already have been skipped, but this ensures complete immobility.
+	if (info.dont_change_position) {
+		objp->pos = objp->last_pos;
+
+		// make sure velocity is always 0
+		vm_vec_zero(&objp->phys_info.vel);
+		vm_vec_zero(&objp->phys_info.desired_vel);
+		objp->phys_info.speed = 0.0f;
+		objp->phys_info.fspeed = 0.0f;
+	}
+	if (info.dont_change_orientation) {
+		objp->orient = objp->last_orient;
+
+		// make sure velocity is always 0
+		vm_vec_zero(&objp->phys_info.rotvel);
+		vm_vec_zero(&objp->phys_info.desired_rotvel);
+	}
+
+	// Submodel movement now happens here, right after physics movement.  It's not excluded by the "immobile", "don't-change-position", or "don't-change-orientation" flags.
+	
+	// this flag only affects ship subsystems, not any other type of submodel movement
+	if (objp->type == OBJ_SHIP && !Ships[objp->instance].flags[Ship::Ship_Flags::Subsystem_movement_locked])
+		ship_move_subsystems(objp);
+
+	// do animation on this object
+	int model_instance_num = object_get_model_instance_num(objp);
+	if (model_instance_num >= 0) {
+		polymodel_instance* pmi = model_get_instance(model_instance_num);
+		animation::ModelAnimation::stepAnimations(frametime, pmi);
+	}
+
+	// finally, do intrinsic motion on this object
+	// (this happens last because look_at is a type of intrinsic rotation,
+	// and look_at needs to happen last or the angle may be off by a frame)
+	model_do_intrinsic_motions(objp);
+
+	// Future TODO: Props will need a version of this when submodel animation support is added.
+	// For ships, we now have to make sure that all the submodel detail levels remain consistent.
+	if (objp->type == OBJ_SHIP)
+		ship_model_replicate_submodels(objp);
+
+	// move post
+	obj_move_all_post(objp, frametime);
+
+	// Equipment script processing
+	if (objp->type == OBJ_SHIP && scripting::hooks::OnWeaponEquipped->isActive()) {
+		ship* shipp = &Ships[objp->instance];
+		object* target;
+
+		if (Ai_info[shipp->ai_index].target_objnum != -1)
+			target = &Objects[Ai_info[shipp->ai_index].target_objnum];
+		else
+			target = NULL;
+		if (objp == Player_obj && Player_ai->target_objnum != -1)
+			target = &Objects[Player_ai->target_objnum];
+
+		scripting::hooks::OnWeaponEquipped->run(scripting::hooks::WeaponEquippedConditions{ shipp, target },
+			scripting::hook_param_list(
+				scripting::hook_param("User", 'o', objp),
+				scripting::hook_param("Target", 'o', target)
+			));
+	}
+}
 
-		// pre-move
-		obj_move_all_pre(objp, frametime);
+/**
+ * Whether obj_move_do_physics() may run for this object on a worker thread.  Interpolation depends on the multiplayer
+ * packet state, the player may fire weapons from within the physics, and the shockwave shake draws from the global
+ * random number generator, so all of these stay on the main thread.
+ */
+static bool obj_move_physics_threadable(const obj_move_info &info)
+{
+	return !info.interpolation_object
+		&& info.objp != Player_obj
+		&& !(info.objp->phys_info.flags & PF_IN_SHOCKWAVE);
+}
 
-		bool interpolation_object = multi_oo_is_interp_object(objp);
+static void obj_save_physics_state(const object *objp, obj_physics_state *state)
+{
+	// memcpy so that the padding is copied as well and the states can be compared bitwise
+	memset(state, 0, sizeof(*state));
+	memcpy(&state->pos, &objp->pos, sizeof(state->pos));
+	memcpy(&state->orient, &objp->orient, sizeof(state->orient));
+	memcpy(&state->phys_info, &objp->phys_info, sizeof(state->phys_info));
+}
 
-		// store last pos and orient, but only for non-interpolation objects
-		// interpolation objects will need to to work backwards from the last good position
-		// to prevent collision issues
-		if (!interpolation_object){
-			objp->last_pos = cur_pos;
-			objp->last_orient = objp->orient;
+static void obj_restore_physics_state(object *objp, const obj_physics_state *state)
+{
+	memcpy(&objp->pos, &state->pos, sizeof(state->pos));
+	memcpy(&objp->orient, &state->orient, sizeof(state->orient));
+	memcpy(&objp->phys_info, &state->phys_info, sizeof(state->phys_info));
+}
+
+static void obj_move_threaded_physics(float frametime)
+{
+	threading::parallel_for(0, Obj_move_threaded.size(), 32, [frametime](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			obj_move_do_physics(Obj_move_infos[Obj_move_threaded[i]].objp, frametime);
 		}
+	});
+}
 
-		// Goober5000 - accommodate objects that aren't supposed to move in some way (at least until they're destroyed)
-		bool dont_change_position =
-			objp->flags.any_of(Object::Object_Flags::Dont_change_position, Object::Object_Flags::Immobile) &&
-			objp->hull_strength > 0.0f;
-		bool dont_change_orientation =
-			objp->flags.any_of(Object::Object_Flags::Dont_change_orientation, Object::Object_Flags::Immobile) &&
-			objp->hull_strength > 0.0f;
-
-		// skip the physics if we're totally immobile
-		if (!dont_change_position || !dont_change_orientation) {
-			// if this is an object which should be interpolated in multiplayer, do so
-			if (interpolation_object) {
-				extern void interpolate_main_helper(int objnum, vec3d* pos, matrix* ori, physics_info* pip, vec3d* last_pos, matrix* last_orient, vec3d* gravity, bool player_ship);
-
-				interpolate_main_helper(OBJ_INDEX(objp), &objp->pos, &objp->orient, &objp->phys_info, &objp->last_pos, &objp->last_orient, &The_mission.gravity, objp->flags[Object::Object_Flags::Player_ship]);
-			} else {
-				// physics
-				obj_move_call_physics(objp, frametime);
-			}
+/**
+ * Runs the threaded physics, then runs obj_move_do_physics() again on the main thread from the same starting point and
+ * compares the results bitwise.  Since both runs see the same pre-moved objects, a mismatch can only come from a worker
+ * touching state another object's physics depend on.  This does not compare against the fully serial obj_move_all():
+ * the deferred post-moves seeing later objects already moved are an intended difference of -threaded_physics.
+ * The main thread results are the ones that are kept.
+ */
+static void obj_move_threaded_physics_race_checked(float frametime)
+{
+	const size_t count = Obj_move_threaded.size();
+	Obj_move_saved_states.resize(count * 2);
+
+	for (size_t i = 0; i < count; ++i) {
+		obj_save_physics_state(Obj_move_infos[Obj_move_threaded[i]].objp, &Obj_move_saved_states[i]);
+	}
+
+	obj_move_threaded_physics(frametime);
+
+	for (size_t i = 0; i < count; ++i) {
+		object *objp = Obj_move_infos[Obj_move_threaded[i]].objp;
+
+		obj_save_physics_state(objp, &Obj_move_saved_states[count + i]);
+		obj_restore_physics_state(objp, &Obj_move_saved_states[i]);
+	}
+
+	int mismatches = 0;
+	for (size_t i = 0; i < count; ++i) {
+		object *objp = Obj_move_infos[Obj_move_threaded[i]].objp;
+
+		obj_move_do_physics(objp, frametime);
+
+		obj_physics_state serial_state;
+		obj_save_physics_state(objp, &serial_state);
+		if (memcmp(&serial_state, &Obj_move_saved_states[count + i], sizeof(serial_state)) != 0) {
+			mprintf(("Threaded physics of object %d (%s) differ from a rerun on the main thread!\n", OBJ_INDEX(objp), Object_type_names[objp->type]));
+			++mismatches;
 		}
+	}
+
+	if (mismatches > 0) {
+		Warning(LOCATION, "The threaded physics of %d of %d objects did not match a rerun on the main thread this frame.  See the log for details.", mismatches, (int)count);
+	}
+}
 
-		// If the object isn't supposed to move, roll back any movement that occurred.  Most of the movement should already have been skipped, but this ensures complete immobility.
-		if (dont_change_position) {
-			objp->pos = objp->last_pos;
+/**
+ * Moves the objects in three passes instead of one: first everything up to the physics for all objects on the main thread,
+ * then the physics of all objects which only touch that object on the worker threads, and finally everything after the
+ * physics on the main thread again.  Both serial passes still process the objects in list order.
+ */
+static void obj_move_all_threaded(float frametime, bool global_cmeasure_timer, SCP_vector<object*> &cmeasure_list)
+{
+	Obj_move_infos.clear();
+	Obj_move_threaded.clear();
 
-			// make sure velocity is always 0
-			vm_vec_zero(&objp->phys_info.vel);
-			vm_vec_zero(&objp->phys_info.desired_vel);
-			objp->phys_info.speed = 0.0f;
-			objp->phys_info.fspeed = 0.0f;
+	for (object *objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+		obj_move_info info;
+		if (!obj_move_all_begin(objp, frametime, global_cmeasure_timer, cmeasure_list, &info)) {
+			continue;
 		}
-		if (dont_change_orientation) {
-			objp->orient = objp->last_orient;
 
-			// make sure velocity is always 0
-			vm_vec_zero(&objp->phys_info.rotvel);
-			vm_vec_zero(&objp->phys_info.desired_rotvel);
+		if (!obj_move_physics_threadable(info)) {
+			obj_move_all_physics(info, frametime);
+		} else if (!info.dont_change_position || !info.dont_change_orientation) {
+			Obj_move_threaded.push_back(Obj_move_infos.size());
 		}
 
-		// Submodel movement now happens here, right after physics movement.  It's not excluded by the "immobile", "don't-change-position", or "don't-change-orientation" flags.
-		
-		// this flag only affects ship subsystems, not any other type of submodel movement
-		if (objp->type == OBJ_SHIP && !Ships[objp->instance].flags[Ship::Ship_Flags::Subsystem_movement_locked])
-			ship_move_subsystems(objp);
-
-		// do animation on this object
-		int model_instance_num = object_get_model_instance_num(objp);
-		if (model_instance_num >= 0) {
-			polymodel_instance* pmi = model_get_instance(model_instance_num);
-			animation::ModelAnimation::stepAnimations(frametime, pmi);
+		Obj_move_infos.push_back(info);
+	}
+
+	{
+		TRACE_SCOPE(tracing::Physics);
+
+		if (Physics_race_check) {
+			obj_move_threaded_physics_race_checked(frametime);
+		} else {
+			obj_move_threaded_physics(frametime);
 		}
+	}
 
-		// finally, do intrinsic motion on this object
-		// (this happens last because look_at is a type of intrinsic rotation,
-		// and look_at needs to happen last or the angle may be off by a frame)
-		model_do_intrinsic_motions(objp);
+	for (const auto &info : Obj_move_infos) {
+		obj_move_all_end(info, frametime);
+	}
+}
 
-		// Future TODO: Props will need a version of this when submodel animation support is added.
-		// For ships, we now have to make sure that all the submodel detail levels remain consistent.
-		if (objp->type == OBJ_SHIP)
-			ship_model_replicate_submodels(objp);
+/**
+ * Move all objects for the current frame
+ */
+void obj_move_all(float frametime)
+{
+	TRACE_SCOPE(tracing::MoveObjects);
+
+	object *objp;	
+	SCP_vector<object*> cmeasure_list;
+	const bool global_cmeasure_timer = (Cmeasures_homing_check > 0);
 
-		// move post
-		obj_move_all_post(objp, frametime);
+	Assertion(Cmeasures_homing_check >= 0, "Cmeasures_homing_check is %d in obj_move_all(); it should never be negative. Get a coder!\n", Cmeasures_homing_check);
 
-		// Equipment script processing
-		if (objp->type == OBJ_SHIP && scripting::hooks::OnWeaponEquipped->isActive()) {
-			ship* shipp = &Ships[objp->instance];
-			object* target;
-
-			if (Ai_info[shipp->ai_index].target_objnum != -1)
-				target = &Objects[Ai_info[shipp->ai_index].target_objnum];
-			else
-				target = NULL;
-			if (objp == Player_obj && Player_ai->target_objnum != -1)
-				target = &Objects[Player_ai->target_objnum];
-
-			scripting::hooks::OnWeaponEquipped->run(scripting::hooks::WeaponEquippedConditions{ shipp, target },
-				scripting::hook_param_list(
-					scripting::hook_param("User", 'o', objp),
-					scripting::hook_param("Target", 'o', target)
-				));
+	if (global_cmeasure_timer)
+		Cmeasures_homing_check--;
+
+	// Goober5000 - HACK HACK HACK
+	// this function also resets the OF_DOCKED_ALREADY_HANDLED flag, to save trips
+	// through the used object list
+	obj_delete_all_that_should_be_dead();
+
+	obj_merge_created_list();
+
+	// the AI and homing weapons look for nearby objects while everything is being moved
+	ship_grid_rebuild(frametime);
+	weapon_homing_grid_rebuild(frametime);
+
+	// Clear the table that tells which groups of weapons have cast light so far.
+	if(!(Game_mode & GM_MULTIPLAYER) || (MULTIPLAYER_MASTER)) {
+		obj_clear_weapon_group_id_list();
+	}
+
+	MONITOR_INC( NumObjects, Num_objects );	
+
+	if (Cmdline_threaded_physics && threading::is_threading()) {
+		obj_move_all_threaded(frametime, global_cmeasure_timer, cmeasure_list);
+	} else {
+		for (objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+			obj_move_info info;
+			if (!obj_move_all_begin(objp, frametime, global_cmeasure_timer, cmeasure_list, &info)) {
+				continue;
+			}
+
+			obj_move_all_physics(info, frametime);
+			obj_move_all_end(info, frametime);
 		}
 	}
 
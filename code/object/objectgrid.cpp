@@ -0,0 +1,100 @@
+#include "object/objectgrid.h"
+
+#include "object/object.h"
+
+#include <cmath>
+
+object_grid::object_grid(float cell_size) : m_cell_size(cell_size), m_inv_cell_size(1.0f / cell_size)
+{
+	Assertion(cell_size > 0.0f, "Invalid grid cell size %f!", cell_size);
+}
+
+void object_grid::clear()
+{
+	m_items.clear();
+	m_max_extent = 0.0f;
+
+	// keep the cells around since the same ones are usually occupied again in the next frame, but drop those which
+	// were already empty this time
+	for (auto it = m_cells.begin(); it != m_cells.end();) {
+		if (it->second.empty()) {
+			it = m_cells.erase(it);
+		} else {
+			it->second.clear();
+			++it;
+		}
+	}
+}
+
+void object_grid::add(int objnum, const vec3d& pos, float extent)
+{
+	m_items.push_back({pos, extent, objnum, Objects[objnum].signature});
+	m_max_extent = std::max(m_max_extent, extent);
+
+	m_cells[cell_key(cell_coord(pos.xyz.x), cell_coord(pos.xyz.y), cell_coord(pos.xyz.z))].push_back(m_items.size() - 1);
+}
+
+size_t object_grid::size() const
+{
+	return m_items.size();
+}
+
+int object_grid::cell_coord(float v) const
+{
+	return static_cast<int>(std::floor(v * m_inv_cell_size));
+}
+
+uint64_t object_grid::cell_key(int x, int y, int z)
+{
+	// 21 bits per axis covers a few billion meters with any sensible cell size, and if coordinates ever wrap around
+	// the distance check below still keeps the results correct
+	const uint64_t mask = (1u << 21) - 1;
+	return ((static_cast<uint64_t>(x) & mask) << 42) | ((static_cast<uint64_t>(y) & mask) << 21) | (static_cast<uint64_t>(z) & mask);
+}
+
+void object_grid::gather(const vec3d& center, float range, SCP_vector<size_t>& out) const
+{
+	const float reach = range + m_max_extent;
+
+	auto check = [&](size_t index) {
+		const auto& it = m_items[index];
+		if (Objects[it.objnum].signature != it.signature) {
+			return;
+		}
+
+		const float max_dist = range + it.extent;
+
+		if (vm_vec_dist_squared(&center, &it.pos) <= max_dist * max_dist) {
+			out.push_back(index);
+		}
+	};
+
+	const int min_x = cell_coord(center.xyz.x - reach), max_x = cell_coord(center.xyz.x + reach);
+	const int min_y = cell_coord(center.xyz.y - reach), max_y = cell_coord(center.xyz.y + reach);
+	const int min_z = cell_coord(center.xyz.z - reach), max_z = cell_coord(center.xyz.z + reach);
+
+	const double num_cells = double(max_x - min_x + 1) * double(max_y - min_y + 1) * double(max_z - min_z + 1);
+
+	// a query covering more cells than there are objects is better off just looking at all of them
+	if (num_cells >= static_cast<double>(m_items.size())) {
+		for (size_t i = 0; i < m_items.size(); ++i) {
+			check(i);
+		}
+		return;
+	}
+
+	for (int x = min_x; x <= max_x; ++x) {
+		for (int y = min_y; y <= max_y; ++y) {
+			for (int z = min_z; z <= max_z; ++z) {
+				auto cell = m_cells.find(cell_key(x, y, z));
+				if (cell == m_cells.end()) {
+					continue;
+				}
+
+				for (auto index : cell->second) {
+					check(index);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include <algorithm>
+
+// Uniform grid over object positions for range queries.
+//
+// Only occupied cells are stored, in a hash map keyed by the integer cell coordinates, so the grid covers all of
+// space and empty regions don't cost anything. Every object is stored with an extent which is the distance from its
+// position that any part of it the caller cares about can reach, e.g. a multiple of its radius.
+//
+// Queries report objects in the order they were added so callers which pick the first of several equally good
+// candidates behave exactly like a loop over the list the grid was filled from. The signature of every object is
+// remembered as well, so objects which were deleted and whose slot was reused since they were added are skipped.
+class object_grid
+{
+  public:
+	explicit object_grid(float cell_size);
+
+	void clear();
+
+	void add(int objnum, const vec3d& pos, float extent);
+
+	size_t size() const;
+
+	// Calls func(objnum) for every object whose extent around its position overlaps the sphere of the given range
+	// around center. func must not add objects to the grid.
+	template <typename Func>
+	void query(const vec3d& center, float range, Func func) const;
+
+  private:
+	struct item {
+		vec3d pos;
+		float extent;
+		int objnum;
+		int signature;
+	};
+
+	int cell_coord(float v) const;
+	static uint64_t cell_key(int x, int y, int z);
+
+	void gather(const vec3d& center, float range, SCP_vector<size_t>& out) const;
+
+	float m_cell_size;
+	float m_inv_cell_size;
+	float m_max_extent = 0.0f;
+
+	SCP_vector<item> m_items;
+	SCP_unordered_map<uint64_t, SCP_vector<size_t>> m_cells;
+};
+
+template <typename Func>
+void object_grid::query(const vec3d& center, float range, Func func) const
+{
+	SCP_vector<size_t> found;
+	gather(center, range, found);
+
+	// items are numbered in the order they were added
+	std::sort(found.begin(), found.end());
+
+	for (auto index : found) {
+		func(m_items[index].objnum);
+	}
+}
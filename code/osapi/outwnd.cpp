@@ -11,6 +11,7 @@
 #include <cstdarg>
 #include <cstring>
 #include <algorithm>
+#include <mutex>
 
 #ifdef WIN32
 #include <direct.h>
@@ -68,6 +69,9 @@ static const char* FreeSpace_logfilename = nullptr;
 
 static std::unique_ptr<osapi::DebugWindow> debugWindow;
 
+// bitmaps may be decoded on the worker threads, and the image libraries report problems through the log
+static std::recursive_mutex Outwnd_mutex;
+
 void load_filter_info()
 {
 	FILE* fp;
@@ -206,6 +210,8 @@ void outwnd_print(const char *id, const char *tmp)
 	if (!outwnd_inited)
 		return;
 
+	std::lock_guard<std::recursive_mutex> guard(Outwnd_mutex);
+
 	if (Outwnd_no_filter_file == 1) {
 		Outwnd_no_filter_file = 2;
 
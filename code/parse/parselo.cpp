@@ -24,6 +24,7 @@
 #include "parse/md5_hash.h"
 #include "parse/parselo.h"
 #include "parse/sexp.h"
+#include "parse/textscan.h"
 #include "ship/ship.h"
 #include "weapon/weapon.h"
 #include "mod_table/mod_table.h"
@@ -59,9 +60,20 @@ const char	*token_found;
 SCP_vector<Bookmark> Bookmarks;	// Stack of all our previously paused parsing
 
 // text allocation stuff
-void allocate_parse_text(size_t size);
 static size_t Parse_text_size = 0;
 
+// where get_line_num() counts a new line, as the number of characters outside of comments which come before it
+static SCP_vector<ptrdiff_t> Line_index;
+static ptrdiff_t Line_index_length = 0;	// characters outside of comments in all of Parse_text
+static bool Line_index_valid = false;
+
+static constexpr text_scanner White_space_chars(" \t\n\r");
+static constexpr text_scanner Gray_space_chars(" \t");
+static constexpr text_scanner Eoln_chars("\n");
+// everything strip_comments() and parse_get_line() have to take a closer look at
+static constexpr text_scanner Comment_chars("\r\n;/*!\"");
+static constexpr text_scanner Line_ending_chars("\r\n\xff");
+
 static const SCP_unordered_map<SCP_string, SCP_string> retail_hashes = {
 	{"strings.tbl", "84ab6e5392d7c54752a61161aac9f9fd"},
 	{"weapons.tbl", "ca2c7f305b1f36988c2bb8c371ab2027"}
@@ -118,8 +130,7 @@ void ignore_white_space(const char **pp)
 	if (pp == nullptr)
 		pp = const_cast<const char**>(&Mp);
 
-	while ((**pp != '\0') && is_white_space(**pp))
-		(*pp)++;
+	*pp = White_space_chars.skip(*pp);
 }
 
 void ignore_gray_space(const char **pp)
@@ -127,8 +138,7 @@ void ignore_gray_space(const char **pp)
 	if (pp == nullptr)
 		pp = const_cast<const char**>(&Mp);
 
-	while ((**pp != '\0') && is_gray_space(**pp))
-		(*pp)++;
+	*pp = Gray_space_chars.skip(*pp);
 }
 
 //	Truncate *str, eliminating all trailing white space.
@@ -262,29 +272,20 @@ char *next_tokens(bool terminate_before_parenthesis_or_comma)
 	return Error_str;
 }
 
-//	Return the line number given by the current mission pointer, ie Mp.
-//	A very slow function (scans all processed text), but who cares how long
-//	an error reporting function takes?
-int get_line_num()
+// Walks all of Parse_text the way get_line_num() always has, and remembers where each line starts.  Characters
+// inside comments don't move the stopping point along, so the lines are recorded by how many characters outside of
+// comments come before them.
+static void build_line_index()
 {
-	int		count = 1;
 	bool	inquote = false;
-	int		incomment = false;
-	int		multiline = false;
-	char	*p = Parse_text;
-	char	*stoploc = Mp;
+	bool	incomment = false;
+	bool	multiline = false;
+	ptrdiff_t	position = 0;
 
-	// if there is no parse text, then we have some ad-hoc text such as provided in an evaluateSEXP call or in the debug console
-	if (Parse_text == nullptr)
-		return count;
+	Line_index.clear();
 
-	while (p < stoploc)
+	for (const char *p = Parse_text; *p != '\0'; p++)
 	{
-		if (*p == '\0') {
-			Warning(LOCATION, "Unexpected end-of-file while looking for line number!");
-			break;
-		}
-
 		if ( !incomment && (*p == '\"') )
 			inquote = !inquote;
 
@@ -296,22 +297,48 @@ int get_line_num()
 			incomment = true;
 		}
 
-		if ( incomment )
-			stoploc++;
+		bool counted = !incomment;
 
-		if ( multiline && (*(p-1) == '*') && (*p == '/') ) {
+		if ( multiline && (p > Parse_text) && (*(p-1) == '*') && (*p == '/') ) {
 			multiline = false;
 			incomment = false;
 		}
 
-		if (*p++ == EOLN) {	// in the process of parsing, all line endings are normalized to single-character EOLN
+		if (*p == EOLN) {	// in the process of parsing, all line endings are normalized to single-character EOLN
 			if ( !multiline && incomment )
 				incomment = false;
-			count++;
+			Line_index.push_back(position);
 		}
+
+		if (counted)
+			position++;
 	}
 
-	return count;
+	Line_index_length = position;
+	Line_index_valid = true;
+}
+
+//	Return the line number given by the current mission pointer, ie Mp.
+//	The whole text is only scanned once after it changes, see build_line_index().
+int get_line_num()
+{
+	// if there is no parse text, then we have some ad-hoc text such as provided in an evaluateSEXP call or in the debug console
+	if (Parse_text == nullptr)
+		return 1;
+
+	if (!Line_index_valid)
+		build_line_index();
+
+	ptrdiff_t stoploc = Mp - Parse_text;
+	if (stoploc <= 0)
+		return 1;
+
+	if (stoploc > Line_index_length) {
+		Warning(LOCATION, "Unexpected end-of-file while looking for line number!");
+		return 1 + (int)Line_index.size();
+	}
+
+	return 1 + (int)(std::lower_bound(Line_index.begin(), Line_index.end(), stoploc) - Line_index.begin());
 }
 
 //	Call this function to display an error message.
@@ -353,17 +380,20 @@ void error_display(int error_level, const char *format, ...)
 //	Advance Mp to the next eoln character.
 void advance_to_eoln(const char *more_terminators)
 {
+	if (more_terminators == nullptr) {
+		Mp = const_cast<char*>(Eoln_chars.find(Mp));
+		return;
+	}
+
 	char	terminators[128];
 
-	Assert((more_terminators == NULL) || (strlen(more_terminators) < 125));
+	Assert(strlen(more_terminators) < 125);
 
 	terminators[0] = EOLN;
 	terminators[1] = 0;
-	if (more_terminators != NULL)
-		strcat_s(terminators, more_terminators);
+	strcat_s(terminators, more_terminators);
 
-	while (strchr(terminators, *Mp) == NULL)
-		Mp++;
+	Mp = const_cast<char*>(text_scanner(terminators).find(Mp));
 }
 
 // Advance Mp to the next white space (ignoring white space inside of " marks)
@@ -2121,6 +2151,22 @@ void strip_comments(char *line, bool &in_quote, bool &in_multiline_comment_a, bo
 	// copy all characters from read to write, unless they're commented
 	while (*readp != '\r' && *readp != '\n' && *readp != '\0')
 	{
+		// characters which can't start or end a comment or a quote are copied (or dropped) all at once
+		auto plain = Comment_chars.find(readp) - readp;
+		if (plain > 0)
+		{
+			if (!in_multiline_comment_a && !in_multiline_comment_b)
+			{
+				if (writep != readp)
+					memmove(writep, readp, plain);
+
+				writep += plain;
+			}
+
+			readp += plain;
+			continue;
+		}
+
 		// only check for comments if not quoting
 		if (!in_quote)
 		{
@@ -2216,6 +2262,19 @@ int parse_get_line(char *lineout, int max_line_len, const char *textin, int inpu
 
 	for (int num_chars_read = 1; num_chars_read <= input_len; ++num_chars_read)
 	{
+		// copy everything up to the next character which needs a closer look all at once, but leave the last
+		// character of the input and the one which doesn't fit anymore to the checks below
+		auto plain = std::min({Line_ending_chars.find(textin) - textin, (ptrdiff_t)(input_len - num_chars_read), (ptrdiff_t)(max_line_len - num_chars_written)});
+		if (plain > 0)
+		{
+			memcpy(lineout, textin, plain);
+			lineout += plain;
+			textin += plain;
+			num_chars_read += (int)plain;
+			num_chars_written += (int)plain;
+			prev_c = textin[-1];
+		}
+
 		char c = *textin++;
 
 		if (c == '\0' || c == EOF)	// hard stop
@@ -2371,6 +2430,7 @@ void stop_parse()
 	}
 
 	Parse_text_size = 0;
+	Line_index_valid = false;
 }
 
 void allocate_parse_text(size_t size)
@@ -2380,6 +2440,8 @@ void allocate_parse_text(size_t size)
 	// Make sure that there is space for the terminating null character
 	size += 1;
 
+	Line_index_valid = false;
+
 	if (size <= Parse_text_size) {
 		// Make sure that a new parsing session does not use uninitialized data.
 		memset( Parse_text, 0, sizeof(char) * Parse_text_size );
@@ -2608,6 +2670,7 @@ void process_raw_file_text(char* processed_text, char* raw_text)
 
 	mp = processed_text;
 	mp_raw = raw_text;
+	Line_index_valid = false;
 
 	// strip comments from raw text, reading into file_text
 	int num_chars_read = 0;
@@ -3682,6 +3745,9 @@ void reset_parse(char *text)
 	Warning_count = 0;
 	Error_count = 0;
 
+	// the text may have been changed in place since it was read
+	Line_index_valid = false;
+
 	strcpy_s(Current_filename, Current_filename_sub);
 }
 
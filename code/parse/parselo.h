@@ -350,6 +350,8 @@ extern void pause_parse();
 extern void unpause_parse();
 // stop parsing, basically just frees up the memory from Parse_text and Parse_text_raw
 extern void stop_parse();
+// makes sure Parse_text and Parse_text_raw can hold size characters plus the terminating null, and clears them
+extern void allocate_parse_text(size_t size);
 
 // utility
 extern void compact_multitext_string(char *str);
@@ -105,6 +105,7 @@
 #include "starfield/supernova.h"
 #include "stats/medals.h"
 #include "utils/Random.h"
+#include "utils/name_index.h"
 #include "weapon/beam.h"
 #include "weapon/emp.h"
 #include "weapon/shockwave.h"
@@ -1274,6 +1275,20 @@ int arg_item::is_empty()
 }
 //-------------------------------------------------------------------------------------------------
 
+// Reverse links of the sexp nodes, so that looking for the parent of a node doesn't have to scan the whole node array.
+// Enabled by sexp_precompute_nodes() once a mission is loaded and rebuilt lazily whenever nodes are allocated, freed
+// or relinked afterwards.  See sexp_update_link_index().
+static bool Sexp_link_index_enabled = false;
+static bool Sexp_link_index_dirty = true;
+static SCP_vector<int> Sexp_first_owner;		// lowest node whose first is this node
+static SCP_vector<int> Sexp_rest_owner;		// lowest node whose rest is this node
+static SCP_vector<bool> Sexp_used_referenced;	// whether any other used node has this node as its first or rest
+
+static void sexp_links_changed()
+{
+	Sexp_link_index_dirty = true;
+}
+
 void clear_cache(int node)
 {
 	// free anything cached
@@ -1292,6 +1307,7 @@ void sexp_nodes_init()
 		return;
 
 	nprintf(("SEXP", "Reinitializing sexp nodes...\n"));
+	sexp_links_changed();
 	nprintf(("SEXP", "Entered function with %d nodes.\n", Num_sexp_nodes));
 
 	// usually, the persistent nodes are grouped at the beginning of the array;
@@ -1335,6 +1351,7 @@ void sexp_nodes_init()
 static void sexp_nodes_close()
 {
 	// free all sexp nodes... should only be done on game shutdown
+	sexp_links_changed();
 	if (Sexp_nodes != nullptr)
 	{
 		// free anything cached
@@ -1356,6 +1373,9 @@ void init_sexp()
 	Sexp_current_argument_nesting_level = 0;
 	Current_sexp_network_packet.initialize();
 
+	// the nodes of the next mission aren't there yet
+	Sexp_link_index_enabled = false;
+
 	sexp_nodes_init();
 	init_sexp_vars();
 	init_sexp_containers();
@@ -1470,6 +1490,8 @@ int alloc_sexp(const char *text, int type, int subtype, int first, int rest)
 	Assert(strlen(text) < TOKEN_LENGTH);
 	Assert(type >= 0);
 
+	sexp_links_changed();
+
 	strcpy_s(Sexp_nodes[node].text, text);
 	Sexp_nodes[node].type = type;
 	Sexp_nodes[node].subtype = subtype;
@@ -1591,6 +1613,7 @@ int free_one_sexp(int num)
 
 	Sexp_nodes[num].type = SEXP_NOT_USED;
 	clear_cache(num);
+	sexp_links_changed();
 	return 1;
 }
 
@@ -1615,6 +1638,7 @@ int free_sexp(int num, int calling_node)
 
 	Sexp_nodes[num].type = SEXP_NOT_USED;
 	clear_cache(num);
+	sexp_links_changed();
 	count++;
 
 	i = Sexp_nodes[num].first;
@@ -1789,6 +1813,299 @@ int query_node_in_sexp(int node, int sexp)
 	return 0;
 }
 
+/**
+ * Bring the reverse links up to date if they are in use.  The lookups give exactly the same results as the scans they
+ * replace, including for nodes which were freed but still have their old links.
+ *
+ * @return whether the lookups can use the index
+ */
+static bool sexp_update_link_index()
+{
+	if (!Sexp_link_index_enabled || Fred_running)
+		return false;
+
+	if (!Sexp_link_index_dirty)
+		return true;
+
+	Sexp_first_owner.assign(Num_sexp_nodes, -1);
+	Sexp_rest_owner.assign(Num_sexp_nodes, -1);
+	Sexp_used_referenced.assign(Num_sexp_nodes, false);
+
+	for (int i = 0; i < Num_sexp_nodes; i++)
+	{
+		int first = Sexp_nodes[i].first;
+		int rest = Sexp_nodes[i].rest;
+
+		// the scans stop at the lowest matching node, so keep the first one found
+		if (first >= 0 && first < Num_sexp_nodes && Sexp_first_owner[first] < 0)
+			Sexp_first_owner[first] = i;
+		if (rest >= 0 && rest < Num_sexp_nodes && Sexp_rest_owner[rest] < 0)
+			Sexp_rest_owner[rest] = i;
+
+		if (Sexp_nodes[i].type != SEXP_NOT_USED)
+		{
+			if (first >= 0 && first < Num_sexp_nodes && first != i)
+				Sexp_used_referenced[first] = true;
+			if (rest >= 0 && rest < Num_sexp_nodes && rest != i)
+				Sexp_used_referenced[rest] = true;
+		}
+	}
+
+	Sexp_link_index_dirty = false;
+	return true;
+}
+
+/**
+ * Resolve up front what the evaluator would otherwise work out the first time it reaches a node, for all nodes of
+ * the loaded mission: the operator of every operator node and whether a node is part of a when-argument tree.  Both
+ * need the parent of a node, which is looked up through the reverse link index from now on instead of by scanning
+ * all nodes.  Called once the mission is parsed, the results are the same as resolving everything lazily.
+ */
+void sexp_precompute_nodes()
+{
+	if (Fred_running)
+		return;
+
+	Sexp_link_index_enabled = true;
+	sexp_links_changed();
+
+	for (int i = 0; i < Num_sexp_nodes; i++)
+	{
+		if (Sexp_nodes[i].type == SEXP_NOT_USED)
+			continue;
+
+		if (Sexp_nodes[i].subtype == SEXP_ATOM_OPERATOR)
+			get_operator_index(i);
+	}
+
+	for (int i = 0; i < Num_sexp_nodes; i++)
+	{
+		if (Sexp_nodes[i].type != SEXP_NOT_USED)
+			is_descendant_of_when_argument_op(i);
+	}
+}
+
+// How often each of the SEXP_INPUT_* has changed.  The counts only ever go up, so the sum over the inputs of a formula
+// changes whenever any one of them does.
+static uint64_t Sexp_input_generations[SEXP_NUM_INPUTS] = {};
+static TIMESTAMP Sexp_events_changed_time = TIMESTAMP::invalid();
+
+/**
+ * Let the formulas which read the given SEXP_INPUT_* know that they have to be evaluated again
+ */
+void sexp_input_changed(int inputs)
+{
+	for (int i = 0; i < SEXP_NUM_INPUTS; i++)
+	{
+		if (inputs & (1 << i))
+			Sexp_input_generations[i]++;
+	}
+
+	if (inputs & SEXP_INPUT_EVENTS)
+		Sexp_events_changed_time = _timestamp();
+}
+
+/**
+ * Sum up the changes to the given inputs so far.  A formula which was false for one stamp is still false as long as
+ * the stamp stays the same.
+ *
+ * @return the stamp, or 0 if the formula can't rely on it yet
+ */
+uint64_t sexp_input_stamp(int inputs)
+{
+	Assertion(!(inputs & SEXP_INPUT_VOLATILE), "Volatile formulas don't have an input stamp!");
+
+	// the event delay operators hold back an event which changed until a frame has gone by, same as in
+	// sexp_event_delay_status()
+	if ((inputs & SEXP_INPUT_EVENTS) && Sexp_events_changed_time.isValid() && !timestamp_elapsed_last_frame(Sexp_events_changed_time))
+		return 0;
+
+	uint64_t stamp = 1;
+	for (int i = 0; i < SEXP_NUM_INPUTS; i++)
+	{
+		if (inputs & (1 << i))
+			stamp += Sexp_input_generations[i];
+	}
+
+	return stamp;
+}
+
+// whether the node is a plain 0, the only delay which doesn't make an objective operator depend on time
+static bool sexp_is_zero_delay(int node)
+{
+	return (node >= 0) && (Sexp_nodes[node].first == -1) && (Sexp_nodes[node].subtype == SEXP_ATOM_NUMBER) &&
+		!(Sexp_nodes[node].type & SEXP_FLAG_VARIABLE) && (atoi(Sexp_nodes[node].text) == 0);
+}
+
+static int sexp_get_node_inputs(int node);
+
+// inputs of all nodes of an argument list
+static int sexp_get_list_inputs(int node)
+{
+	int inputs = 0;
+	for (int n = node; n != -1; n = CDR(n))
+		inputs |= sexp_get_node_inputs(n);
+
+	return inputs;
+}
+
+static int sexp_get_node_inputs(int node)
+{
+	auto &sn = Sexp_nodes[node];
+
+	if (sn.subtype == SEXP_ATOM_CONTAINER_NAME || sn.subtype == SEXP_ATOM_CONTAINER_DATA || (sn.flags & SNF_SPECIAL_ARG_IN_NODE))
+		return SEXP_INPUT_VOLATILE;
+
+	if (sn.first != -1)
+		return sexp_get_node_inputs(sn.first);
+
+	if (sn.subtype != SEXP_ATOM_OPERATOR)
+		return (sn.type & SEXP_FLAG_VARIABLE) ? SEXP_INPUT_VARIABLES : 0;
+
+	int args = CDR(node);
+
+	switch (get_operator_const(node))
+	{
+		case OP_TRUE:
+		case OP_FALSE:
+		case OP_AND:
+		case OP_OR:
+		case OP_NOT:
+		case OP_XOR:
+		case OP_EQUALS:
+		case OP_NOT_EQUAL:
+		case OP_GREATER_THAN:
+		case OP_LESS_THAN:
+		case OP_GREATER_OR_EQUAL:
+		case OP_LESS_OR_EQUAL:
+		case OP_PLUS:
+		case OP_MINUS:
+		case OP_MUL:
+		case OP_DIV:
+		case OP_MOD:
+		case OP_ABS:
+		case OP_MIN:
+		case OP_MAX:
+			return sexp_get_list_inputs(args);
+
+		// these look at the ship registry, the wings and the mission log, and only at the time if there is a delay
+		case OP_IS_DESTROYED_DELAY:
+		case OP_HAS_ARRIVED_DELAY:
+		case OP_HAS_DEPARTED_DELAY:
+		case OP_IS_DISABLED_DELAY:
+		case OP_IS_DISARMED_DELAY:
+			if (!sexp_is_zero_delay(args))
+				return SEXP_INPUT_VOLATILE;
+			return SEXP_INPUT_MISSION_LOG | SEXP_INPUT_SHIPS | sexp_get_list_inputs(CDR(args));
+
+		case OP_IS_SUBSYSTEM_DESTROYED_DELAY:
+			if (!sexp_is_zero_delay(CDDR(args)))
+				return SEXP_INPUT_VOLATILE;
+			return SEXP_INPUT_MISSION_LOG | SEXP_INPUT_SHIPS | sexp_get_list_inputs(args);
+
+		case OP_EVENT_TRUE_DELAY:
+		case OP_EVENT_FALSE_DELAY:
+		case OP_EVENT_TRUE_MSECS_DELAY:
+		case OP_EVENT_FALSE_MSECS_DELAY:
+			if (!sexp_is_zero_delay(CDR(args)))
+				return SEXP_INPUT_VOLATILE;
+			return SEXP_INPUT_EVENTS | sexp_get_list_inputs(args);
+
+		case OP_EVENT_TRUE:
+		case OP_EVENT_FALSE:
+		case OP_EVENT_INCOMPLETE:
+			return SEXP_INPUT_EVENTS | sexp_get_list_inputs(args);
+
+		case OP_GOAL_TRUE_DELAY:
+		case OP_GOAL_FALSE_DELAY:
+			if (!sexp_is_zero_delay(CDR(args)))
+				return SEXP_INPUT_VOLATILE;
+			return SEXP_INPUT_MISSION_LOG | sexp_get_list_inputs(args);
+
+		case OP_GOAL_INCOMPLETE:
+			return SEXP_INPUT_MISSION_LOG | sexp_get_list_inputs(args);
+
+		default:
+			return SEXP_INPUT_VOLATILE;
+	}
+}
+
+/**
+ * Work out which SEXP_INPUT_* the formula of an event or goal reads, so that a formula which came up false doesn't
+ * have to be evaluated again until one of them changes.  Only the operators listed in sexp_get_node_inputs() are
+ * understood; anything else, including everything that depends on time, makes the formula SEXP_INPUT_VOLATILE.
+ * The actions of a top-level when don't count since they only run once the condition is true, and then the event is
+ * evaluated again anyway.
+ */
+int sexp_get_formula_inputs(int node)
+{
+	if (node < 0)
+		return SEXP_INPUT_VOLATILE;
+
+	if (Sexp_nodes[node].first != -1)
+		node = Sexp_nodes[node].first;
+
+	if ((Sexp_nodes[node].subtype == SEXP_ATOM_OPERATOR) && (get_operator_const(node) == OP_WHEN))
+	{
+		int cond = CDR(node);
+		return (cond >= 0) ? sexp_get_node_inputs(cond) : SEXP_INPUT_VOLATILE;
+	}
+
+	return sexp_get_node_inputs(node);
+}
+
+/**
+ * Resolve the ships, wings and variables which the arguments of the loaded mission's operators refer to, exactly as
+ * eval_ship(), eval_wing() and sexp_get_variable_index() would cache them on first use.  Only arguments whose value
+ * can't change later are resolved, and names which aren't known yet are left to be looked up during play.  Called
+ * once the mission's sexps have passed the syntax check.
+ */
+void sexp_precompute_references()
+{
+	if (Fred_running)
+		return;
+
+	for (int i = 0; i < Num_sexp_nodes; i++)
+	{
+		if (Sexp_nodes[i].type == SEXP_NOT_USED || Sexp_nodes[i].subtype != SEXP_ATOM_OPERATOR)
+			continue;
+
+		int op_index = get_operator_index(i);
+		if (op_index < 0)
+			continue;
+
+		int argnum = 0;
+		for (int node = CDR(i); node >= 0; node = CDR(node), argnum++)
+		{
+			if (Sexp_nodes[node].type & SEXP_FLAG_VARIABLE)
+			{
+				// the node text is the variable index, which the syntax check has verified
+				int index = atoi(Sexp_nodes[node].text);
+				if (index >= 0 && index < MAX_SEXP_VARIABLES && (Sexp_variables[index].type & SEXP_VARIABLE_SET))
+					sexp_get_variable_index(node);
+				continue;
+			}
+
+			if (Sexp_nodes[node].subtype != SEXP_ATOM_STRING || Sexp_nodes[node].cache || is_node_value_dynamic(node))
+				continue;
+
+			switch (query_operator_argument_type(op_index, argnum))
+			{
+				case OPF_SHIP:
+					eval_ship(node);
+					break;
+
+				case OPF_WING:
+					eval_wing(node);
+					break;
+
+				default:
+					break;
+			}
+		}
+	}
+}
+
 /**
  * Find the index of the list associated with an operator
  */
@@ -1796,6 +2113,10 @@ int find_sexp_list(int num)
 {
 	int i;
 
+	// the index only knows about links to actual nodes, a search for -1 finds the lowest node without a first
+	if (num >= 0 && num < Num_sexp_nodes && sexp_update_link_index())
+		return Sexp_first_owner[num];
+
 	for (i = 0; i < Num_sexp_nodes; i++)
 	{
 		if (Sexp_nodes[i].first == num)
@@ -1826,8 +2147,17 @@ int find_parent_operator(int node)
 	}
 
 	// iterate backwards through the sexps nodes (i.e. do the inverse of CDR)
+	bool use_index = sexp_update_link_index();
 	while (Sexp_nodes[node].subtype != SEXP_ATOM_OPERATOR)
 	{
+		if (use_index)
+		{
+			node = Sexp_rest_owner[node];
+			if (node < 0)
+				return -1;  // not found, probably at top node already.
+			continue;
+		}
+
 		for (i = 0; i < Num_sexp_nodes; i++)
 		{
 			if (Sexp_nodes[i].rest == node)
@@ -1857,6 +2187,9 @@ int is_sexp_top_level( int node )
 	if (Sexp_nodes[node].type == SEXP_NOT_USED)
 		return 0;
 
+	if (sexp_update_link_index())
+		return Sexp_used_referenced[node] ? 0 : 1;
+
 	for (i = 0; i < Num_sexp_nodes; i++)
 	{
 		if ((Sexp_nodes[i].type == SEXP_NOT_USED) || (i == node ))				// don't check myself or unused nodes
@@ -1906,10 +2239,13 @@ int get_operator_index(const char *token)
 {
 	Assertion(token != nullptr, "get_operator_index(char*) called with a null token; get a coder!\n");
 
-	for (size_t i=0; i < Operators.size(); i++){
-		if (Operators[i].text == token){
-			return (int)i;
-		}
+	// operators are only ever added, and their names are compared case-sensitively
+	static util::name_index<std::hash<std::string_view>> operator_index;
+	operator_index.update(static_cast<int>(Operators.size()), [](int i) { return Operators[i].text.c_str(); });
+
+	int i = operator_index.find(token, [token](int idx) { return Operators[idx].text == token; });
+	if (i >= 0){
+		return i;
 	}
 
 	return NOT_A_SEXP_OPERATOR;
@@ -4846,6 +5182,7 @@ int get_sexp()
 				node = alloc_sexp("", SEXP_LIST, SEXP_ATOM_LIST, node, -1);
 			}
 			Sexp_nodes[last].rest = node;
+			sexp_links_changed();
 
 			if (message != nullptr) {
 				SCP_string context;
@@ -19237,8 +19574,10 @@ void sexp_reset_event(int node)
 			eventp->satisfied_time = TIMESTAMP::invalid();
 			eventp->born_on_date = TIMESTAMP::invalid();
 			eventp->previous_result = 0;
+			eventp->input_stamp = 0;
 
 			flush_sexp_tree(eventp->formula);
+			sexp_input_changed(SEXP_INPUT_EVENTS);
 		}
 		else
 			Warning(LOCATION, "Could not find event '%s'", name);
@@ -19259,6 +19598,7 @@ void sexp_reset_goal(int node)
 			auto goalp = &Mission_goals[goal_num];
 
 			goalp->satisfied = GOAL_INCOMPLETE;
+			goalp->input_stamp = 0;
 			flush_sexp_tree(goalp->formula);
 		}
 		else
@@ -35944,6 +36284,7 @@ int sexp_add_variable(const char *text, const char *var_name, int type, int inde
 		strcpy_s(Sexp_variables[index].variable_name, var_name);
 		Sexp_variables[index].type &= ~SEXP_VARIABLE_NOT_USED;
 		Sexp_variables[index].type = (type | SEXP_VARIABLE_SET);
+		sexp_input_changed(SEXP_INPUT_VARIABLES);
 	}
 
 	return index;
@@ -35961,6 +36302,8 @@ void sexp_add_array_block_variable(int index, bool is_numeric)
 		Sexp_variables[index].type = SEXP_VARIABLE_NUMBER | SEXP_VARIABLE_SET;
 	else
 		Sexp_variables[index].type = SEXP_VARIABLE_STRING | SEXP_VARIABLE_SET;
+
+	sexp_input_changed(SEXP_INPUT_VARIABLES);
 }
 
 /**
@@ -36000,6 +36343,7 @@ void sexp_modify_variable(const char *text, int index, bool sexp_callback)
 		Sexp_variables[index].text[maxCopyLen] = 0;
 	}
 	Sexp_variables[index].type |= SEXP_VARIABLE_MODIFIED;
+	sexp_input_changed(SEXP_INPUT_VARIABLES);
 
 	// do multi_callback_here
 	// if we're called from the sexp code send a SEXP packet (more efficient) 
@@ -36035,6 +36379,7 @@ void multi_sexp_modify_variable()
 		}
 
 		strcpy_s(Sexp_variables[variable_index].text, value);
+		sexp_input_changed(SEXP_INPUT_VARIABLES);
 	}	
 }
 
@@ -1418,6 +1418,14 @@ typedef struct sexp_node {
 #define SNF_NOT_DESCENDANT_OF_WHEN_ARG_OP	(1<<9)
 #define SNF_DEFAULT_VALUE			SNF_ARGUMENT_VALID
 
+// game state read by the formulas of events and goals, see sexp_get_formula_inputs() and sexp_input_changed()
+#define SEXP_INPUT_MISSION_LOG		(1<<0)
+#define SEXP_INPUT_SHIPS			(1<<1)		// ship registry status and wing arrivals, waves and departures
+#define SEXP_INPUT_EVENTS			(1<<2)		// result, flags and count of the mission events
+#define SEXP_INPUT_VARIABLES		(1<<3)
+#define SEXP_NUM_INPUTS				4
+#define SEXP_INPUT_VOLATILE			(1<<4)		// reads anything else, e.g. time, so must be evaluated every time
+
 typedef struct sexp_variable {
 	int		type;
 	char	text[TOKEN_LENGTH];
@@ -1469,6 +1477,11 @@ extern int cmp_sexp_chains(int node1, int node2);
 extern int find_sexp_list(int num);
 extern int find_parent_operator(int num);
 extern int is_sexp_top_level( int node );
+extern void sexp_precompute_nodes();
+extern void sexp_precompute_references();
+extern int sexp_get_formula_inputs(int node);
+extern void sexp_input_changed(int inputs);
+extern uint64_t sexp_input_stamp(int inputs);
 
 // Goober5000 - renamed these to be more clear, to prevent bugs :p
 extern int get_operator_index(const char *token);
@@ -0,0 +1,106 @@
+#include "parse/textscan.h"
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTSCAN_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// the vector loads may read past the terminating null, see scan_vector()
+#if defined(__clang__) || defined(__GNUC__)
+#define TEXTSCAN_NO_SANITIZE __attribute__((no_sanitize_address))
+#else
+#define TEXTSCAN_NO_SANITIZE
+#endif
+
+namespace {
+
+#ifdef TEXTSCAN_SSE2
+inline int first_set_bit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// The loads are aligned to 16 bytes, so none of them can cross into the next page, and the one which contains the
+// terminating null is the last one. The characters it reads past the null are never looked at.
+template <bool Skip, size_t N>
+TEXTSCAN_NO_SANITIZE const char* scan_vector(const char* str, const char* chars)
+{
+	__m128i set[N];
+	for (size_t i = 0; i < N; ++i)
+		set[i] = _mm_set1_epi8(chars[i]);
+
+	const auto zero = _mm_setzero_si128();
+
+	auto offset = (unsigned int)((uintptr_t)str & 15);
+	auto block = str - offset;
+	auto before_str = (1u << offset) - 1;
+
+	for (;;) {
+		auto text = _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+
+		auto in_set = _mm_cmpeq_epi8(text, set[0]);
+		for (size_t i = 1; i < N; ++i)
+			in_set = _mm_or_si128(in_set, _mm_cmpeq_epi8(text, set[i]));
+
+		auto stop = (unsigned int)_mm_movemask_epi8(in_set);
+		if (Skip)
+			stop = ~stop;
+		stop |= (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(text, zero));
+		stop &= 0xFFFFu & ~before_str;
+
+		if (stop != 0)
+			return block + first_set_bit(stop);
+
+		block += 16;
+		before_str = 0;
+	}
+}
+#endif
+
+}
+
+template <bool Skip>
+const char* text_scanner::scan(const char* str) const
+{
+#ifdef TEXTSCAN_SSE2
+	switch (m_count) {
+	case 1:
+		return scan_vector<Skip, 1>(str, m_chars);
+	case 2:
+		return scan_vector<Skip, 2>(str, m_chars);
+	case 3:
+		return scan_vector<Skip, 3>(str, m_chars);
+	case 4:
+		return scan_vector<Skip, 4>(str, m_chars);
+	case 5:
+		return scan_vector<Skip, 5>(str, m_chars);
+	case 6:
+		return scan_vector<Skip, 6>(str, m_chars);
+	case 7:
+		return scan_vector<Skip, 7>(str, m_chars);
+	case 8:
+		return scan_vector<Skip, 8>(str, m_chars);
+	default:
+		break;
+	}
+#endif
+
+	while (*str != '\0' && contains(*str) == Skip)
+		++str;
+
+	return str;
+}
+
+template const char* text_scanner::scan<false>(const char* str) const;
+template const char* text_scanner::scan<true>(const char* str) const;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * Scanning of null-terminated text for the parser. A text_scanner holds a small set of characters and finds the first
+ * character of a string which is, or isn't, in that set. Where SSE2 is available it looks at 16 characters at a time,
+ * everywhere else at one, with exactly the same results. The terminating null always stops a scan.
+ */
+class text_scanner
+{
+  public:
+	// sets with more characters than this are scanned one character at a time
+	static const size_t MAX_VECTOR_CHARS = 8;
+
+	constexpr explicit text_scanner(const char* chars)
+	{
+		for (; *chars != '\0'; ++chars) {
+			auto ch = (unsigned char)*chars;
+			if (m_in_set[ch])
+				continue;
+
+			if (m_count < MAX_VECTOR_CHARS)
+				m_chars[m_count] = *chars;
+
+			m_in_set[ch] = true;
+			++m_count;
+		}
+	}
+
+	bool contains(char ch) const
+	{
+		return m_in_set[(unsigned char)ch];
+	}
+
+	// Returns the first character which is in the set, or the terminating null
+	const char* find(const char* str) const
+	{
+		// most scans stop right away, which isn't worth setting up for
+		return (*str == '\0' || contains(*str)) ? str : scan<false>(str + 1);
+	}
+
+	// Returns the first character which isn't in the set, possibly the terminating null
+	const char* skip(const char* str) const
+	{
+		return contains(*str) ? scan<true>(str + 1) : str;
+	}
+
+  private:
+	template <bool Skip>
+	const char* scan(const char* str) const;
+
+	bool m_in_set[256] = {};
+	char m_chars[MAX_VECTOR_CHARS] = {};
+	size_t m_count = 0;
+};
@@ -16,6 +16,7 @@
 #include "object/object_instance.h"
 #include "hud/hudets.h"
 
+#include <functional>
 #include <optional>
 
 class EffectHost;
@@ -33,6 +34,8 @@ namespace anl {
 
 namespace particle {
 
+struct particle_render_item;
+
 /**
  * @brief Defines a particle effect
  *
@@ -134,8 +137,9 @@ public:
 	friend class ParticleManager;
 	friend int ::parse_weapon(int, bool, const char*);
 	friend ParticleEffectHandle scripting::api::getLegacyScriptingParticleEffect(int bitmap, bool reversed);
-	friend bool move_particle(float frametime, particle* part);
-	friend bool render_particle(particle* part);
+	friend bool move_particle(float frametime, particle* part, SCP_vector<std::function<void()>>* deferred_effects);
+	friend bool can_drift(const particle& new_particle);
+	friend bool prepare_particle_render(const particle* part, particle_render_item& item);
 
 	SCP_string m_name; //!< The name of this effect
 
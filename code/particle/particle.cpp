@@ -10,6 +10,7 @@
 
 
 #include "bmpman/bmpman.h"
+#include "cmdline/cmdline.h"
 #include "decals/decals.h"
 #include "particle/particle.h"
 
@@ -27,14 +28,122 @@
 #include "tracing/tracing.h"
 #include "tracing/Monitor.h"
 #include "utils/Random.h"
+#include "utils/threading.h"
 #include "nebula/neb.h"
 #include "mission/missionparse.h"
 #include "mod_table/mod_table.h"
 
+namespace particle
+{
+	// How a particle is going to be drawn, as worked out by prepare_particle_render()
+	struct particle_render_item {
+		enum class kind : ubyte { BITMAP, LASER, DECAL };
+		enum class render_state : ubyte { SKIP, READY, ON_MAIN_THREAD };
+
+		render_state state = render_state::SKIP; // only used when preparing on the worker threads
+		kind type = kind::BITMAP;
+		int frame = -1;
+		vec3d pos;     // in world space, or relative to the object for decals
+		vec3d end_pos; // the other end of a laser, in world space
+		float radius = 0.0f;
+		float alpha = 0.0f;
+		float angle = 0.0f;
+		int objnum = -1;
+		bool decal_emissive = false;
+		bool decal_towards_center = false;
+	};
+}
+
 using namespace particle;
 
 namespace
 {
+	// Particles which just drift along in a straight line until they die of old age, which is what most explosion
+	// debris and smoke does. Their position, velocity and age are kept in separate arrays so that moving them is a
+	// loop over contiguous floats which the compiler can vectorize. Everything else about them is only needed for
+	// rendering and stays in a regular particle, whose position, velocity and age are not kept up to date.
+	struct drifting_particles {
+		SCP_vector<float> pos_x, pos_y, pos_z;
+		SCP_vector<float> vel_x, vel_y, vel_z;
+		SCP_vector<float> age, max_life;
+		SCP_vector<ubyte> looping;
+		SCP_vector<::particle::particle> rest;
+
+		size_t size() const { return rest.size(); }
+		bool empty() const { return rest.empty(); }
+
+		void clear()
+		{
+			for (auto array : { &pos_x, &pos_y, &pos_z, &vel_x, &vel_y, &vel_z, &age, &max_life }) {
+				array->clear();
+			}
+			looping.clear();
+			rest.clear();
+		}
+
+		void add(::particle::particle&& part)
+		{
+			pos_x.push_back(part.pos.xyz.x);
+			pos_y.push_back(part.pos.xyz.y);
+			pos_z.push_back(part.pos.xyz.z);
+			vel_x.push_back(part.velocity.xyz.x);
+			vel_y.push_back(part.velocity.xyz.y);
+			vel_z.push_back(part.velocity.xyz.z);
+			age.push_back(part.age);
+			max_life.push_back(part.max_life);
+			looping.push_back(part.looping ? 1 : 0);
+			rest.push_back(std::move(part));
+		}
+
+		// puts the particle back together for everything that works on whole particles
+		::particle::particle get(size_t i) const
+		{
+			::particle::particle part = rest[i];
+			part.pos = vm_vec_new(pos_x[i], pos_y[i], pos_z[i]);
+			part.velocity = vm_vec_new(vel_x[i], vel_y[i], vel_z[i]);
+			part.age = age[i];
+			part.max_life = max_life[i];
+			part.looping = looping[i] != 0;
+			return part;
+		}
+
+		// moves the last particle into the slot of the removed one
+		void remove(size_t i)
+		{
+			size_t last = size() - 1;
+			if (i != last) {
+				for (auto array : { &pos_x, &pos_y, &pos_z, &vel_x, &vel_y, &vel_z, &age, &max_life }) {
+					(*array)[i] = (*array)[last];
+				}
+				looping[i] = looping[last];
+				rest[i] = std::move(rest[last]);
+			}
+
+			for (auto array : { &pos_x, &pos_y, &pos_z, &vel_x, &vel_y, &vel_z, &age, &max_life }) {
+				array->pop_back();
+			}
+			looping.pop_back();
+			rest.pop_back();
+		}
+	};
+
+	drifting_particles Drifting_particles;
+
+	// How many particles one job takes care of when they are moved or rendered on the worker threads
+	const size_t Drifting_chunk_size = 4096;
+	const size_t Move_chunk_size = 256;
+	const size_t Render_chunk_size = 256;
+
+	enum class move_result : ubyte { KEEP, EXPIRED, ON_MAIN_THREAD };
+
+	// What moving particles on the worker threads left for the main thread: the result for every particle and the
+	// effects every chunk spawned, along with the index of the particle which spawned them. Kept around between frames
+	// so that their memory can be reused.
+	SCP_vector<move_result> Move_results;
+	SCP_vector<SCP_vector<std::pair<size_t, std::function<void()>>>> Move_chunks;
+
+	SCP_vector<::particle::particle_render_item> Render_items;
+
 	SCP_vector<::particle::particle> Particles;
 	SCP_vector<ParticlePtr> Persistent_particles;
 
@@ -128,10 +237,11 @@ namespace particle
 	{
 		Persistent_particles.clear();
 		Particles.clear();
+		Drifting_particles.clear();
 	}
 
 	size_t get_particle_count() {
-		return Particles.size() + Persistent_particles.size();
+		return Particles.size() + Persistent_particles.size() + Drifting_particles.size();
 	}
 
 	void page_in()
@@ -176,11 +286,25 @@ namespace particle
 		return false;
 	}
 
+	// Whether moving the particle never needs anything but its position, velocity and age
+	bool can_drift(const particle& new_particle) {
+		if (!new_particle.attachment.is_not_attached())
+			return false;
+
+		const auto& source_effect = new_particle.parent_effect.getParticleEffect();
+
+		return !source_effect.m_deathEffect.isValid() && !source_effect.m_light_source
+			&& !source_effect.m_lifetime_curves.has_curve(ParticleEffect::ParticleLifetimeCurvesOutput::VELOCITY_MULT);
+	}
+
 	void create(particle&& new_particle) {
 		if (maybe_cull_particle(new_particle))
 			return;
 
-		Particles.push_back(new_particle);
+		if (can_drift(new_particle))
+			Drifting_particles.add(std::move(new_particle));
+		else
+			Particles.push_back(new_particle);
 	}
 
 	// Creates a single particle. See the PARTICLE_?? defines for types.
@@ -212,9 +336,11 @@ namespace particle
 	 * @brief Moves a single particle
 	 * @param frametime The length of the current frame
 	 * @param part The particle to process for movement
+	 * @param deferred_effects If not null, the lights and effects the particle spawns are added to this instead of
+	 * being spawned right away, so that they can be spawned by the main thread later on
 	 * @return @c true if the particle has expired and should be removed, @c false otherwise
 	 */
-	bool move_particle(float frametime, particle* part) {
+	bool move_particle(float frametime, particle* part, SCP_vector<std::function<void()>>* deferred_effects) {
 		if (part->age == 0.0f)
 		{
 			part->age = 0.00001f;
@@ -244,6 +370,13 @@ namespace particle
 
 		const auto& source_effect = part->parent_effect.getParticleEffect();
 
+		auto spawn = [deferred_effects](std::function<void()> effect) {
+			if (deferred_effects)
+				deferred_effects->push_back(std::move(effect));
+			else
+				effect();
+		};
+
 		if (remove_particle)
 		{
 			if (source_effect.m_deathEffect.isValid()) {
@@ -255,9 +388,11 @@ namespace particle
 					vm_vector_2_matrix(&orient, &world_vel);
 				}
 
-				auto deathSource = ParticleManager::get()->createSource(source_effect.m_deathEffect);
-				deathSource->setHost(std::make_unique<EffectHostVector>(world_pos, orient, world_vel));
-				deathSource->finishCreation();
+				spawn([death_effect = source_effect.m_deathEffect, world_pos, orient, world_vel]() {
+					auto deathSource = ParticleManager::get()->createSource(death_effect);
+					deathSource->setHost(std::make_unique<EffectHostVector>(world_pos, orient, world_vel));
+					deathSource->finishCreation();
+				});
 			}
 
 			return true;
@@ -291,11 +426,11 @@ namespace particle
 
 			switch (light_source.light_source_mode) {
 			case ParticleEffect::LightInformation::LightSourceMode::POINT:
-				light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
+				spawn([=]() { light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius); });
 				break;
 			case ParticleEffect::LightInformation::LightSourceMode::TO_LAST_POS: {
 			vec3d p_prev_pos = part->attachment.local_last_pos_to_global(prev_pos);
-				light_add_tube(&p_prev_pos, &p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
+				spawn([=]() { light_add_tube(&p_prev_pos, &p_pos, light_radius, light_radius, intensity, r, g, b, source_radius); });
 			}
 			break;
 			case ParticleEffect::LightInformation::LightSourceMode::AS_PARTICLE:
@@ -304,10 +439,10 @@ namespace particle
 					vm_vec_normalize_safe(&p1);
 					p1 *= part->length * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LENGTH_MULT, curve_input);
 					p1 += p_pos;
-					light_add_tube(&p_pos, &p1, light_radius, light_radius, intensity, r, g, b, source_radius);
+					spawn([=]() { light_add_tube(&p_pos, &p1, light_radius, light_radius, intensity, r, g, b, source_radius); });
 				}
 				else {
-					light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
+					spawn([=]() { light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius); });
 				}
 				break;
 			case ParticleEffect::LightInformation::LightSourceMode::CONE: {
@@ -316,7 +451,7 @@ namespace particle
 				vec3d p1 = part->attachment.local_vel_to_global(part->velocity);
 				vm_vec_normalize_safe(&p1);
 
-				light_add_cone(&p_pos, &p1, cone_angle, cone_inner_angle, false, light_radius, light_radius, intensity, r, g, b, source_radius);
+				spawn([=]() { light_add_cone(&p_pos, &p1, cone_angle, cone_inner_angle, false, light_radius, light_radius, intensity, r, g, b, source_radius); });
 			}
 			break;
 			}
@@ -325,6 +460,135 @@ namespace particle
 		return false;
 	}
 
+	/**
+	 * @brief Moves all drifting particles, does the same as move_particle() for each of them
+	 * @param frametime The length of the current frame
+	 * @param threaded Whether to split the work across the worker threads
+	 */
+	static void move_drifting_particles(float frametime, bool threaded) {
+		auto& parts = Drifting_particles;
+		const size_t count = parts.size();
+
+		auto move_range = [&parts, frametime](size_t begin, size_t end) {
+			float* age = parts.age.data();
+			for (size_t i = begin; i < end; ++i) {
+				age[i] = (age[i] == 0.0f) ? 0.00001f : age[i] + frametime;
+			}
+
+			// particles which are about to be removed are moved as well, which doesn't matter
+			for (auto [pos, vel] : { std::make_pair(parts.pos_x.data(), parts.vel_x.data()),
+					std::make_pair(parts.pos_y.data(), parts.vel_y.data()),
+					std::make_pair(parts.pos_z.data(), parts.vel_z.data()) }) {
+				for (size_t i = begin; i < end; ++i) {
+					pos[i] += vel[i] * frametime;
+				}
+			}
+		};
+
+		if (threaded) {
+			threading::parallel_for(0, count, Drifting_chunk_size, move_range);
+		} else {
+			move_range(0, count);
+		}
+
+		for (size_t i = 0; i < parts.size();) {
+			// if the particle is looping it will never be removed due to age, and if max_life is 0 it renders at least once
+			if (parts.age[i] > parts.max_life[i] && !parts.looping[i] && ((parts.age[i] > frametime) || (parts.max_life[i] > 0.0f))) {
+				parts.remove(i);
+			} else {
+				++i;
+			}
+		}
+	}
+
+	/**
+	 * @brief Moves the particles of a container on the worker threads
+	 *
+	 * The particles are moved in chunks, and everything they spawn is collected per chunk. Afterwards, the main thread
+	 * spawns all of it and removes the expired particles, going through the particles in order. Particles whose curves
+	 * draw random numbers are moved by the main thread at that point as well. So the result only depends on the order
+	 * of the particles, and not on the number of threads or how the chunks were scheduled.
+	 *
+	 * @param frametime The length of the current frame
+	 * @param parts The particles to move
+	 * @param get_particle Returns the particle for an element of the container
+	 */
+	template <typename Container, typename GetParticle>
+	static void move_particles_threaded(float frametime, Container& parts, GetParticle get_particle)
+	{
+		const size_t count = parts.size();
+		const size_t num_chunks = (count + Move_chunk_size - 1) / Move_chunk_size;
+
+		Move_results.assign(count, move_result::KEEP);
+		if (Move_chunks.size() < num_chunks) {
+			Move_chunks.resize(num_chunks);
+		}
+
+		{
+			TRACE_SCOPE(tracing::ParticlesMoveThreaded);
+
+			threading::parallel_for(0, num_chunks, 1, [frametime, count, &parts, &get_particle](size_t chunk_begin, size_t chunk_end) {
+				SCP_vector<std::function<void()>> effects;
+
+				for (size_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+					auto& chunk_effects = Move_chunks[chunk];
+					chunk_effects.clear();
+
+					const size_t end = std::min((chunk + 1) * Move_chunk_size, count);
+					for (size_t i = chunk * Move_chunk_size; i < end; ++i) {
+						particle* part = get_particle(parts[i]);
+
+						if (part->parent_effect.getParticleEffect().m_lifetime_curves.has_random_curves()) {
+							Move_results[i] = move_result::ON_MAIN_THREAD;
+							continue;
+						}
+
+						if (move_particle(frametime, part, &effects)) {
+							Move_results[i] = move_result::EXPIRED;
+						}
+
+						for (auto& effect : effects) {
+							chunk_effects.emplace_back(i, std::move(effect));
+						}
+						effects.clear();
+					}
+				}
+			});
+		}
+
+		TRACE_SCOPE(tracing::ParticlesMergeMoved);
+
+		for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+			const auto& chunk_effects = Move_chunks[chunk];
+			auto effect = chunk_effects.begin();
+
+			const size_t end = std::min((chunk + 1) * Move_chunk_size, count);
+			for (size_t i = chunk * Move_chunk_size; i < end; ++i) {
+				if (Move_results[i] == move_result::ON_MAIN_THREAD) {
+					Move_results[i] = move_particle(frametime, get_particle(parts[i]), nullptr) ? move_result::EXPIRED : move_result::KEEP;
+					continue;
+				}
+
+				for (; effect != chunk_effects.end() && effect->first == i; ++effect) {
+					effect->second();
+				}
+			}
+		}
+
+		size_t kept = 0;
+		for (size_t i = 0; i < count; ++i) {
+			if (Move_results[i] == move_result::EXPIRED) {
+				continue;
+			}
+
+			if (kept != i) {
+				parts[kept] = std::move(parts[i]);
+			}
+			++kept;
+		}
+		parts.erase(parts.begin() + kept, parts.begin() + count);
+	}
+
 	void move_all(float frametime)
 	{
 		TRACE_SCOPE(tracing::ParticlesMoveAll);
@@ -332,13 +596,23 @@ namespace particle
 		if (!Particles_enabled)
 			return;
 
-		if (Persistent_particles.empty() && Particles.empty())
+		if (Persistent_particles.empty() && Particles.empty() && Drifting_particles.empty())
 			return;
 
+		const bool threaded = Cmdline_threaded_particles && threading::is_threading();
+
+		move_drifting_particles(frametime, threaded);
+
+		if (threaded) {
+			move_particles_threaded(frametime, Persistent_particles, [](ParticlePtr& part) { return part.get(); });
+			move_particles_threaded(frametime, Particles, [](particle& part) { return &part; });
+			return;
+		}
+
 		for (auto p = Persistent_particles.begin(); p != Persistent_particles.end();)
 		{
 			ParticlePtr part = *p;
-			if (move_particle(frametime, part.get()))
+			if (move_particle(frametime, part.get(), nullptr))
 			{
 				// if we're sitting on the very last particle, popping-back will invalidate the iterator!
 				if (p + 1 == Persistent_particles.end())
@@ -358,7 +632,7 @@ namespace particle
 
 		for (auto p = Particles.begin(); p != Particles.end();)
 		{
-			if (move_particle(frametime, &(*p)))
+			if (move_particle(frametime, &(*p), nullptr))
 			{
 				// if we're sitting on the very last particle, popping-back will invalidate the iterator!
 				if (p + 1 == Particles.end())
@@ -383,14 +657,20 @@ namespace particle
 		// kill all active particles
 		Particles.clear();
 		Persistent_particles.clear();
+		Drifting_particles.clear();
 	}
 
 	/**
-	 * @brief Renders a single particle
+	 * @brief Works out how a single particle needs to be drawn
+	 *
+	 * This only looks at the particle and the current view, so it can be done on the worker threads for any particle
+	 * whose curves don't draw random numbers.
+	 *
 	 * @param part The particle to render
-	 * @return @c true if the particle has been added to the rendering batch (notably, this only includes main-render pass, alternative dispatch through decals is not true), @c false otherwise
+	 * @param item Where to put everything submit_particle_render() needs to know
+	 * @return @c true if the particle needs to be submitted, @c false if it can't be seen
 	 */
-	bool render_particle(particle* part) {
+	bool prepare_particle_render(const particle* part, particle_render_item& item) {
 		// skip back-facing particles (ripped from fullneb code)
 		// Wanderer - add support for attached particles
 		vec3d p_pos = part->attachment.local_pos_to_global(part->pos);
@@ -428,7 +708,7 @@ namespace particle
 		framenum = part->bitmap;
 		Assert( (cur_frame < part->nframes) || (part->nframes == 0 && cur_frame == 0) );
 
-		int actual_frame = cur_frame + framenum;
+		item.frame = cur_frame + framenum;
 
 		if (source_effect.m_renderAsDecal) {
 			if (!decals::decalSystemActive()) {
@@ -441,41 +721,19 @@ namespace particle
 				return false;
 			}
 
-			float radius = part->radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::RADIUS_MULT, curve_input);
-
-			decals::Decal decalInfo;
-
-			if (source_effect.m_decalEmissive) {
-				decalInfo.definition_handle = std::tuple(-1, actual_frame, -1);
-			} else {
-				decalInfo.definition_handle = std::tuple(actual_frame, -1, -1);
-			}
-
-			decalInfo.object        = &Objects[obj->objnum];
-			decalInfo.submodel      = -1;
-			decalInfo.creation_time = f2fl(Missiontime);
-			decalInfo.lifetime      = 1.0f;
-			decalInfo.position      = part->pos;
-			decalInfo.scale         = {{{ radius, radius, radius }}};
-			decalInfo.orig_obj_type = OBJ_SHIP;
-
-			switch (source_effect.m_decalOrientationMode) {
-			case ParticleEffect::DecalOrientationMode::TOWARDS_CENTER:
-				vm_vector_2_matrix(&decalInfo.orientation, &part->pos, nullptr, nullptr);
-				break;
-			default:
-				decalInfo.orientation = vmd_identity_matrix;
-				break;
-			}
-
-			decals::addSingleFrameDecal(std::move(decalInfo));
-			return false;
+			item.type = particle_render_item::kind::DECAL;
+			item.pos = part->pos;
+			item.radius = part->radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::RADIUS_MULT, curve_input);
+			item.objnum = obj->objnum;
+			item.decal_emissive = source_effect.m_decalEmissive;
+			item.decal_towards_center = source_effect.m_decalOrientationMode == ParticleEffect::DecalOrientationMode::TOWARDS_CENTER;
+			return true;
 		}
 
-		vec3d p1 = vmd_x_vector;
+		item.pos = p_pos;
 
 		if (part_has_length) {
-			p1 = part->attachment.local_vel_to_global(part->velocity);
+			vec3d p1 = part->attachment.local_vel_to_global(part->velocity);
 			vm_vec_normalize_safe(&p1);
 			p1 *= part->length * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LENGTH_MULT, curve_input);
 			p1 += p_pos;
@@ -486,17 +744,66 @@ namespace particle
 			if (dot0 <= 0.0f && dot1 <= 0.0f) {
 				return false;
 			}
+
+			item.type = particle_render_item::kind::LASER;
+			item.end_pos = p1;
+		} else {
+			item.type = particle_render_item::kind::BITMAP;
 		}
 
 		// calculate the alpha to draw at
-		auto alpha = get_current_alpha(&p_pos, part->radius);
+		item.alpha = get_current_alpha(&p_pos, part->radius);
 
 		// if it's transparent then just skip it
-		if (alpha <= 0.0f)
+		if (item.alpha <= 0.0f)
 		{
 			return false;
 		}
 
+		item.radius = part->radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::RADIUS_MULT, curve_input);
+
+		// it will subtract Physics_viewer_bank, so without the flag we counter that and make it screen-aligned again
+		item.angle = part->use_angle ? part->angle : Physics_viewer_bank;
+
+		return true;
+	}
+
+	/**
+	 * @brief Hands a particle prepared by prepare_particle_render() over to the batching or decal code
+	 * @param item The prepared particle
+	 * @return @c true if the particle has been added to the rendering batch (notably, this only includes main-render pass, alternative dispatch through decals is not true), @c false otherwise
+	 */
+	static bool submit_particle_render(const particle_render_item& item) {
+		if (item.type == particle_render_item::kind::DECAL) {
+			decals::Decal decalInfo;
+
+			if (item.decal_emissive) {
+				decalInfo.definition_handle = std::tuple(-1, item.frame, -1);
+			} else {
+				decalInfo.definition_handle = std::tuple(item.frame, -1, -1);
+			}
+
+			decalInfo.object        = &Objects[item.objnum];
+			decalInfo.submodel      = -1;
+			decalInfo.creation_time = f2fl(Missiontime);
+			decalInfo.lifetime      = 1.0f;
+			decalInfo.position      = item.pos;
+			decalInfo.scale         = {{{ item.radius, item.radius, item.radius }}};
+			decalInfo.orig_obj_type = OBJ_SHIP;
+
+			if (item.decal_towards_center) {
+				vm_vector_2_matrix(&decalInfo.orientation, &item.pos, nullptr, nullptr);
+			} else {
+				decalInfo.orientation = vmd_identity_matrix;
+			}
+
+			decals::addSingleFrameDecal(std::move(decalInfo));
+			return false;
+		}
+
+		const bool part_has_length = item.type == particle_render_item::kind::LASER;
+
+		vec3d p_pos = item.pos;
 		vertex pos;
 		auto flags = g3_rotate_vertex(&pos, &p_pos);
 
@@ -504,7 +811,7 @@ namespace particle
 		{
 			if (part_has_length) {
 				vertex pos2;
-				auto flags2 = g3_rotate_vertex(&pos2, &p1);
+				auto flags2 = g3_rotate_vertex(&pos2, &item.end_pos);
 				if (flags & flags2) {
 					return false;
 				}
@@ -515,20 +822,92 @@ namespace particle
 
 		g3_transfer_vertex(&pos, &p_pos);
 
-		float radius = part->radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::RADIUS_MULT, curve_input);
-
 		if (part_has_length) {
-			vec3d p0 = p_pos;
-			batching_add_laser(actual_frame, &p0, radius, &p1, radius);
+			batching_add_laser(item.frame, &p_pos, item.radius, &item.end_pos, item.radius);
 		}
 		else {
-			// it will subtract Physics_viewer_bank, so without the flag we counter that and make it screen-aligned again
-			batching_add_volume_bitmap_rotated(actual_frame, &pos, part->use_angle ? part->angle : Physics_viewer_bank, radius, alpha);
+			batching_add_volume_bitmap_rotated(item.frame, &pos, item.angle, item.radius, item.alpha);
 		}
 
 		return true;
 	}
 
+	/**
+	 * @brief Renders a single particle
+	 * @param part The particle to render
+	 * @return @c true if the particle has been added to the rendering batch (notably, this only includes main-render pass, alternative dispatch through decals is not true), @c false otherwise
+	 */
+	static bool render_particle(const particle* part) {
+		particle_render_item item;
+		return prepare_particle_render(part, item) && submit_particle_render(item);
+	}
+
+	/**
+	 * @brief Renders all particles, preparing them on the worker threads
+	 *
+	 * The particles are submitted by the main thread in the same order as render_all() goes through them, so the
+	 * batches end up the same as without threads.
+	 */
+	static void render_all_threaded()
+	{
+		const size_t num_persistent = Persistent_particles.size();
+		const size_t num_regular = Particles.size();
+		const size_t count = num_persistent + num_regular + Drifting_particles.size();
+
+		Render_items.resize(count);
+
+		{
+			TRACE_SCOPE(tracing::ParticlesPrepareRender);
+
+			threading::parallel_for(0, count, Render_chunk_size, [num_persistent, num_regular](size_t begin, size_t end) {
+				auto prepare = [](const particle* part, particle_render_item& item) {
+					if (part->parent_effect.getParticleEffect().m_lifetime_curves.has_random_curves()) {
+						item.state = particle_render_item::render_state::ON_MAIN_THREAD;
+					} else if (prepare_particle_render(part, item)) {
+						item.state = particle_render_item::render_state::READY;
+					} else {
+						item.state = particle_render_item::render_state::SKIP;
+					}
+				};
+
+				for (size_t i = begin; i < end; ++i) {
+					if (i < num_persistent) {
+						prepare(Persistent_particles[i].get(), Render_items[i]);
+					} else if (i < num_persistent + num_regular) {
+						prepare(&Particles[i - num_persistent], Render_items[i]);
+					} else {
+						auto part = Drifting_particles.get(i - num_persistent - num_regular);
+						prepare(&part, Render_items[i]);
+					}
+				}
+			});
+		}
+
+		TRACE_SCOPE(tracing::ParticlesSubmitRender);
+
+		for (size_t i = 0; i < count; ++i) {
+			const auto& item = Render_items[i];
+
+			switch (item.state) {
+			case particle_render_item::render_state::READY:
+				submit_particle_render(item);
+				break;
+			case particle_render_item::render_state::ON_MAIN_THREAD:
+				if (i < num_persistent) {
+					render_particle(Persistent_particles[i].get());
+				} else if (i < num_persistent + num_regular) {
+					render_particle(&Particles[i - num_persistent]);
+				} else {
+					auto part = Drifting_particles.get(i - num_persistent - num_regular);
+					render_particle(&part);
+				}
+				break;
+			case particle_render_item::render_state::SKIP:
+				break;
+			}
+		}
+	}
+
 	void render_all()
 	{
 		GR_DEBUG_SCOPE("Render Particles");
@@ -537,8 +916,13 @@ namespace particle
 		if (!Particles_enabled)
 			return;
 
-		if (Persistent_particles.empty() && Particles.empty())
+		if (Persistent_particles.empty() && Particles.empty() && Drifting_particles.empty())
+			return;
+
+		if (Cmdline_threaded_particles && threading::is_threading()) {
+			render_all_threaded();
 			return;
+		}
 
 		for (auto& part : Persistent_particles) {
 			render_particle(part.get());
@@ -548,5 +932,10 @@ namespace particle
 			render_particle(&part);
 		}
 
+		for (size_t i = 0; i < Drifting_particles.size(); ++i) {
+			auto part = Drifting_particles.get(i);
+			render_particle(&part);
+		}
+
 	}
 }
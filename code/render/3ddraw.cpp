@@ -1334,7 +1334,7 @@ void flash_ball::parse_bsp(int offset, ubyte *bsp_data){
 	}
 }
 
-extern const ubyte* Macro_ubyte_bounds;
+extern thread_local const ubyte* Macro_ubyte_bounds;
 
 void flash_ball::initialize(ubyte *bsp_data, int bsp_data_size, float min_ray_width, float max_ray_width, const vec3d* dir, const vec3d* pcenter, float outer, float inner, ubyte max_r, ubyte max_g, ubyte max_b, ubyte min_r, ubyte min_g, ubyte min_b)
 {
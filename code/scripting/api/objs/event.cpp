@@ -3,6 +3,7 @@
 #include "scripting/ade_args.h"
 #include "scripting/ade.h"
 #include "mission/missiongoals.h"
+#include "parse/sexp.h"
 
 namespace scripting::api
 {
@@ -80,6 +81,7 @@ ADE_VIRTVAR(Interval, l_Event, "number", "Time for event to repeat (in seconds)"
 
 	if (ADE_SETTING_VAR) {
 		mep->interval = newinterval;
+		sexp_input_changed(SEXP_INPUT_EVENTS);
 	}
 
 	return ade_set_args(L, "i", mep->interval);
@@ -99,6 +101,7 @@ ADE_VIRTVAR(ObjectCount, l_Event, "number", "Number of objects left for event",
 
 	if (ADE_SETTING_VAR) {
 		mep->count = newobject;
+		mep->input_stamp = 0;
 	}
 
 	return ade_set_args(L, "i", mep->count);
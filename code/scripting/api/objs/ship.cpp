@@ -359,6 +359,7 @@ ADE_VIRTVAR(Name, l_Ship, "string", "Ship name. This is the actual name of the s
 		auto len = sizeof(shipp->ship_name);
 		strncpy(shipp->ship_name, s, len);
 		shipp->ship_name[len - 1] = 0;
+		ship_name_changed(objh->objp()->instance);
 	}
 
 	return ade_set_args(L, "s", shipp->ship_name);
@@ -156,6 +156,7 @@ ADE_VIRTVAR(Name, l_Shipclass, "string", "Ship class name", "string", "Ship clas
 		auto len = sizeof(Ship_info[idx].name);
 		strncpy(Ship_info[idx].name, s, len);
 		Ship_info[idx].name[len - 1] = 0;
+		ship_info_name_changed(idx);
 	}
 
 	return ade_set_args(L, "s", Ship_info[idx].name);
@@ -29,6 +29,7 @@ ADE_VIRTVAR(Name, l_Shiptype, "string", "Ship type name", "string", "Ship type n
 		auto len = sizeof(Ship_types[idx].name);
 		strncpy(Ship_types[idx].name, s, len);
 		Ship_types[idx].name[len - 1] = 0;
+		ship_type_name_changed(idx);
 	}
 
 	return ade_set_args(L, "s", Ship_types[idx].name);
@@ -176,6 +176,7 @@ ADE_VIRTVAR(Orientation, l_Subsystem, "orientation", "Orientation of subobject o
 
 		smi->canonical_prev_orient = smi->canonical_orient;
 		smi->canonical_orient = *mh->GetMatrix();
+		submodel_instance_transform_changed(smi);
 
 		float angle = 0.0f;
 		vm_closest_angle_to_matrix(&smi->canonical_orient, &sm->rotation_axis, &angle);
@@ -205,6 +206,7 @@ ADE_VIRTVAR(GunOrientation, l_Subsystem, "orientation", "Orientation of turret g
 	{
 		smi->canonical_prev_orient = smi->canonical_orient;
 		smi->canonical_orient = *mh->GetMatrix();
+		submodel_instance_transform_changed(smi);
 	}
 
 	return ade_set_args(L, "o", l_Matrix.Set(matrix_h(&smi->canonical_orient)));
@@ -233,6 +235,7 @@ ADE_VIRTVAR(TranslationOffset,
 	{
 		smi->canonical_prev_offset = smi->canonical_offset;
 		smi->canonical_offset = *vec;
+		submodel_instance_transform_changed(smi);
 
 		smi->cur_offset = vm_vec_mag(vec);
 	}
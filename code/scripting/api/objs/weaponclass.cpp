@@ -60,6 +60,7 @@ ADE_VIRTVAR(Name, l_Weaponclass, "string", "Weapon class name. This is the possi
 		auto len = sizeof(Weapon_info[idx].name);
 		strncpy(Weapon_info[idx].name, s, len);
 		Weapon_info[idx].name[len - 1] = 0;
+		weapon_info_name_changed(idx);
 	}
 
 	return ade_set_args(L, "s", Weapon_info[idx].name);
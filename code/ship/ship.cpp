@@ -64,10 +64,12 @@
 #include "object/objcollide.h"
 #include "object/object.h"
 #include "object/objectdock.h"
+#include "object/objectgrid.h"
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
 #include "object/waypoint.h"
 #include "parse/parselo.h"
+#include "parse/sexp.h"
 #include "particle/ParticleEffect.h"
 #include "particle/volumes/LegacyAACuboidVolume.h"
 #include "scripting/hook_api.h"
@@ -90,6 +92,7 @@
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
 #include "utils/Random.h"
+#include "utils/name_index.h"
 #include "utils/string_utils.h"
 #include "weapon/beam.h"
 #include "weapon/corkscrew.h"
@@ -232,6 +235,13 @@ ship_info* ship_registry_entry::sip() const
 SCP_vector<ship_registry_entry> Ship_registry;
 SCP_unordered_map<SCP_string, int, SCP_string_lcase_hash, SCP_string_lcase_equal_to> Ship_registry_map;
 
+// the names of all ships which currently have an object, for ship_name_lookup()
+static util::name_index<> Ship_name_index;
+
+// the names of the ship classes and ship types, brought up to date whenever they are looked up
+static util::name_index<> Ship_info_name_index;
+static util::name_index<> Ship_type_name_index;
+
 int ship_registry_get_index(const char *name)
 {
 	auto ship_it = Ship_registry_map.find(name);
@@ -824,6 +834,63 @@ static void ship_obj_list_init()
 	}
 }
 
+// All ships in Ship_obj_list order for range queries, see ship_grid_query()
+static object_grid Ship_grid(2000.0f);
+static bool Ship_grid_valid = false;
+
+// how far any ship may have moved since the grid was built
+static float Ship_grid_margin = 0.0f;
+
+static void ship_grid_add(int objnum)
+{
+	auto objp = &Objects[objnum];
+
+	// twice the radius covers the bounding box of the model, which the AI measures the distance to for big ships
+	Ship_grid.add(objnum, objp->pos, objp->radius * 2.0f);
+}
+
+void ship_grid_rebuild(float frametime)
+{
+	float max_speed = 0.0f;
+
+	Ship_grid.clear();
+
+	for (auto so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+		auto objp = &Objects[so->objnum];
+
+		ship_grid_add(so->objnum);
+
+		max_speed = std::max(max_speed, vm_vec_mag(&objp->phys_info.vel));
+		max_speed = std::max(max_speed, vm_vec_mag(&objp->phys_info.max_vel));
+		max_speed = std::max(max_speed, vm_vec_mag(&objp->phys_info.afterburner_max_vel));
+	}
+
+	// everything moves once more before the next rebuild, leave some room for ships speeding up along the way
+	Ship_grid_margin = 2.0f * max_speed * frametime + 1.0f;
+	Ship_grid_valid = true;
+}
+
+void ship_grid_invalidate()
+{
+	Ship_grid.clear();
+	Ship_grid_valid = false;
+}
+
+bool ship_grid_query(const vec3d *center, float range, SCP_vector<int> &objnums)
+{
+	objnums.clear();
+
+	if (!Ship_grid_valid)
+		return false;
+
+	Ship_grid.query(*center, range + Ship_grid_margin, [&objnums](int objnum) {
+		if (Objects[objnum].type == OBJ_SHIP)
+			objnums.push_back(objnum);
+	});
+
+	return true;
+}
+
 /**
  * Function to add a node to the Ship_obj_list.  Only
  * called from ::ship_create()
@@ -846,6 +913,10 @@ static int ship_obj_list_add(int objnum)
 	list_append(&Ship_obj_list, &Ship_objs[i]);
 	Ship_objs[i].flags |= SHIP_OBJ_USED;
 
+	// ships created in the middle of a frame still need to be found until the grid is rebuilt
+	if (Ship_grid_valid)
+		ship_grid_add(objnum);
+
 	return i;
 }
 
@@ -6476,6 +6547,9 @@ void ship_level_init()
 		Ships[i].ship_name[0] = '\0';
 		Ships[i].objnum = -1;
 	}
+	Ship_name_index.clear();
+
+	ship_grid_invalidate();
 
 	Num_wings = 0;
 	for (i = 0; i < MAX_WINGS; i++ )
@@ -6546,6 +6620,8 @@ void ship_level_close()
 	}
 
 	ship_close_cockpit_displays(Player_ship);
+
+	ship_grid_invalidate();
 }
 
 /**
@@ -8616,6 +8692,7 @@ void ship_delete( object * obj )
 	// on ship back to the free list for other ships to use.
 	ship_subsystems_delete(&Ships[num]);
 	shipp->objnum = -1;
+	Ship_name_index.remove(num);
 
 	animation::ModelAnimationSet::stopAnimations(model_get_instance(shipp->model_instance_num));
 
@@ -8727,6 +8804,9 @@ int wing_determine_team(const wing *wingp)
  */
 void wing_maybe_cleanup( wing *wingp, int team )
 {
+	// the wing lost a ship or a wave, either way its directives may have changed
+	sexp_input_changed(SEXP_INPUT_SHIPS);
+
 	// not if the wing is already gone or has not yet arrived
 	if (wingp->flags[Ship::Wing_Flags::Gone] || wingp->total_arrived_count == 0)
 		return;
@@ -8920,6 +9000,7 @@ void ship_cleanup(int shipnum, int cleanup_mode)
 	auto entry = &Ship_registry[entry_index];
 	entry->status = ShipStatus::EXITED;
 	entry->cleanup_mode = cleanup_mode;
+	sexp_input_changed(SEXP_INPUT_SHIPS);
 
 	// add the information to the exited ship list
 	switch (cleanup_mode) {
@@ -11343,6 +11424,7 @@ int ship_create(matrix* orient, vec3d* pos, int ship_type, const char* ship_name
 
 	ship_set_default_weapons(shipp, sip);	//	Moved up here because ship_set requires that weapon info be valid.  MK, 4/28/98
 	ship_set(shipnum, objnum, ship_type);
+	Ship_name_index.set(shipnum, shipp->ship_name);
 
 	for (auto& fpu : shipp->weapons.primary_firepoint_next_to_fire_index) {
 		fpu = 0;
@@ -11451,6 +11533,7 @@ int ship_create(matrix* orient, vec3d* pos, int ship_type, const char* ship_name
 		entry->objnum = objnum;
 		entry->shipnum = shipnum;
 	}
+	sexp_input_changed(SEXP_INPUT_SHIPS);
 	
 	// Start up stracking for this ship in multi.
 	if (Game_mode & (GM_MULTIPLAYER)) {
@@ -15002,6 +15085,8 @@ void wing_bash_ship_name(ship *shipp, const wing *wingp, int ordinal, bool reset
 {
 	// always update the real name
 	wing_bash_ship_name(shipp->ship_name, wingp->name, ordinal);
+	if (shipp->objnum >= 0)
+		ship_name_changed(SHIP_INDEX(shipp));
 
 	// also set up the display name if we have one
 	// (In the unlikely edge case where the ship already has a display name for some reason, it will be overwritten.
@@ -15094,11 +15179,16 @@ static int ship_info_lookup_sub(const char *token)
 {
 	Assertion(token != nullptr, "NULL token passed to ship_info_lookup_sub");
 
-	for (auto it = Ship_info.cbegin(); it != Ship_info.cend(); ++it)
-		if (!stricmp(token, it->name))
-			return (int)std::distance(Ship_info.cbegin(), it);
+	Ship_info_name_index.update(ship_info_size(), [](int i) { return Ship_info[i].name; });
 
-	return -1;
+	return Ship_info_name_index.find(token, [token](int i) { return !stricmp(token, Ship_info[i].name); });
+}
+
+void ship_info_name_changed(int ship_info_index)
+{
+	Assertion(ship_info_index >= 0 && ship_info_index < ship_info_size(), "Invalid ship class %d passed to ship_info_name_changed", ship_info_index);
+
+	Ship_info_name_index.set(ship_info_index, Ship_info[ship_info_index].name);
 }
 
 /**
@@ -15258,31 +15348,53 @@ int ship_name_lookup(const char *name, int inc_players)
 {
 	Assertion(name != nullptr, "NULL name passed to ship_name_lookup");
 
-	for (int i=0; i<MAX_SHIPS; i++){
+	auto is_match = [name, inc_players](int i) {
 		if (Ships[i].objnum >= 0){
 			if (Objects[Ships[i].objnum].type == OBJ_SHIP || (Objects[Ships[i].objnum].type == OBJ_START && inc_players)){
 				if (!stricmp(name, Ships[i].ship_name)){
-					return i;
+					return true;
 				}
 			}
 		}
+		return false;
+	};
+
+	// FRED renames ships all over the place, so only trust the index in the game
+	if (!Fred_running)
+		return Ship_name_index.find(name, is_match);
+
+	for (int i=0; i<MAX_SHIPS; i++){
+		if (is_match(i)){
+			return i;
+		}
 	}
 	
 	// couldn't find it
 	return -1;
 }
 
+void ship_name_changed(int shipnum)
+{
+	Assertion(shipnum >= 0 && shipnum < MAX_SHIPS, "Invalid ship number %d passed to ship_name_changed", shipnum);
+
+	if (Ships[shipnum].objnum >= 0)
+		Ship_name_index.set(shipnum, Ships[shipnum].ship_name);
+}
+
 int ship_type_name_lookup_sub(const char *name)
 {
 	Assertion(name != nullptr, "NULL name passed to ship_type_name_lookup");
 
-	//Look through Ship_types array
-	for (size_t idx = 0; idx < Ship_types.size(); ++idx)
-		if (!stricmp(name, Ship_types[idx].name))
-			return (int)idx;
+	Ship_type_name_index.update(static_cast<int>(Ship_types.size()), [](int i) { return Ship_types[i].name; });
 
-	// couldn't find it
-	return -1;
+	return Ship_type_name_index.find(name, [name](int i) { return !stricmp(name, Ship_types[i].name); });
+}
+
+void ship_type_name_changed(int ship_type_index)
+{
+	Assertion(ship_type_index >= 0 && ship_type_index < (int)Ship_types.size(), "Invalid ship type %d passed to ship_type_name_changed", ship_type_index);
+
+	Ship_type_name_index.set(ship_type_index, Ship_types[ship_type_index].name);
 }
 
 int ship_type_name_lookup(const char *name)
@@ -21637,6 +21749,7 @@ void ship_render_weapon_models(model_render_params *ship_render_info, model_draw
 					angles angs = vmd_zero_angles;
 					angs.b = shipp->primary_rotate_ang[i];
 					vm_angles_2_matrix(&pmi->submodel[mn].canonical_orient, &angs);
+					submodel_instance_transform_changed(&pmi->submodel[mn]);
 				}
 			}
 		}
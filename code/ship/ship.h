@@ -1791,6 +1791,16 @@ extern void ship_delete( object * objp );
 extern int ship_check_collision_fast( object * obj, object * other_obj, vec3d * hitpos );
 extern int ship_get_num_ships();
 
+// Spatial index of all ships, rebuilt by obj_move_all() once per frame. Ships created in the meantime are added
+// right away, ships that died are left out of the results.
+extern void ship_grid_rebuild(float frametime);
+extern void ship_grid_invalidate();
+
+// Fills objnums with every ship which may be within range of center, in Ship_obj_list order. This is a superset,
+// callers still have to check the actual distance. Returns false if the index isn't available (e.g. before the first
+// frame of a mission), in which case callers have to go through Ship_obj_list themselves.
+extern bool ship_grid_query(const vec3d *center, float range, SCP_vector<int> &objnums);
+
 #define SHIP_VANISHED               (1<<0)
 #define SHIP_DESTROYED              (1<<1)
 #define SHIP_DEPARTED_WARP          (1<<2)
@@ -1851,7 +1861,10 @@ extern int get_subsystem_pos(vec3d *pos, const object *objp, const ship_subsys *
 
 extern int ship_info_lookup(const char *name);
 extern int ship_name_lookup(const char *name, int inc_players = 0);	// returns the index into Ship array of name
+extern void ship_name_changed(int shipnum);	// must be called whenever the name of an existing ship is changed
 extern int ship_type_name_lookup(const char *name);
+extern void ship_info_name_changed(int ship_info_index);	// must be called whenever a ship class is renamed after parsing
+extern void ship_type_name_changed(int ship_type_index);	// likewise for ship types
 
 inline int ship_info_size()
 {
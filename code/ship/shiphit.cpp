@@ -41,6 +41,7 @@
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
 #include "parse/parselo.h"
+#include "parse/sexp.h"
 #include "scripting/hook_api.h"
 #include "scripting/global_hooks.h"
 #include "scripting/api/objs/subsystem.h"
@@ -2084,6 +2085,7 @@ void ship_hit_kill(object *ship_objp, object *other_obj, const vec3d *hitpos, fl
 	// Goober5000 - since we added a mission log entry above, immediately set the status.  For destruction, ship_cleanup isn't called until a little bit later
 	auto entry = &Ship_registry[Ship_registry_map[sp->ship_name]];
 	entry->status = ShipStatus::DEATH_ROLL;
+	sexp_input_changed(SEXP_INPUT_SHIPS);
 
 	ship_generic_kill_stuff( ship_objp, percent_killed );
 
@@ -966,6 +966,8 @@ add_file_folder("mod_table"
 # Model files
 add_file_folder("Model"
 	model/model.h
+	model/modelcache.h
+	model/modelcache.cpp
 	model/modelcollide.cpp
 	model/modelinterp.cpp
 	model/modelread.cpp
@@ -1100,8 +1102,12 @@ ENDIF(WIN32)
 
 # Object files
 add_file_folder("Object"
+	object/collidebroadphase.cpp
+	object/collidebroadphase.h
 	object/collidedebrisship.cpp
 	object/collidedebrisweapon.cpp
+	object/collidepaircache.cpp
+	object/collidepaircache.h
 	object/collideshipship.cpp
 	object/collideshipweapon.cpp
 	object/collideweaponweapon.cpp
@@ -1113,6 +1119,8 @@ add_file_folder("Object"
 	object/object.h
 	object/objectdock.cpp
 	object/objectdock.h
+	object/objectgrid.cpp
+	object/objectgrid.h
 	object/objectshield.cpp
 	object/objectshield.h
 	object/objectsnd.cpp
@@ -1184,6 +1192,8 @@ add_file_folder("Parse"
 	parse/sexp.h
 	parse/sexp_container.cpp
 	parse/sexp_container.h
+	parse/textscan.cpp
+	parse/textscan.h
 )
 
 add_file_folder("Parse\\\\SEXP"
@@ -1829,6 +1839,7 @@ add_file_folder("Utils"
 	utils/id.h
 	utils/join_string.h
 	utils/modular_curves.h
+	utils/name_index.h
 	utils/Random.cpp
 	utils/Random.h
 	utils/RandomRange.h
@@ -78,9 +78,17 @@ Category NonrepeatingEvents("Nonrepeating events", false);
 
 Category ParticlesRenderAll("Render particles", true);
 Category ParticlesMoveAll("Move particles", false);
+Category ParticlesMoveThreaded("Move particles on workers", false);
+Category ParticlesMergeMoved("Merge moved particles", false);
+Category ParticlesPrepareRender("Prepare particle batches", false);
+Category ParticlesSubmitRender("Submit particle batches", false);
 
 Category EnvironmentMapping("Environment Mapping", true);
 Category BuildShadowMap("Build Shadow Map", true);
+Category ShadowMapCull("Cull shadow casters", false);
+Category ShadowMapPrepareDraws("Prepare shadow draws", false);
+Category ShadowMapSubmitDraws("Submit shadow draws", false);
+Category ShadowMapRenderDraws("Render shadow draws", true);
 Category RenderScene("Render scene", true);
 Category RenderTrails("Render trails", true);
 Category MoveObjects("Move Objects", false);
@@ -131,6 +139,7 @@ Category ModelParseBSPTree("Parse BSP tree", false);
 Category ModelConfigureVertexBuffers("Model configure vertex buffers", false);
 Category ModelCreateTransparencyIndexBuffer("Model create transparency buffer", false);
 Category ModelCreateDetailIndexBuffers("Model create detail index buffers", false);
+Category ModelFinishDeferredLoads("Finish models loaded while paging in", false);
 
 Category PreloadMissionSounds("Preload mission sounds", false);
 Category LoadSound("Load Sound", false);
@@ -138,6 +147,7 @@ Category LoadSound("Load Sound", false);
 Category LevelPageIn("Level page in", false);
 Category PageInStop("Finish page in", false);
 Category PageInSingleBitmap("Page in single bitmap", false);
+Category PageInDecodeBitmaps("Decode bitmaps", false);
 Category ShipPageIn("Ship page in", false);
 Category WeaponPageIn("Weapon page in", false);
 
@@ -91,9 +91,17 @@ extern Category NonrepeatingEvents;
 
 extern Category ParticlesRenderAll;
 extern Category ParticlesMoveAll;
+extern Category ParticlesMoveThreaded;
+extern Category ParticlesMergeMoved;
+extern Category ParticlesPrepareRender;
+extern Category ParticlesSubmitRender;
 
 extern Category EnvironmentMapping;
 extern Category BuildShadowMap;
+extern Category ShadowMapCull;
+extern Category ShadowMapPrepareDraws;
+extern Category ShadowMapSubmitDraws;
+extern Category ShadowMapRenderDraws;
 extern Category RenderScene;
 extern Category RenderTrails;
 extern Category MoveObjects;
@@ -145,6 +153,7 @@ extern Category ModelParseBSPTree;
 extern Category ModelConfigureVertexBuffers;
 extern Category ModelCreateTransparencyIndexBuffer;
 extern Category ModelCreateDetailIndexBuffers;
+extern Category ModelFinishDeferredLoads;
 
 extern Category PreloadMissionSounds;
 extern Category LoadSound;
@@ -152,6 +161,7 @@ extern Category LoadSound;
 extern Category LevelPageIn;
 extern Category PageInStop;
 extern Category PageInSingleBitmap;
+extern Category PageInDecodeBitmaps;
 extern Category ShipPageIn;
 extern Category WeaponPageIn;
 
@@ -161,6 +161,14 @@ class RandomRange {
 
 		m_generator.seed(new_seed);
 	}
+
+	/**
+	 * @brief Whether this range always returns the same value, in which case next() doesn't touch the generator
+	 */
+	bool is_constant() const
+	{
+		return m_constant;
+	}
 };
 
 /**
@@ -583,6 +591,9 @@ class ParsedRandomRange {
 	inline void seed(unsigned int new_seed) const {
 		std::visit([new_seed](auto& range) {return range.seed(new_seed);}, m_random_range);
 	}
+	inline bool is_constant() const {
+		return std::visit([](auto& range) {return range.is_constant();}, m_random_range);
+	}
 	static ParsedRandomRange parseRandomRange(float min = std::numeric_limits<float>::lowest()/2.1f, float max = std::numeric_limits<float>::max()/2.1f) {
 		switch (optional_string_either("NORMAL", "CURVE")) {
 			case 0: {
@@ -645,6 +645,19 @@ public:
 		return result;
 	}
 
+	// Whether evaluating the curves draws random numbers, which advances generators shared by everything using this set
+	bool has_random_curves() const {
+		for (const auto& curve_list : curves) {
+			for (const auto& input_and_curve : curve_list) {
+				const auto& curve_entry = input_and_curve.second;
+				if (!curve_entry.scaling_factor.is_constant() || !curve_entry.translation.is_constant())
+					return true;
+			}
+		}
+
+		return false;
+	}
+
 	float get_output_or_default(output_enum output, const input_type& input, float default_val, const modular_curves_entry_instance* instance = nullptr) const {
 		if (has_curve(output))
 			return get_output(output, input, instance);
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include <algorithm>
+#include <string_view>
+
+namespace util {
+
+/**
+ * @brief Maps names to the indices of the table entries which carry them
+ *
+ * Only the hash of every name is stored, so looking up a name doesn't need to allocate or copy it. The index returns
+ * the candidates whose name hashes the same, and the caller checks every candidate with the comparison the table has
+ * always used, which also makes hash collisions harmless. Candidates are tried in ascending order, so the result is
+ * the same as the one of a loop over the table which returns the first match.
+ *
+ * Tables whose entries come and go (like Ships) call set() and remove() whenever an entry is created, renamed or
+ * deleted. Tables which only grow (like Ship_info) can call update() before every lookup instead, plus set() for
+ * entries which are renamed after they were added.
+ *
+ * @tparam Hash Hashes a const char*. Defaults to a case-insensitive hash, use std::hash<std::string_view> for names
+ * which are compared case-sensitively.
+ */
+template <typename Hash = SCP_string_lcase_hash>
+class name_index
+{
+  public:
+	void clear()
+	{
+		m_buckets.clear();
+		m_hashes.clear();
+		m_updated_count = 0;
+	}
+
+	/**
+	 * @brief Adds the entry at index with the given name, or moves it over if it already had a different name
+	 */
+	void set(int index, const char* name)
+	{
+		Assertion(index >= 0, "Invalid index %d passed to name_index::set!", index);
+
+		remove(index);
+
+		if (static_cast<size_t>(index) >= m_hashes.size()) {
+			m_hashes.resize(index + 1);
+		}
+
+		auto hash = Hash()(name);
+		m_hashes[index] = {hash, true};
+
+		auto& bucket = m_buckets[hash];
+		bucket.insert(std::lower_bound(bucket.begin(), bucket.end(), index), index);
+	}
+
+	void remove(int index)
+	{
+		if (index < 0 || static_cast<size_t>(index) >= m_hashes.size() || !m_hashes[index].used) {
+			return;
+		}
+
+		auto hash = m_hashes[index].hash;
+		m_hashes[index].used = false;
+
+		auto it = m_buckets.find(hash);
+		if (it == m_buckets.end()) {
+			return;
+		}
+
+		auto& bucket = it->second;
+		bucket.erase(std::remove(bucket.begin(), bucket.end(), index), bucket.end());
+		if (bucket.empty()) {
+			m_buckets.erase(it);
+		}
+	}
+
+	/**
+	 * @brief Makes sure the first count entries of a table are indexed, with name_of(i) returning the name of entry i
+	 *
+	 * Only entries which were added since the last call are indexed, unless the table shrank or invalidate() was
+	 * called in the meantime.
+	 */
+	template <typename NameOf>
+	void update(int count, NameOf name_of)
+	{
+		if (count < m_updated_count) {
+			clear();
+		}
+
+		for (int i = m_updated_count; i < count; ++i) {
+			set(i, name_of(i));
+		}
+		m_updated_count = count;
+	}
+
+	/**
+	 * @brief Makes the next update() index the whole table again, for when entries were renamed or moved around
+	 */
+	void invalidate() { clear(); }
+
+	/**
+	 * @brief Returns the lowest index with a name like the given one for which accept(index) is true, or -1
+	 */
+	template <typename Accept>
+	int find(const char* name, Accept accept) const
+	{
+		auto it = m_buckets.find(Hash()(name));
+		if (it == m_buckets.end()) {
+			return -1;
+		}
+
+		for (auto index : it->second) {
+			if (accept(index)) {
+				return index;
+			}
+		}
+
+		return -1;
+	}
+
+  private:
+	struct entry {
+		size_t hash = 0;
+		bool used = false;
+	};
+
+	SCP_unordered_map<size_t, SCP_vector<int>> m_buckets;
+	SCP_vector<entry> m_hashes;
+	int m_updated_count = 0;
+};
+
+}
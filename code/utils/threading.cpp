@@ -18,10 +18,6 @@
 namespace threading {
 	static size_t num_threads = 1;
 
-	static std::condition_variable wait_for_task;
-	static std::mutex wait_for_task_mutex;
-	static bool wait_for_task_condition;
-
 	static std::condition_variable wait_for_spindown_tasks;
 	static std::mutex wait_for_spindown_task_mutex;
 	static size_t wait_for_spindown_tasks_counter;
@@ -31,38 +27,253 @@ namespace threading {
 	static size_t wait_for_spinup_tasks_counter;
 
 	static std::atomic<WorkerThreadTask> worker_task;
+	static std::atomic<uint64_t> worker_task_generation;
+
+	//Idle workers sleep here until either a job or a task shows up
+	static std::condition_variable wait_for_work;
+	static std::mutex wait_for_work_mutex;
+	static std::atomic<int> sleeping_workers;
+	static std::atomic<int> pending_jobs;
 
 	static SCP_vector<std::thread> worker_threads;
 
+	struct job {
+		std::function<void()> func;
+		job_group* group;
+
+		//Number of dependencies that aren't done yet, plus one while the job is still being added
+		std::atomic<int> unfinished;
+
+		std::mutex dependents_mutex;
+		SCP_vector<job*> dependents;
+		bool finished = false;
+	};
+
+	//Chase-Lev work-stealing deque. Only the owning thread may push and pop at the bottom, every other thread steals from the top.
+	class job_deque {
+		static constexpr int64_t CAPACITY = 4096;
+
+		std::atomic<int64_t> top{0};
+		std::atomic<int64_t> bottom{0};
+		std::unique_ptr<std::atomic<job*>[]> buffer;
+
+	  public:
+		job_deque() : buffer(new std::atomic<job*>[CAPACITY]) {}
+
+		bool push(job* j) {
+			const int64_t b = bottom.load(std::memory_order_relaxed);
+			const int64_t t = top.load(std::memory_order_acquire);
+			if (b - t >= CAPACITY)
+				return false;
+
+			buffer[b & (CAPACITY - 1)].store(j, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		job* pop() {
+			const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+
+			if (t > b) {
+				//Empty
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			job* j = buffer[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+			if (t == b) {
+				//Last element, race against the thieves for it
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					j = nullptr;
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return j;
+		}
+
+		job* steal() {
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64_t b = bottom.load(std::memory_order_acquire);
+
+			if (t >= b)
+				return nullptr;
+
+			job* j = buffer[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+			return j;
+		}
+	};
+
+	//One deque per worker, plus one for the main thread at the end
+	static std::unique_ptr<job_deque[]> job_deques;
+	static size_t num_job_deques = 0;
+	static thread_local job_deque* current_deque = nullptr;
+	static thread_local uint32_t steal_seed = 0;
+
+	//Jobs added by threads which own no deque
+	static SCP_vector<job*> injected_jobs;
+	static std::mutex injected_jobs_mutex;
+
 	//Internal Functions
-	static void mp_worker_thread_main(size_t threadIdx) {
-		while(true) {
-			{
-				std::scoped_lock lock {wait_for_spindown_task_mutex};
-				++wait_for_spindown_tasks_counter;
-				wait_for_spindown_tasks.notify_all();
+	static bool run_jobs_inline() {
+		return num_job_deques == 0;
+	}
+
+	static job* find_job() {
+		if (num_job_deques == 0)
+			return nullptr;
+
+		if (current_deque != nullptr) {
+			if (job* j = current_deque->pop())
+				return j;
+		}
+
+		{
+			std::scoped_lock lock {injected_jobs_mutex};
+			if (!injected_jobs.empty()) {
+				job* j = injected_jobs.back();
+				injected_jobs.pop_back();
+				return j;
 			}
-			//We're waiting for a new task, so spindown was successful
-			{
-				std::unique_lock<std::mutex> lk(wait_for_task_mutex);
-				wait_for_task.wait(lk, []() { return wait_for_task_condition; });
+		}
+
+		//Pick a random victim to start with so the thieves don't all crowd the same deque
+		steal_seed = steal_seed * 1664525u + 1013904223u;
+		const size_t start = (steal_seed >> 16) % num_job_deques;
+		for (size_t i = 0; i < num_job_deques; i++) {
+			job_deque* victim = &job_deques[(start + i) % num_job_deques];
+			if (victim == current_deque)
+				continue;
+
+			if (job* j = victim->steal())
+				return j;
+		}
+
+		return nullptr;
+	}
+
+	void execute_job(job* j);
+
+	static void schedule_job(job* j) {
+		if (run_jobs_inline()) {
+			execute_job(j);
+			return;
+		}
+
+		pending_jobs.fetch_add(1);
+		if (current_deque != nullptr) {
+			if (!current_deque->push(j)) {
+				//Our deque is full, so just take care of this one ourselves
+				pending_jobs.fetch_sub(1);
+				execute_job(j);
+				return;
 			}
-			//Notify that we passed the wait and can now start processing. This is necessary, as slow thread wakeups in very low workloads could cause the wait_for_task_condition to be false, never waking up the thread, locking on spindown wait
-			{
-				std::scoped_lock lock {wait_for_spinup_task_mutex};
-				++wait_for_spinup_tasks_counter;
-				wait_for_spinup_tasks.notify_all();
+		}
+		else {
+			std::scoped_lock lock {injected_jobs_mutex};
+			injected_jobs.push_back(j);
+		}
+
+		if (sleeping_workers.load() > 0) {
+			std::scoped_lock lock {wait_for_work_mutex};
+			wait_for_work.notify_one();
+		}
+	}
+
+	void execute_job(job* j) {
+		j->func();
+
+		SCP_vector<job*> dependents;
+		{
+			std::scoped_lock lock {j->dependents_mutex};
+			j->finished = true;
+			dependents.swap(j->dependents);
+		}
+
+		for (job* dependent : dependents) {
+			if (dependent->unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				schedule_job(dependent);
+		}
+
+		//This must come last, as the group may be destroyed as soon as it sees no more outstanding jobs
+		j->group->m_outstanding.fetch_sub(1, std::memory_order_release);
+	}
+
+	static bool try_run_one_job() {
+		job* j = find_job();
+		if (j == nullptr)
+			return false;
+
+		pending_jobs.fetch_sub(1);
+		execute_job(j);
+		return true;
+	}
+
+	static void run_worker_task(WorkerThreadTask task, size_t threadIdx) {
+		//Notify that we picked up the task. This is necessary, as slow thread wakeups in very low workloads could otherwise cause a spin down before the task was ever started
+		{
+			std::scoped_lock lock {wait_for_spinup_task_mutex};
+			++wait_for_spinup_tasks_counter;
+			wait_for_spinup_tasks.notify_all();
+		}
+
+		switch (task) {
+			case WorkerThreadTask::EXIT:
+				break;
+			case WorkerThreadTask::COLLISION:
+				collide_mp_worker_thread(threadIdx);
+				break;
+			default:
+				UNREACHABLE("Invalid threaded worker task!");
+		}
+
+		{
+			std::scoped_lock lock {wait_for_spindown_task_mutex};
+			++wait_for_spindown_tasks_counter;
+			wait_for_spindown_tasks.notify_all();
+		}
+	}
+
+	static void mp_worker_thread_main(size_t threadIdx) {
+		current_deque = &job_deques[threadIdx];
+		steal_seed = static_cast<uint32_t>(threadIdx) + 1;
+
+		uint64_t seen_generation = 0;
+		while(true) {
+			//Spin for a little while before going to sleep, jobs tend to come in bursts
+			for (int spin = 0; spin < 64; spin++) {
+				if (try_run_one_job())
+					spin = 0;
+				else if (worker_task_generation.load(std::memory_order_acquire) != seen_generation)
+					break;
+				else
+					std::this_thread::yield();
 			}
 
-			switch (worker_task.load(std::memory_order_acquire)) {
-				case WorkerThreadTask::EXIT:
-					//We're done and will quit, so ensure we report this.
+			const uint64_t generation = worker_task_generation.load(std::memory_order_acquire);
+			if (generation != seen_generation) {
+				seen_generation = generation;
+
+				const WorkerThreadTask task = worker_task.load(std::memory_order_acquire);
+				run_worker_task(task, threadIdx);
+
+				if (task == WorkerThreadTask::EXIT)
 					return;
-				case WorkerThreadTask::COLLISION:
-					collide_mp_worker_thread(threadIdx);
-					break;
-				default:
-					UNREACHABLE("Invalid threaded worker task!");
+				continue;
+			}
+
+			{
+				std::unique_lock<std::mutex> lk(wait_for_work_mutex);
+				sleeping_workers.fetch_add(1);
+				wait_for_work.wait(lk, [seen_generation]() {
+					return pending_jobs.load() > 0 || worker_task_generation.load() != seen_generation;
+				});
+				sleeping_workers.fetch_sub(1);
 			}
 		}
 	}
@@ -174,9 +385,9 @@ namespace threading {
 		}
 		worker_task.store(task);
 		{
-			std::scoped_lock lock {wait_for_task_mutex};
-			wait_for_task_condition = true;
-			wait_for_task.notify_all();
+			std::scoped_lock lock {wait_for_work_mutex};
+			worker_task_generation.fetch_add(1);
+			wait_for_work.notify_all();
 		}
 	}
 
@@ -187,10 +398,6 @@ namespace threading {
 			wait_for_spinup_tasks.wait(lk, []() { return wait_for_spinup_tasks_counter >= num_threads; });
 			wait_for_spinup_tasks_counter = 0;
 		}
-		{
-			std::scoped_lock lock {wait_for_task_mutex};
-			wait_for_task_condition = false;
-		}
 	}
 
 	void spin_down_wait_complete() {
@@ -217,12 +424,20 @@ namespace threading {
 
 		mprintf(("Spinning up threadpool with %d threads...\n", static_cast<int>(num_threads)));
 
+		//The thread calling this is considered the main thread and gets the last deque
+		num_job_deques = num_threads + 1;
+		job_deques.reset(new job_deque[num_job_deques]);
+		current_deque = &job_deques[num_threads];
+
 		for (size_t i = 0; i < num_threads; i++) {
 			worker_threads.emplace_back([i](){ mp_worker_thread_main(i); });
 		}
 	}
 
 	void shut_down_task_pool() {
+		if (worker_threads.empty())
+			return;
+
 		spin_up_threaded_task(WorkerThreadTask::EXIT);
 
 		//Technically we could await spin_down_wait_complete here, but since we're returning and joining the threads here, there is no need
@@ -230,6 +445,11 @@ namespace threading {
 		for(auto& thread : worker_threads) {
 			thread.join();
 		}
+		worker_threads.clear();
+
+		num_job_deques = 0;
+		current_deque = nullptr;
+		job_deques.reset();
 	}
 
 	bool is_threading() {
@@ -239,4 +459,87 @@ namespace threading {
 	size_t get_num_workers() {
 		return worker_threads.size();
 	}
+
+	//Statics are initialized on the thread which runs main()
+	static const std::thread::id main_thread_id = std::this_thread::get_id();
+
+	bool is_main_thread() {
+		return std::this_thread::get_id() == main_thread_id;
+	}
+
+	job_group::job_group() : m_outstanding(0) {
+	}
+
+	job_group::~job_group() {
+		wait();
+	}
+
+	job_group::job_id job_group::add(std::function<void()> func) {
+		return add(std::move(func), {});
+	}
+
+	job_group::job_id job_group::add(std::function<void()> func, std::initializer_list<job_id> dependencies) {
+		auto id = m_jobs.size();
+		m_jobs.emplace_back(new job());
+
+		job* j = m_jobs.back().get();
+		j->func = std::move(func);
+		j->group = this;
+		j->unfinished.store(1, std::memory_order_relaxed);
+
+		for (auto dependency : dependencies) {
+			Assertion(dependency < id, "A job can only depend on jobs added before it!");
+			job* other = m_jobs[dependency].get();
+
+			std::scoped_lock lock {other->dependents_mutex};
+			if (!other->finished) {
+				other->dependents.push_back(j);
+				j->unfinished.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		m_outstanding.fetch_add(1, std::memory_order_relaxed);
+
+		//Drop the reference held while adding. If all dependencies are done already, we're good to go
+		if (j->unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			schedule_job(j);
+
+		return id;
+	}
+
+	void job_group::wait() {
+		while (m_outstanding.load(std::memory_order_acquire) > 0) {
+			if (!try_run_one_job())
+				std::this_thread::yield();
+		}
+
+		m_jobs.clear();
+	}
+
+	bool job_group::done() const {
+		return m_outstanding.load(std::memory_order_acquire) == 0;
+	}
+
+	void parallel_for(size_t begin, size_t end, size_t grain_size, const std::function<void(size_t, size_t)>& body) {
+		if (begin >= end)
+			return;
+
+		grain_size = std::max(grain_size, static_cast<size_t>(1));
+
+		//Not worth the overhead if it all fits into one chunk anyways
+		if (end - begin <= grain_size || run_jobs_inline()) {
+			body(begin, end);
+			return;
+		}
+
+		job_group group;
+		for (size_t chunk = begin + grain_size; chunk < end; chunk += grain_size) {
+			const size_t chunk_end = std::min(chunk + grain_size, end);
+			group.add([&body, chunk, chunk_end]() { body(chunk, chunk_end); });
+		}
+
+		//The calling thread takes care of the first chunk itself
+		body(begin, std::min(begin + grain_size, end));
+		group.wait();
+	}
 }
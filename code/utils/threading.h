@@ -1,11 +1,17 @@
 #pragma once
 
+#include "globalincs/pstypes.h"
+
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <memory>
 
 namespace threading {
 	enum class WorkerThreadTask : uint8_t { EXIT, COLLISION };
 
 	//Call this to start a task on the task pool. Note that task-specific data must be set up before calling this.
+	//Such a task occupies every worker thread until it is spun down again, jobs submitted in the meantime are only picked up by threads waiting on a job_group.
 	void spin_up_threaded_task(WorkerThreadTask task);
 
 	//This _must_ be called on the main thread BEFORE a task completes on a thread of the task pool.
@@ -19,4 +25,42 @@ namespace threading {
 
 	bool is_threading();
 	size_t get_num_workers();
-}
\ No newline at end of file
+
+	//Whether this is the thread the game was started on
+	bool is_main_thread();
+
+	struct job;
+
+	//A set of jobs which are executed by the task pool and can be waited on together.
+	//Jobs are distributed over per-thread work-stealing queues, so they may be added from the main thread as well as from within other jobs.
+	//A job may depend on other jobs of the same group, in which case it is only started once all of them are done.
+	//Without a task pool, jobs are run right away when they are added.
+	class job_group {
+	  public:
+		using job_id = size_t;
+
+		job_group();
+		~job_group();
+
+		job_group(const job_group&) = delete;
+		job_group& operator=(const job_group&) = delete;
+
+		job_id add(std::function<void()> func);
+		job_id add(std::function<void()> func, std::initializer_list<job_id> dependencies);
+
+		//Blocks until all jobs of this group are done. The calling thread helps with executing jobs in the meantime.
+		//Must be called from the thread that added the jobs.
+		void wait();
+
+		bool done() const;
+
+	  private:
+		friend void execute_job(job* j);
+
+		SCP_vector<std::unique_ptr<job>> m_jobs;
+		std::atomic<size_t> m_outstanding;
+	};
+
+	//Calls body(chunk_begin, chunk_end) for consecutive chunks of at most grain_size elements covering [begin, end) and returns once all chunks are done.
+	void parallel_for(size_t begin, size_t end, size_t grain_size, const std::function<void(size_t, size_t)>& body);
+}
@@ -3172,19 +3172,24 @@ int beam_collide_ship(obj_pair *pair)
 		shield_collision = 0;
 	}
 
+	mc_hull_enter.flags |= MC_CHECK_MODEL;
+
 	if (beam_will_tool_target(a_beam, ship_objp)) {
 		mc_hull_exit = mc_hull_enter;
-		mc_hull_exit.flags |= MC_CHECK_MODEL;
 
 		// reverse this vector so that we check for exit holes as opposed to entrance holes
 		std::swap(mc_hull_exit.p0, mc_hull_exit.p1);
-		hull_exit_collision = model_collide(&mc_hull_exit);
+
+		// both go through the same model, so check them together
+		mc_info *hull_checks[] = { &mc_hull_exit, &mc_hull_enter };
+		model_collide_batch(hull_checks, 2);
+
+		hull_exit_collision = mc_hull_exit.num_hits;
+		hull_enter_collision = mc_hull_enter.num_hits;
 	} else {
 		hull_exit_collision = 0;
+		hull_enter_collision = model_collide(&mc_hull_enter);
 	}
-
-	mc_hull_enter.flags |= MC_CHECK_MODEL;
-	hull_enter_collision = model_collide(&mc_hull_enter);
 	// ---
 
     // If we have a range less than the "far" range, check if the ray actually hit within the range
@@ -988,6 +988,7 @@ typedef struct tracking_info {
 } tracking_info;
 
 int weapon_info_lookup(const char *name);
+void weapon_info_name_changed(int weapon_info_index);	// must be called whenever a weapon class is renamed after parsing
 int weapon_info_get_index(const weapon_info *wip);
 
 inline int weapon_info_size()
@@ -1063,6 +1064,12 @@ int	weapon_area_calc_damage(const object *objp, const vec3d *pos, float inner_ra
 
 void find_homing_object_cmeasures(const SCP_vector<object*> &cmeasure_list);
 
+// rebuilds the index of objects homing weapons can pick as their target, called once per frame before anything moves
+void weapon_homing_grid_rebuild(float frametime);
+
+// marks the index as outdated, e.g. when new objects enter obj_used_list outside of obj_move_all()
+void weapon_homing_grid_invalidate();
+
 // THE FOLLOWING FUNCTION IS IN SHIP.CPP!!!!
 // JAS - figure out which thruster bitmap will get rendered next
 // time around.  ship_render needs to have shipp->thruster_bitmap set to
@@ -39,6 +39,7 @@
 #include "network/multiutil.h"
 #include "object/objcollide.h"
 #include "object/objectdock.h"
+#include "object/objectgrid.h"
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
 #include "parse/parsehi.h"
@@ -66,6 +67,7 @@
 #include "particle/volumes/PointVolume.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/name_index.h"
 #include "weapon.h"
 #include "model/modelrender.h"
 
@@ -102,6 +104,9 @@ static TIMESTAMP Weapon_flyby_sound_timer;
 weapon Weapons[MAX_WEAPONS];
 SCP_vector<weapon_info> Weapon_info;
 
+// the names of the weapon classes, brought up to date whenever they are looked up
+static util::name_index<> Weapon_info_name_index;
+
 #define		MISSILE_OBJ_USED	(1<<0)			// flag used in missile_obj struct
 #define		MAX_MISSILE_OBJS	MAX_WEAPONS		// max number of missiles tracked in missile list
 missile_obj Missile_objs[MAX_MISSILE_OBJS];	// array used to store missile object indexes
@@ -374,11 +379,16 @@ int weapon_info_lookup(const char *name)
 {
 	Assertion(name != nullptr, "NULL name passed to weapon_info_lookup");
 
-	for (auto it = Weapon_info.cbegin(); it != Weapon_info.cend(); ++it)
-		if (!stricmp(name, it->name))
-			return (int)std::distance(Weapon_info.cbegin(), it);
+	Weapon_info_name_index.update(weapon_info_size(), [](int i) { return Weapon_info[i].name; });
 
-	return -1;
+	return Weapon_info_name_index.find(name, [name](int i) { return !stricmp(name, Weapon_info[i].name); });
+}
+
+void weapon_info_name_changed(int weapon_info_index)
+{
+	Assertion(weapon_info_index >= 0 && weapon_info_index < weapon_info_size(), "Invalid weapon class %d passed to weapon_info_name_changed", weapon_info_index);
+
+	Weapon_info_name_index.set(weapon_info_index, Weapon_info[weapon_info_index].name);
 }
 
 /**
@@ -4640,6 +4650,9 @@ void weapon_sort_by_type()
 	if (big_missiles)	delete [] big_missiles;
 	if (child_primaries)	delete [] child_primaries;
 	if (child_secondaries)	delete [] child_secondaries;
+
+	// every class may have moved
+	Weapon_info_name_index.invalidate();
 }
 
 /**
@@ -5269,6 +5282,8 @@ void weapon_level_init()
 
 	Weapon_flyby_sound_timer = TIMESTAMP::immediate();
 	Weapon_impact_timer = TIMESTAMP::immediate();	// inited each level, used to reduce impact sounds
+
+	weapon_homing_grid_invalidate();
 }
 
 MONITOR( NumWeaponsRend )
@@ -5409,6 +5424,55 @@ void detonate_nearby_missiles(object* killer_objp, object* missile_objp)
 	}
 }
 
+// Ships and countermeasures in obj_used_list order, which is everything find_homing_object() may pick as a target
+static object_grid Homing_grid(2000.0f);
+static bool Homing_grid_valid = false;
+
+// how far anything in the grid may have moved since it was built, and how fast the fastest of them can go
+static float Homing_grid_margin = 0.0f;
+static float Homing_grid_max_speed = 0.0f;
+
+static int Homing_queries = 0;
+static int Homing_candidates = 0;
+
+MONITOR(HomingQueries)
+static tracing::Monitor<float> Homing_candidates_per_query("HomingCandidatesPerQuery", 0.0f);
+
+void weapon_homing_grid_rebuild(float frametime)
+{
+	// report what the searches of the last frame had to look at
+	mon_HomingQueries = Homing_queries;
+	Homing_candidates_per_query = Homing_queries > 0 ? (float)Homing_candidates / Homing_queries : 0.0f;
+	Homing_queries = 0;
+	Homing_candidates = 0;
+
+	float max_speed = 0.0f;
+
+	Homing_grid.clear();
+
+	for (object* objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+		if (objp->type == OBJ_SHIP || (objp->type == OBJ_WEAPON && Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Cmeasure])) {
+			// homing only cares about the position, not the size of the target
+			Homing_grid.add(OBJ_INDEX(objp), objp->pos, 0.0f);
+
+			max_speed = std::max(max_speed, vm_vec_mag(&objp->phys_info.vel));
+			max_speed = std::max(max_speed, vm_vec_mag(&objp->phys_info.max_vel));
+			max_speed = std::max(max_speed, vm_vec_mag(&objp->phys_info.afterburner_max_vel));
+		}
+	}
+
+	// everything moves once more before the next rebuild, leave some room for objects speeding up along the way
+	Homing_grid_margin = 2.0f * max_speed * frametime + 1.0f;
+	Homing_grid_max_speed = max_speed;
+	Homing_grid_valid = true;
+}
+
+void weapon_homing_grid_invalidate()
+{
+	Homing_grid.clear();
+	Homing_grid_valid = false;
+}
+
 /**
  * Find an object for weapon #num (object *weapon_objp) to home on due to heat.
  */
@@ -5431,22 +5495,29 @@ void find_homing_object(object *weapon_objp, int num)
 	// only for random acquisition, accrue targets to later pick from randomly
 	SCP_vector<object*> prospective_targets;
 
-	//	Scan all objects, find a weapon to home on.
-	for ( object* objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+	auto consider = [&](object* objp) {
 		if (objp->flags[Object::Object_Flags::Should_be_dead])
-			continue;
+			return;
 
 		if ((objp->type == OBJ_SHIP) || ((objp->type == OBJ_WEAPON) && (Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Cmeasure])))
 		{
+			// the seeker cone is the cheapest test, so rule out everything behind the weapon first
+			vec3d vec_to_object;
+			float dist = vm_vec_normalized_dir(&vec_to_object, &objp->pos, &weapon_objp->pos);
+			float dot = vm_vec_dot(&vec_to_object, &weapon_objp->orient.vec.fvec);
+
+			if (dot <= wip->fov)
+				return;
+
 			//WMC - Spawn weapons shouldn't go for protected ships
 			// ditto for untargeted heat seekers - niffiwan
 			if ( (objp->flags[Object::Object_Flags::Protected]) &&
 				((wp->weapon_flags[Weapon::Weapon_Flags::Spawned]) || (wip->wi_flags[Weapon::Info_Flags::Untargeted_heat_seeker])) )
-				continue;
+				return;
 
 			// Spawned weapons should never home in on their parent - even in multiplayer dogfights where they would pass the iff test below
 			if ((wp->weapon_flags[Weapon::Weapon_Flags::Spawned]) && (objp == &Objects[weapon_objp->parent]))
-				continue; 
+				return; 
 
 			int homing_object_team = obj_team(objp);
 			bool can_attack = weapon_has_iff_restrictions(wip) || iff_x_attacks_y(wp->team, homing_object_team);
@@ -5462,18 +5533,18 @@ void find_homing_object(object *weapon_objp, int num)
                     if ((wip->wi_flags[Weapon::Info_Flags::Huge]) &&
                         !(sip->is_huge_ship()))
                     {
-                        continue;
+                        return;
                     }
 
 					// AL 2-17-98: If ship is immune to sensors, can't home on it (Sandeep says so)!
 					if ( sp->flags[Ship::Ship_Flags::Hidden_from_sensors] ) {
-						continue;
+						return;
 					}
 
 					// Goober5000: if missiles can't home on sensor-ghosted ships,
 					// they definitely shouldn't home on stealth ships
 					if ( sp->flags[Ship::Ship_Flags::Stealth] && (The_mission.ai_profile->flags[AI::Profile_Flags::Fix_heat_seeker_stealth_bug]) ) {
-						continue;
+						return;
 					}
 
                     if (wip->wi_flags[Weapon::Info_Flags::Homing_javelin])
@@ -5481,7 +5552,7 @@ void find_homing_object(object *weapon_objp, int num)
                         target_engines = ship_get_closest_subsys_in_sight(sp, SUBSYSTEM_ENGINE, &weapon_objp->pos);
 
                         if (!target_engines)
-                            continue;
+                            return;
                     }
 
 					//	MK, 9/4/99.
@@ -5491,43 +5562,55 @@ void find_homing_object(object *weapon_objp, int num)
 					if (!( Game_mode & GM_MULTIPLAYER ) && objp == Player_obj) {
 						int	num_homers = compute_num_homing_objects(objp);
 						if (The_mission.ai_profile->max_allowed_player_homers[Game_skill_level] < num_homers)
-							continue;
+							return;
 					}
 				}
                 else if (objp->type == OBJ_WEAPON)
 				{
                     //don't attempt to home on weapons if the weapon is a huge weapon or is a javelin homing weapon.
 					if (wip->wi_flags.any_of(Weapon::Info_Flags::Huge,Weapon::Info_Flags::Homing_javelin))
-                        continue;
+                        return;
                     
                     //don't look for local ssms that are gone for the time being
 					if (Weapons[objp->instance].lssm_stage == 3)
-						continue;
+						return;
 				}
 
-				vec3d vec_to_object;
-				float dist = vm_vec_normalized_dir(&vec_to_object, &objp->pos, &weapon_objp->pos);
-
 				if (objp->type == OBJ_WEAPON && (Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Cmeasure])) {
 					dist *= 0.5f;
 				}
 
-				float dot = vm_vec_dot(&vec_to_object, &weapon_objp->orient.vec.fvec);
-
-				if (dot > wip->fov) {
-					if (wip->auto_target_method == HomingAcquisitionType::CLOSEST && dist < best_dist) {
-						best_dist = dist;
-						wp->homing_object	= objp;
-						wp->target_sig		= objp->signature;
-						wp->homing_subsys	= target_engines;
+				if (wip->auto_target_method == HomingAcquisitionType::CLOSEST && dist < best_dist) {
+					best_dist = dist;
+					wp->homing_object	= objp;
+					wp->target_sig		= objp->signature;
+					wp->homing_subsys	= target_engines;
 
-						cmeasure_maybe_alert_success(objp);
-					} else { // HomingAcquisitionType::RANDOM
-						prospective_targets.push_back(objp);
-					}
+					cmeasure_maybe_alert_success(objp);
+				} else { // HomingAcquisitionType::RANDOM
+					prospective_targets.push_back(objp);
 				}
 			}
 		}
+	};
+
+	//	Find a ship or countermeasure to home on.
+	if (Homing_grid_valid && !wip->wi_flags[Weapon::Info_Flags::Local_ssm]) {
+		// anything further away than the weapon and its target can close in on each other during the rest of its life
+		// can never be hit
+		float weapon_speed = std::max(wip->max_speed, wp->weapon_max_vel);
+		weapon_speed = std::max(weapon_speed, vm_vec_mag(&weapon_objp->phys_info.vel));
+		float range = std::max(wp->lifeleft, 0.0f) * (weapon_speed + Homing_grid_max_speed);
+
+		Homing_grid.query(weapon_objp->pos, range + Homing_grid_margin, [&](int objnum) {
+			++Homing_candidates;
+			consider(&Objects[objnum]);
+		});
+		++Homing_queries;
+	} else {
+		for ( object* objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+			consider(objp);
+		}
 	}
 
 	if (wip->auto_target_method == HomingAcquisitionType::RANDOM && prospective_targets.size() > 0) {
@@ -5557,6 +5640,15 @@ void find_homing_object(object *weapon_objp, int num)
  */
 void find_homing_object_cmeasures(const SCP_vector<object*> &cmeasure_list)
 {
+	// everything has moved already, so the grid holds the exact positions. It keeps the order of the list, and with that
+	// the order in which the weapons roll for being decoyed.
+	static object_grid Cmeasure_grid(1000.0f);
+
+	Cmeasure_grid.clear();
+	for (auto cm_objp : cmeasure_list) {
+		Cmeasure_grid.add(OBJ_INDEX(cm_objp), cm_objp->pos, Weapon_info[Weapons[cm_objp->instance].weapon_info_index].cm_effective_rad);
+	}
+
 	for (object *weapon_objp = GET_FIRST(&obj_used_list); weapon_objp != END_OF_LIST(&obj_used_list); weapon_objp = GET_NEXT(weapon_objp) ) {
 		if (weapon_objp->flags[Object::Object_Flags::Should_be_dead])
 			continue;
@@ -5571,20 +5663,20 @@ void find_homing_object_cmeasures(const SCP_vector<object*> &cmeasure_list)
 
 			if (wip->is_homing()) {
 				float best_dot = wip->fov;
-				for (auto cit = cmeasure_list.cbegin(); cit != cmeasure_list.cend(); ++cit) {
+				auto consider = [&](object* cm_objp) {
 					//don't have a weapon try to home in on itself
-					if (*cit == weapon_objp)
-						continue;
+					if (cm_objp == weapon_objp)
+						return;
 
-					weapon *cm_wp = &Weapons[(*cit)->instance];
+					weapon *cm_wp = &Weapons[cm_objp->instance];
 					weapon_info *cm_wip = &Weapon_info[cm_wp->weapon_info_index];
 
 					//don't have a weapon try to home in on missiles fired by the same team, unless its the traitor team.
 					if ((wp->team == cm_wp->team) && (wp->team != Iff_traitor))
-						continue;
+						return;
 
 					vec3d	vec_to_object;
-					float dist = vm_vec_normalized_dir(&vec_to_object, &(*cit)->pos, &weapon_objp->pos);
+					float dist = vm_vec_normalized_dir(&vec_to_object, &cm_objp->pos, &weapon_objp->pos);
 
 					if (dist < cm_wip->cm_effective_rad)
 					{
@@ -5596,15 +5688,15 @@ void find_homing_object_cmeasures(const SCP_vector<object*> &cmeasure_list)
 						else {
 							bool found = false;
 							for (auto ii = wp->cmeasure_ignore_list->cbegin(); ii != wp->cmeasure_ignore_list->cend(); ++ii) {
-								if ((*cit)->signature == *ii) {
+								if (cm_objp->signature == *ii) {
 									nprintf(("CounterMeasures", "Weapon (%s-%04i) already seen CounterMeasure (%s-%04i) Frame: %i\n",
-												wip->name, weapon_objp->instance, cm_wip->name, (*cit)->signature, Framecount));
+												wip->name, weapon_objp->instance, cm_wip->name, cm_objp->signature, Framecount));
 									found = true;
 									break;
 								}
 							}
 							if (found) {
-								continue;
+								return;
 							}
 						}
 
@@ -5617,12 +5709,12 @@ void find_homing_object_cmeasures(const SCP_vector<object*> &cmeasure_list)
 						}
 
 						// remember this cmeasure so it can be ignored in future
-						wp->cmeasure_ignore_list->push_back((*cit)->signature);
+						wp->cmeasure_ignore_list->push_back(cm_objp->signature);
 
 						if (frand() >= chance) {
 							// failed to decoy
 							nprintf(("CounterMeasures", "Weapon (%s-%04i) ignoring CounterMeasure (%s-%04i) Frame: %i\n",
-										wip->name, weapon_objp->instance, cm_wip->name, (*cit)->signature, Framecount));
+										wip->name, weapon_objp->instance, cm_wip->name, cm_objp->signature, Framecount));
 						}
 						else {
 							// successful decoy, maybe chase the new cm
@@ -5631,14 +5723,21 @@ void find_homing_object_cmeasures(const SCP_vector<object*> &cmeasure_list)
 							if (dot > best_dot)
 							{
 								best_dot = dot;
-								wp->homing_object = (*cit);
-								cmeasure_maybe_alert_success((*cit));
+								wp->homing_object = cm_objp;
+								cmeasure_maybe_alert_success(cm_objp);
 								nprintf(("CounterMeasures", "Weapon (%s-%04i) chasing CounterMeasure (%s-%04i) Frame: %i\n",
-											wip->name, weapon_objp->instance, cm_wip->name, (*cit)->signature, Framecount));
+											wip->name, weapon_objp->instance, cm_wip->name, cm_objp->signature, Framecount));
 							}
 						}
 					}
-				}
+				};
+
+				// only countermeasures close enough to have an effect need to be looked at
+				Cmeasure_grid.query(weapon_objp->pos, 0.0f, [&](int objnum) {
+					++Homing_candidates;
+					consider(&Objects[objnum]);
+				});
+				++Homing_queries;
 			}
 		}
 	}
@@ -1521,6 +1521,8 @@ bool game_start_mission()
 		init_multiplayer_stats();
 	}
 
+	level_page_in_start();
+
 	game_busy( NOX("** starting mission_load() **") );
 	bool load_success = mission_load(Game_current_mission_filename);
 
@@ -1546,6 +1548,7 @@ bool game_start_mission()
 			game_loading_callback_close();
 		}
 
+		level_page_in_cancel();
 		game_level_close();
 
 		return false;
@@ -12,6 +12,7 @@
 #include "freespace.h"
 #include "levelpaging.h"
 
+#include "model/model.h"
 #include "tracing/tracing.h"
 
 
@@ -34,6 +35,18 @@ namespace particle
 	extern void page_in();
 }
 
+void level_page_in_start()
+{
+	// the collision trees and vertex buffers of everything the mission loads are built by level_page_in(),
+	// in parallel, once all of the mission's models are known
+	model_defer_loads();
+}
+
+void level_page_in_cancel()
+{
+	model_finish_deferred_loads();
+}
+
 // Pages in all the texutures for the currently
 // loaded mission.  Call game_busy() occasionally...
 void level_page_in()
@@ -62,6 +75,9 @@ void level_page_in()
 		message_pagein_mission_messages();
 	}
 
+	game_busy( NOX("*** building models ***") );
+	model_finish_deferred_loads();
+
 	if(!(Game_mode & GM_STANDALONE_SERVER)){
 		model_page_in_stop();		// free any loaded models that aren't used
 		bm_page_in_stop();
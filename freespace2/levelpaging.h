@@ -12,8 +12,14 @@
 #ifndef _LEVELPAGING_H
 #define _LEVELPAGING_H
 
+// Call this before the mission is loaded, so the models it loads can be finished all at once by level_page_in()
+void level_page_in_start();
+
 // Call this and it calls the page in code for all the subsystems
 void level_page_in();
 
+// Finishes the models loaded since level_page_in_start(), for when the mission couldn't be loaded
+void level_page_in_cancel();
+
 #endif	//_LEVELPAGING_H
 
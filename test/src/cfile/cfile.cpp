@@ -1,10 +1,14 @@
 
 #include <cfile/cfilesystem.h>
+#include <cmdline/cmdline.h>
 #include <graphics/font.h>
 #include <gtest/gtest.h>
 
 #include "util/FSTestFixture.h"
 
+#include <chrono>
+#include <random>
+
 class CFileInitTest : public test::FSTestFixture {
  public:
 	CFileInitTest() : test::FSTestFixture(INIT_NONE) {
@@ -212,3 +216,163 @@ TEST_F(CFileTest, subfolder_list)
 	ASSERT_EQ(2, cf_get_file_list(table_files, CF_TYPE_TABLES, "*\\*.tbl", CF_SORT_NAME));
 	ASSERT_TRUE(table_files.back().substr(0, 6) == "folder");
 }
+
+namespace {
+const int BENCHMARK_FOLDERS = 100;
+const int BENCHMARK_FILES_PER_FOLDER = 2000;
+
+int32_t benchmark_file_offset(int file)
+{
+	// every file gets its own (nonexistent) data so the lookups can be checked
+	return 16 + file;
+}
+
+void write_vp_entry(FILE* fp, int32_t offset, int32_t size, const char* name)
+{
+	char filename[32] = {};
+	strcpy_s(filename, name);
+
+	int32_t write_time = 0;
+
+	fwrite(&offset, sizeof(offset), 1, fp);
+	fwrite(&size, sizeof(size), 1, fp);
+	fwrite(filename, sizeof(filename), 1, fp);
+	fwrite(&write_time, sizeof(write_time), 1, fp);
+}
+
+// Writes a pack file with 200k maps spread over a bunch of subfolders. Only the index is real.
+void write_benchmark_vp(const SCP_string& path)
+{
+	FILE* fp = fopen(path.c_str(), "wb");
+	ASSERT_NE(nullptr, fp);
+
+	const int32_t num_entries = 2 + BENCHMARK_FOLDERS * (BENCHMARK_FILES_PER_FOLDER + 2) + 2;
+	const int32_t header[4] = {0x50565056, 2, 16, num_entries};
+	fwrite(header, sizeof(header), 1, fp);
+
+	write_vp_entry(fp, 0, 0, "data");
+	write_vp_entry(fp, 0, 0, "maps");
+
+	char name[32];
+	for (int folder = 0; folder < BENCHMARK_FOLDERS; ++folder) {
+		sprintf(name, "sub%02d", folder);
+		write_vp_entry(fp, 0, 0, name);
+
+		for (int i = 0; i < BENCHMARK_FILES_PER_FOLDER; ++i) {
+			const int file = folder * BENCHMARK_FILES_PER_FOLDER + i;
+
+			sprintf(name, "file%06d.dds", file);
+			write_vp_entry(fp, benchmark_file_offset(file), 1, name);
+		}
+
+		write_vp_entry(fp, 0, 0, "..");
+	}
+
+	write_vp_entry(fp, 0, 0, "..");
+	write_vp_entry(fp, 0, 0, "..");
+
+	fclose(fp);
+}
+}
+
+TEST_F(CFileInitTest, file_index_benchmark) {
+	using clock = std::chrono::steady_clock;
+	const int num_files = BENCHMARK_FOLDERS * BENCHMARK_FILES_PER_FOLDER;
+
+	SCP_string vp_path(TEST_DATA_PATH);
+	vp_path += DIR_SEPARATOR_STR "cfile" DIR_SEPARATOR_STR "file_index_benchmark" DIR_SEPARATOR_STR "synthetic.vp";
+	write_benchmark_vp(vp_path);
+
+	SCP_string cfile_dir(TEST_DATA_PATH);
+	cfile_dir += DIR_SEPARATOR_CHAR;
+	cfile_dir += "test"; // Cfile expects something after the path
+
+	auto start = clock::now();
+	ASSERT_FALSE(cfile_init(cfile_dir.c_str()));
+	auto init_time = clock::now() - start;
+
+	// the loose copy of the first file has precedence over the one in the pack file
+	auto loc = cf_find_file_location("FILE000000.DDS", CF_TYPE_MAPS);
+	ASSERT_TRUE(loc.found);
+	ASSERT_EQ((size_t)0, loc.offset);
+
+	loc = cf_find_file_location("file000001.dds", CF_TYPE_MAPS);
+	ASSERT_TRUE(loc.found);
+	ASSERT_EQ((size_t)benchmark_file_offset(1), loc.offset);
+
+	ASSERT_TRUE(cf_find_file_location("sub00/file000001.dds", CF_TYPE_ANY).found);
+	ASSERT_FALSE(cf_find_file_location("sub01/file000001.dds", CF_TYPE_ANY).found);
+	ASSERT_FALSE(cf_find_file_location("file000001.dds", CF_TYPE_TABLES).found);
+
+	const int lookups = 100000;
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<int> file_dist(1, num_files - 1);
+	char name[32];
+
+	start = clock::now();
+	for (int i = 0; i < lookups; ++i) {
+		const int file = file_dist(gen);
+		sprintf(name, "file%06d.dds", file);
+
+		loc = cf_find_file_location(name, CF_TYPE_ANY);
+		ASSERT_TRUE(loc.found) << name;
+		ASSERT_EQ((size_t)benchmark_file_offset(file), loc.offset) << name;
+	}
+	auto lookup_time = clock::now() - start;
+
+	const char* exts[] = {".png", ".dds", ".tga"};
+
+	start = clock::now();
+	for (int i = 0; i < lookups; ++i) {
+		const int file = file_dist(gen);
+		sprintf(name, "file%06d", file);
+
+		auto loc_ext = cf_find_file_location_ext(name, 3, exts, CF_TYPE_ANY);
+		ASSERT_TRUE(loc_ext.found) << name;
+		ASSERT_EQ(1, loc_ext.extension_index) << name;
+		ASSERT_EQ((size_t)benchmark_file_offset(file), loc_ext.offset) << name;
+	}
+	auto lookup_ext_time = clock::now() - start;
+
+	cfile_close();
+	remove(vp_path.c_str());
+
+	auto to_us = [](clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+	std::cout << "Indexing " << num_files << " packed files: " << to_us(init_time) / 1000.0 << " ms" << std::endl;
+	std::cout << "cf_find_file_location:     " << to_us(lookup_time) / lookups << " us" << std::endl;
+	std::cout << "cf_find_file_location_ext: " << to_us(lookup_ext_time) / lookups << " us" << std::endl;
+}
+
+TEST_F(CFileInitTest, mmap_vps) {
+	auto old_mmap_vps = Cmdline_mmap_vps;
+	Cmdline_mmap_vps = true;
+
+	SCP_string cfile_dir(TEST_DATA_PATH);
+	cfile_dir += DIR_SEPARATOR_CHAR;
+	cfile_dir += "test"; // Cfile expects something after the path
+
+	ASSERT_FALSE(cfile_init(cfile_dir.c_str()));
+	Cmdline_mmap_vps = old_mmap_vps;
+
+	auto loc = cf_find_file_location("test.tbl", CF_TYPE_TABLES);
+	ASSERT_TRUE(loc.found);
+	ASSERT_NE(nullptr, loc.data_ptr);
+
+	auto fp = cfopen("test.tbl", "rb", CF_TYPE_TABLES);
+	ASSERT_TRUE(fp != nullptr);
+
+	auto length = static_cast<size_t>(cfilelength(fp));
+	ASSERT_GT(length, (size_t)0);
+
+	// there is nothing left after the whole file was handed out
+	auto span = cfread_span(fp, length);
+	ASSERT_NE(nullptr, span);
+	ASSERT_EQ(nullptr, cfread_span(fp, 1));
+
+	SCP_vector<char> copy(length);
+	cfseek(fp, 0, CF_SEEK_SET);
+	ASSERT_EQ(1, cfread(copy.data(), (int)length, 1, fp));
+	ASSERT_EQ(0, memcmp(copy.data(), span, length));
+
+	cfclose(fp);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "lighting/lighting.h"
+#include "math/vecmat.h"
+
+#include <random>
+
+namespace {
+// what scene_lights::setLightFilter() computed before the point lights were put into a tree
+SCP_vector<size_t> reference_filter(const SCP_vector<light>& lights, const vec3d* pos, float rad)
+{
+	SCP_vector<size_t> filtered;
+
+	for (size_t i = 0; i < lights.size(); ++i) {
+		auto& l = lights[i];
+
+		float dist_squared;
+		if (l.type == Light_Type::Point) {
+			vec3d to_light;
+			vm_vec_sub(&to_light, &l.vec, pos);
+			dist_squared = vm_vec_mag_squared(&to_light);
+		} else if (l.type == Light_Type::Tube) {
+			vec3d nearest;
+			vm_vec_dist_squared_to_line(pos, &l.vec, &l.vec2, &nearest, &dist_squared);
+		} else {
+			continue;
+		}
+
+		float max_dist_squared = l.radb + rad;
+		max_dist_squared *= max_dist_squared;
+
+		if (dist_squared < max_dist_squared) {
+			filtered.push_back(i);
+		}
+	}
+
+	return filtered;
+}
+
+light make_light(Light_Type type, const vec3d& pos, const vec3d& pos2, float radius)
+{
+	light l{};
+	l.type = type;
+	l.vec = pos;
+	l.vec2 = pos2;
+	l.rada = radius * 0.5f;
+	l.radb = radius;
+	l.rada_squared = l.rada * l.rada;
+	l.radb_squared = l.radb * l.radb;
+	l.intensity = 1.0f;
+	l.r = l.g = l.b = 1.0f;
+	l.sun_index = -1;
+	return l;
+}
+}
+
+TEST(LightingTest, filter_matches_scan)
+{
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<float> pos_dist(-20000.0f, 20000.0f);
+	std::uniform_real_distribution<float> radius_dist(1.0f, 800.0f);
+	std::uniform_real_distribution<float> model_radius_dist(0.0f, 3000.0f);
+	std::uniform_int_distribution<int> type_dist(0, 19);
+
+	SCP_vector<light> lights;
+	scene_lights scene;
+
+	for (int i = 0; i < 5000; ++i) {
+		auto pos = vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+		auto pos2 = vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+
+		// mostly weapon and explosion lights, with a few beams, suns and cones thrown in
+		auto type = Light_Type::Point;
+		switch (type_dist(gen)) {
+		case 0:
+			type = Light_Type::Tube;
+			break;
+		case 1:
+			type = Light_Type::Directional;
+			break;
+		case 2:
+			type = Light_Type::Cone;
+			break;
+		default:
+			break;
+		}
+
+		lights.push_back(make_light(type, pos, pos2, radius_dist(gen)));
+		scene.addLight(&lights.back());
+	}
+
+	// lights right at the edge of a query
+	auto edge = vm_vec_new(1000.0f, 0.0f, 0.0f);
+	lights.push_back(make_light(Light_Type::Point, edge, edge, 100.0f));
+	scene.addLight(&lights.back());
+
+	for (int q = 0; q < 1000; ++q) {
+		auto pos = vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+		auto rad = model_radius_dist(gen);
+
+		scene.setLightFilter(&pos, rad);
+		ASSERT_EQ(reference_filter(lights, &pos, rad), scene.getFilteredLights()) << "Query " << q;
+	}
+
+	for (float rad : {899.0f, 899.99f, 900.0f, 900.01f}) {
+		scene.setLightFilter(&vmd_zero_vector, rad);
+		ASSERT_EQ(reference_filter(lights, &vmd_zero_vector, rad), scene.getFilteredLights()) << "Radius " << rad;
+	}
+
+	// lights which are added after filtering are picked up by the next filter
+	auto late = vm_vec_new(50000.0f, 0.0f, 0.0f);
+	lights.push_back(make_light(Light_Type::Point, late, late, 10.0f));
+	scene.addLight(&lights.back());
+
+	scene.setLightFilter(&late, 1.0f);
+	ASSERT_EQ(SCP_vector<size_t>{lights.size() - 1}, scene.getFilteredLights());
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "mission/missionlog.h"
+#include "network/multi.h"
+#include "parse/parselo.h"
+
+#include <random>
+
+extern SCP_vector<log_entry> Log_entries;
+
+namespace {
+// what mission_log_get_time_indexed() and mission_log_get_count() computed before the log had an index
+int reference_get_time_indexed(LogType type, const char* pname, const char* sname, int count, fix* time)
+{
+	for (const auto& entry : Log_entries) {
+		if (entry.type != type)
+			continue;
+
+		bool found;
+		if ((type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED)) {
+			found = (!stricmp(entry.pname, pname) && !stricmp(entry.sname, sname)) ||
+			        (!stricmp(entry.pname, sname) && !stricmp(entry.sname, pname));
+		} else if (stricmp(entry.pname, pname) != 0) {
+			continue;
+		} else if ((type == LOG_SHIP_SUBSYS_DESTROYED) || (type == LOG_CAP_SUBSYS_CARGO_REVEALED)) {
+			found = (sname == nullptr) || !subsystem_stricmp(sname, entry.sname);
+		} else {
+			found = (sname == nullptr) || !stricmp(sname, entry.sname);
+		}
+
+		if (found && --count == 0) {
+			*time = entry.timestamp;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int reference_get_count(LogType type, const char* pname, const char* sname)
+{
+	int count = 0;
+	for (const auto& entry : Log_entries) {
+		if (entry.type != type)
+			continue;
+
+		if ((type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED)) {
+			if ((!stricmp(entry.pname, pname) && !stricmp(entry.sname, sname)) ||
+			    (!stricmp(entry.pname, sname) && !stricmp(entry.sname, pname)))
+				count++;
+		} else if (!stricmp(entry.pname, pname) && ((sname == nullptr) || !stricmp(sname, entry.sname))) {
+			count++;
+		}
+	}
+
+	return count;
+}
+}
+
+class MissionLogTest : public ::testing::Test {
+  protected:
+	void SetUp() override
+	{
+		// entries from the host are the only ones which can be added without any ships
+		m_old_game_mode = Game_mode;
+		m_old_net_player = Net_player;
+
+		Game_mode = GM_MULTIPLAYER;
+		Net_player = &m_net_player;
+
+		mission_log_init();
+	}
+	void TearDown() override
+	{
+		mission_log_init();
+
+		Game_mode = m_old_game_mode;
+		Net_player = m_old_net_player;
+	}
+
+	int m_old_game_mode = 0;
+	net_player* m_old_net_player = nullptr;
+	net_player m_net_player;
+};
+
+TEST_F(MissionLogTest, lookups_match_scans)
+{
+	const LogType types[] = {LOG_SHIP_DESTROYED, LOG_SHIP_DOCKED, LOG_SHIP_UNDOCKED, LOG_SHIP_SUBSYS_DESTROYED, LOG_WAYPOINTS_DONE};
+	const char* names[] = {"Alpha 1", "ALPHA 1", "Beta 2", "beta 2", "GTC Aquitaine", "Gamma"};
+	const char* snames[] = {"Alpha 1", "Beta 2", "engine", "Engines", "Path 1", ""};
+
+	std::mt19937 gen(1);
+	auto pick = [&gen](size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(gen); };
+
+	for (int i = 0; i < 2000; ++i) {
+		mission_log_add_entry_multi(types[pick(5)], names[pick(6)], snames[pick(6)], -1, i2f(i), 0);
+	}
+
+	for (auto type : types) {
+		for (auto pname : names) {
+			for (auto sname : snames) {
+				EXPECT_EQ(reference_get_count(type, pname, sname), mission_log_get_count(type, pname, sname));
+
+				for (int count = 1; count < 50; count += 7) {
+					fix expected_time = -1, actual_time = -1;
+					EXPECT_EQ(reference_get_time_indexed(type, pname, sname, count, &expected_time),
+						mission_log_get_time_indexed(type, pname, sname, count, &actual_time));
+					EXPECT_EQ(expected_time, actual_time) << pname << " " << sname << " " << count;
+				}
+			}
+
+			// the secondary name is optional for everything but docking
+			if (type != LOG_SHIP_DOCKED && type != LOG_SHIP_UNDOCKED) {
+				EXPECT_EQ(reference_get_count(type, pname, nullptr), mission_log_get_count(type, pname, nullptr));
+
+				for (int count = 1; count < 200; count += 13) {
+					fix expected_time = -1, actual_time = -1;
+					EXPECT_EQ(reference_get_time_indexed(type, pname, nullptr, count, &expected_time),
+						mission_log_get_time_indexed(type, pname, nullptr, count, &actual_time));
+					EXPECT_EQ(expected_time, actual_time) << pname << " " << count;
+				}
+			}
+		}
+	}
+
+	// a name which never made it into the log
+	EXPECT_EQ(0, mission_log_get_count(LOG_SHIP_DESTROYED, "Delta 3", nullptr));
+	EXPECT_EQ(0, mission_log_get_time(LOG_SHIP_DESTROYED, "Delta 3", nullptr, nullptr));
+
+	// starting a new mission forgets everything
+	mission_log_init();
+	EXPECT_EQ(0, mission_log_get_count(LOG_SHIP_DESTROYED, "Alpha 1", nullptr));
+}
@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+
+#include "cmdline/cmdline.h"
+#include "graphics/2d.h"
+#include "model/model.h"
+#include "model/modelcache.h"
+
+#include <functional>
+
+namespace {
+const SCP_string KEY = "0123456789abcdef0123456789abcdef";
+
+// a model with a triangle in its first submodel and nothing at all in its second one
+polymodel* make_model()
+{
+	auto pm = new polymodel();
+	strcpy_s(pm->filename, "cached.pof");
+
+	pm->n_models = 2;
+	pm->submodel = make_shared<bsp_info[]>(2);
+	strcpy_s(pm->submodel[0].name, "hull");
+	strcpy_s(pm->submodel[1].name, "empty");
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
+	}
+
+	return pm;
+}
+
+void fill_model(polymodel* pm)
+{
+	auto tree = model_get_bsp_collision_tree(pm->submodel[0].collision_tree_index);
+
+	tree->n_verts = 3;
+	tree->point_list = (vec3d*)vm_malloc(sizeof(vec3d) * 3);
+	tree->point_list[0] = vec3d{{{0.0f, 0.0f, 0.0f}}};
+	tree->point_list[1] = vec3d{{{1.0f, 0.0f, 0.0f}}};
+	tree->point_list[2] = vec3d{{{0.0f, 1.0f, 0.0f}}};
+
+	tree->n_nodes = 1;
+	tree->node_list = (bsp_collision_node*)vm_malloc(sizeof(bsp_collision_node));
+	tree->node_list[0] = bsp_collision_node{vmd_zero_vector, vec3d{{{1.0f, 1.0f, 0.0f}}}, -1, -1, 0};
+
+	tree->n_leaves = 1;
+	tree->leaf_list = (bsp_collision_leaf*)vm_malloc(sizeof(bsp_collision_leaf));
+	tree->leaf_list[0] = bsp_collision_leaf{vec3d{{{0.0f, 0.0f, 1.0f}}}, 0, 3, 2, -1};
+
+	tree->vert_list = (model_tmap_vert*)vm_malloc(sizeof(model_tmap_vert) * 3);
+	for (uint i = 0; i < 3; ++i) {
+		tree->vert_list[i].vertnum = i;
+		tree->vert_list[i].normnum = 0;
+		tree->vert_list[i].u = 0.25f * i;
+		tree->vert_list[i].v = 0.5f;
+	}
+
+	tree->poly_centers.push_back(vec3d{{{1.0f / 3.0f, 1.0f / 3.0f, 0.0f}}});
+	tree->flat_nodes.push_back(bsp_collision_flat_node{vmd_zero_vector, vec3d{{{1.0f, 1.0f, 0.0f}}}, 1, 0, 1});
+	tree->flat_polys.push_back(bsp_collision_poly{vec3d{{{0.0f, 0.0f, 1.0f}}}, 0, 0, 3, 2});
+	for (int i = 0; i < 3; ++i) {
+		tree->flat_points.push_back(tree->point_list[i]);
+		tree->flat_uvs.push_back(uv_pair{tree->vert_list[i].u, tree->vert_list[i].v});
+	}
+
+	auto sm = &pm->submodel[0];
+	auto model_list = new poly_list;
+	model_list->allocate(3);
+	for (int i = 0; i < 3; ++i) {
+		model_list->vert[i] = vertex();
+		model_list->vert[i].world = tree->point_list[i];
+		model_list->vert[i].texture_position = uv_pair{tree->vert_list[i].u, tree->vert_list[i].v};
+		// never looked at, so the cache leaves it out
+		model_list->vert[i].codes = 42;
+		model_list->norm[i] = vec3d{{{0.0f, 0.0f, 1.0f}}};
+		if (model_list->tsb != nullptr) {
+			model_list->tsb[i] = tsb_t{vec3d{{{1.0f, 0.0f, 0.0f}}}, 1.0f};
+		}
+		model_list->submodels[i] = 0;
+		model_list->sorted_indices[i] = 2 - i;
+	}
+	model_list->n_verts = 3;
+
+	sm->buffer.model_list = model_list;
+	sm->buffer.flags = VB_FLAG_POSITION | VB_FLAG_NORMAL | VB_FLAG_UV1;
+
+	buffer_data tex(3);
+	for (uint i = 0; i < 3; ++i) {
+		tex.assign(i, 2 - i);
+	}
+	tex.texture = 2;
+	sm->buffer.tex_buf.push_back(tex);
+
+	sm->n_verts_outline = 2;
+	sm->outline_buffer = make_shared<vertex[]>(2);
+	sm->outline_buffer[1].world = tree->point_list[1];
+	sm->outline_buffer[1].r = 255;
+}
+
+void free_model(polymodel* pm)
+{
+	for (int i = 0; i < pm->n_models; ++i) {
+		model_remove_bsp_collision_tree(pm->submodel[i].collision_tree_index);
+	}
+	pm->submodel.reset();
+	delete pm;
+}
+}
+
+TEST(ModelCacheTest, round_trip)
+{
+	auto pm = make_model();
+	fill_model(pm);
+
+	SCP_vector<ubyte> data;
+	SCP_vector<size_t> submodel_offsets;
+	model_cache_serialize(pm, KEY, data, &submodel_offsets);
+
+	ASSERT_EQ(2u, submodel_offsets.size());
+	EXPECT_LT(submodel_offsets[0], submodel_offsets[1]);
+
+	auto cached = make_model();
+	ASSERT_TRUE(model_cache_deserialize(cached, KEY, data.data(), data.size()));
+
+	// the second time around produces exactly the same bytes
+	SCP_vector<ubyte> again;
+	model_cache_serialize(cached, KEY, again);
+	EXPECT_EQ(data, again);
+
+	auto tree = model_get_bsp_collision_tree(cached->submodel[0].collision_tree_index);
+	ASSERT_EQ(3, tree->n_verts);
+	EXPECT_EQ(1.0f, tree->point_list[2].xyz.y);
+	ASSERT_EQ(1, tree->n_leaves);
+	EXPECT_EQ(3, tree->leaf_list[0].num_verts);
+	EXPECT_EQ(2, tree->leaf_list[0].tmap_num);
+	EXPECT_EQ(0.5f, tree->vert_list[2].u);
+	EXPECT_EQ(3u, tree->flat_points.size());
+
+	auto empty_tree = model_get_bsp_collision_tree(cached->submodel[1].collision_tree_index);
+	EXPECT_EQ(0, empty_tree->n_verts);
+	EXPECT_EQ(nullptr, empty_tree->node_list);
+	EXPECT_EQ(nullptr, cached->submodel[1].buffer.model_list);
+
+	auto& buffer = cached->submodel[0].buffer;
+	ASSERT_NE(nullptr, buffer.model_list);
+	EXPECT_EQ(3, buffer.model_list->n_verts);
+	EXPECT_EQ(0, buffer.model_list->vert[0].codes);
+	EXPECT_EQ(0.25f, buffer.model_list->vert[1].texture_position.u);
+	EXPECT_EQ(Cmdline_normal != 0, buffer.model_list->tsb != nullptr);
+	EXPECT_EQ(pm->submodel[0].buffer.flags, buffer.flags);
+
+	ASSERT_EQ(1u, buffer.tex_buf.size());
+	EXPECT_EQ(2, buffer.tex_buf[0].texture);
+	EXPECT_EQ(3u, buffer.tex_buf[0].n_verts);
+	EXPECT_EQ(2u, buffer.tex_buf[0].get_index()[0]);
+	EXPECT_EQ(0u, buffer.tex_buf[0].i_first);
+	EXPECT_EQ(2u, buffer.tex_buf[0].i_last);
+
+	ASSERT_EQ(2u, cached->submodel[0].n_verts_outline);
+	EXPECT_EQ(255, cached->submodel[0].outline_buffer[1].r);
+
+	free_model(cached);
+	free_model(pm);
+}
+
+TEST(ModelCacheTest, rejects_broken_data)
+{
+	auto pm = make_model();
+	fill_model(pm);
+
+	SCP_vector<ubyte> data;
+	model_cache_serialize(pm, KEY, data);
+
+	auto cached = make_model();
+	auto untouched = [cached]() {
+		return cached->submodel[0].buffer.model_list == nullptr &&
+		       model_get_bsp_collision_tree(cached->submodel[0].collision_tree_index)->flat_nodes.empty();
+	};
+
+	// a file which was cut off anywhere
+	for (size_t size = 0; size < data.size(); ++size) {
+		EXPECT_FALSE(model_cache_deserialize(cached, KEY, data.data(), size)) << size;
+	}
+	EXPECT_TRUE(untouched());
+
+	// or has something after the end
+	auto longer = data;
+	longer.push_back(0);
+	EXPECT_FALSE(model_cache_deserialize(cached, KEY, longer.data(), longer.size()));
+
+	// or belongs to a different model
+	EXPECT_FALSE(model_cache_deserialize(cached, "fedcba9876543210fedcba9876543210", data.data(), data.size()));
+	EXPECT_TRUE(untouched());
+
+	// or has an index which points outside of its array, or back up the tree
+	const std::function<void(bsp_collision_tree*, bsp_info*)> corruptions[] = {
+		[](bsp_collision_tree* tree, bsp_info*) { tree->node_list[0].front = 1; },
+		[](bsp_collision_tree* tree, bsp_info*) { tree->node_list[0].back = 0; },
+		[](bsp_collision_tree* tree, bsp_info*) { tree->node_list[0].leaf = 1; },
+		[](bsp_collision_tree* tree, bsp_info*) { tree->leaf_list[0].next = 0; },
+		[](bsp_collision_tree* tree, bsp_info*) { tree->vert_list[1].vertnum = 3; },
+		[](bsp_collision_tree* tree, bsp_info*) { tree->flat_nodes[0].skip = 0; },
+		[](bsp_collision_tree* tree, bsp_info*) { tree->flat_nodes[0].skip = 2; },
+		[](bsp_collision_tree* tree, bsp_info*) { tree->flat_nodes[0].n_polys = 2; },
+		[](bsp_collision_tree* tree, bsp_info*) { tree->flat_nodes[0].first_poly = -1; },
+		[](bsp_collision_tree* tree, bsp_info*) { tree->flat_polys[0].leaf = 1; },
+		[](bsp_collision_tree*, bsp_info* sm) { sm->buffer.tex_buf[0].texture = MAX_MODEL_TEXTURES; },
+	};
+
+	for (size_t i = 0; i < sizeof(corruptions) / sizeof(corruptions[0]); ++i) {
+		auto broken = make_model();
+		fill_model(broken);
+		corruptions[i](model_get_bsp_collision_tree(broken->submodel[0].collision_tree_index), &broken->submodel[0]);
+
+		SCP_vector<ubyte> broken_data;
+		model_cache_serialize(broken, KEY, broken_data);
+		EXPECT_FALSE(model_cache_deserialize(cached, KEY, broken_data.data(), broken_data.size())) << i;
+
+		free_model(broken);
+	}
+	EXPECT_TRUE(untouched());
+
+	free_model(cached);
+	free_model(pm);
+}
@@ -0,0 +1,507 @@
+#include <gtest/gtest.h>
+
+#define MODEL_LIB
+
+#include "math/fvi.h"
+#include "model/model.h"
+#include "model/modelsinc.h"
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+extern polymodel* Polygon_models[MAX_POLYGON_MODELS];
+
+namespace {
+struct triangle {
+	int verts[3];
+	vec3d center;
+};
+
+// Writes the BSP chunks of a POF submodel, the same way the POF tools lay them out
+class bsp_writer {
+  public:
+	bsp_writer(const SCP_vector<vec3d>& points, const SCP_vector<triangle>& tris) : m_points(points), m_tris(tris) {}
+
+	SCP_vector<ubyte> write()
+	{
+		write_defpoints();
+
+		SCP_vector<int> all(m_tris.size());
+		for (size_t i = 0; i < all.size(); ++i) {
+			all[i] = (int)i;
+		}
+		write_node(all);
+
+		write_eof();
+		return m_data;
+	}
+
+  private:
+	template <typename T>
+	void put(size_t offset, const T& value)
+	{
+		memcpy(&m_data[offset], &value, sizeof(T));
+	}
+
+	size_t start_chunk(int type, size_t size)
+	{
+		size_t offset = m_data.size();
+		m_data.resize(offset + size);
+		put(offset, type);
+		put(offset + 4, (int)size);
+		return offset;
+	}
+
+	void write_eof() { start_chunk(OP_EOF, 8); }
+
+	void write_defpoints()
+	{
+		const size_t offset = (20 + m_points.size() + 3) & ~(size_t)3;
+		size_t chunk = start_chunk(OP_DEFPOINTS, offset + m_points.size() * sizeof(vec3d));
+
+		put(chunk + 8, (int)m_points.size());
+		put(chunk + 12, 0);
+		put(chunk + 16, (int)offset);
+		// no normals, so all the normal counts stay zero
+		for (size_t i = 0; i < m_points.size(); ++i) {
+			put(chunk + offset + i * sizeof(vec3d), m_points[i]);
+		}
+	}
+
+	void bounds(const SCP_vector<int>& tris, vec3d* min, vec3d* max) const
+	{
+		*min = *max = m_points[m_tris[tris[0]].verts[0]];
+		for (auto tri : tris) {
+			for (auto vert : m_tris[tri].verts) {
+				for (int axis = 0; axis < 3; ++axis) {
+					min->a1d[axis] = std::min(min->a1d[axis], m_points[vert].a1d[axis]);
+					max->a1d[axis] = std::max(max->a1d[axis], m_points[vert].a1d[axis]);
+				}
+			}
+		}
+	}
+
+	void write_node(SCP_vector<int> tris)
+	{
+		vec3d min, max;
+		bounds(tris, &min, &max);
+
+		if (tris.size() <= 6) {
+			size_t chunk = start_chunk(OP_BOUNDBOX, 32);
+			put(chunk + 8, min);
+			put(chunk + 20, max);
+
+			for (auto tri : tris) {
+				const auto& t = m_tris[tri];
+				size_t poly = start_chunk(OP_FLATPOLY, 44 + 3 * 4);
+
+				vec3d normal;
+				vm_vec_normal(&normal, &m_points[t.verts[0]], &m_points[t.verts[1]], &m_points[t.verts[2]]);
+				put(poly + 8, normal);
+				put(poly + 20, t.center);
+				put(poly + 36, 3);
+				for (int i = 0; i < 3; ++i) {
+					put(poly + 44 + i * 4, (short)t.verts[i]);
+				}
+			}
+
+			write_eof();
+			return;
+		}
+
+		// split at the median along the longest side of the box
+		int axis = 0;
+		for (int i = 1; i < 3; ++i) {
+			if (max.a1d[i] - min.a1d[i] > max.a1d[axis] - min.a1d[axis])
+				axis = i;
+		}
+
+		std::sort(tris.begin(), tris.end(), [this, axis](int a, int b) {
+			return m_tris[a].center.a1d[axis] < m_tris[b].center.a1d[axis];
+		});
+
+		SCP_vector<int> back(tris.begin(), tris.begin() + tris.size() / 2);
+		SCP_vector<int> front(tris.begin() + tris.size() / 2, tris.end());
+
+		size_t chunk = start_chunk(OP_SORTNORM2, 40);
+		put(chunk + 16, min);
+		put(chunk + 28, max);
+
+		put(chunk + 8, (int)(m_data.size() - chunk));
+		write_node(front);
+
+		put(chunk + 12, (int)(m_data.size() - chunk));
+		write_node(back);
+	}
+
+	const SCP_vector<vec3d>& m_points;
+	const SCP_vector<triangle>& m_tris;
+	SCP_vector<ubyte> m_data;
+};
+
+// what model_collide() should find for a ray: the closest front-facing polygon, found by checking all of them
+bool reference_ray_hit(const bsp_collision_tree* tree, const vec3d& p0, const vec3d& p1, float* hit_dist, int* hit_leaf)
+{
+	vec3d dir;
+	vm_vec_sub(&dir, &p1, &p0);
+
+	bool found = false;
+	for (int i = 0; i < tree->n_leaves; ++i) {
+		const auto& leaf = tree->leaf_list[i];
+
+		if (vm_vec_dot(&dir, &leaf.plane_norm) > 0.0f)
+			continue;
+
+		vec3d* points[TMAP_MAX_VERTS];
+		for (int j = 0; j < leaf.num_verts; ++j) {
+			points[j] = &tree->point_list[tree->vert_list[leaf.vert_start + j].vertnum];
+		}
+
+		float dist = fvi_ray_plane(nullptr, points[0], &leaf.plane_norm, &p0, &dir, 0.0f);
+		if (dist < 0.0f || dist > 1.0f || (found && dist >= *hit_dist))
+			continue;
+
+		vec3d hit_point;
+		vm_vec_scale_add(&hit_point, &p0, &dir, dist);
+
+		float u, v;
+		if (fvi_point_face(&hit_point, leaf.num_verts, points, &leaf.plane_norm, &u, &v, nullptr)) {
+			found = true;
+			*hit_dist = dist;
+			*hit_leaf = i;
+		}
+	}
+
+	return found;
+}
+}
+
+class ModelCollideTest : public ::testing::Test {
+  protected:
+	void SetUp() override
+	{
+		// a lumpy ball, open at the poles
+		std::mt19937 gen(1);
+		std::uniform_real_distribution<float> bump(-8.0f, 8.0f);
+
+		const int rings = 40, segments = 80;
+		for (int ring = 0; ring < rings; ++ring) {
+			float lat = (-0.45f + 0.9f * ring / (rings - 1)) * PI;
+			for (int seg = 0; seg < segments; ++seg) {
+				float lon = PI2 * seg / segments;
+				float r = 50.0f + bump(gen);
+				m_points.push_back(vm_vec_new(r * cosf(lat) * cosf(lon), r * sinf(lat), r * cosf(lat) * sinf(lon)));
+			}
+		}
+
+		for (int ring = 0; ring + 1 < rings; ++ring) {
+			for (int seg = 0; seg < segments; ++seg) {
+				int a = ring * segments + seg;
+				int b = ring * segments + (seg + 1) % segments;
+				int c = a + segments;
+				int d = b + segments;
+
+				for (auto verts : {std::array<int, 3>{a, c, b}, std::array<int, 3>{b, c, d}}) {
+					triangle tri{{verts[0], verts[1], verts[2]}, vmd_zero_vector};
+					for (auto vert : verts) {
+						tri.center += m_points[vert] / 3.0f;
+					}
+					m_tris.push_back(tri);
+				}
+			}
+		}
+
+		m_bsp_data = bsp_writer(m_points, m_tris).write();
+
+		m_tree_index = model_create_bsp_collision_tree();
+		auto tree = model_get_bsp_collision_tree(m_tree_index);
+
+		Macro_ubyte_bounds = m_bsp_data.data() + m_bsp_data.size();
+		model_collide_parse_bsp(tree, m_bsp_data.data(), 2117);
+		Macro_ubyte_bounds = nullptr;
+
+		ASSERT_EQ((int)m_tris.size(), tree->n_leaves);
+
+		// a model with just that submodel
+		m_model_num = MAX_POLYGON_MODELS - 1;
+		ASSERT_EQ(nullptr, Polygon_models[m_model_num]);
+
+		m_pm = new polymodel();
+		m_pm->id = m_model_num;
+		m_pm->n_models = 1;
+		m_pm->n_detail_levels = 1;
+		m_pm->detail[0] = 0;
+		m_pm->rad = 70.0f;
+		m_pm->mins = vm_vec_new(-70.0f, -70.0f, -70.0f);
+		m_pm->maxs = vm_vec_new(70.0f, 70.0f, 70.0f);
+		m_pm->submodel = make_shared<bsp_info[]>(1);
+		m_pm->submodel[0].rad = m_pm->rad;
+		m_pm->submodel[0].min = m_pm->mins;
+		m_pm->submodel[0].max = m_pm->maxs;
+		m_pm->submodel[0].collision_tree_index = m_tree_index;
+
+		Polygon_models[m_model_num] = m_pm;
+	}
+	void TearDown() override
+	{
+		if (m_model_num >= 0) {
+			Polygon_models[m_model_num] = nullptr;
+		}
+		delete m_pm;
+
+		if (m_tree_index >= 0) {
+			model_remove_bsp_collision_tree(m_tree_index);
+		}
+	}
+
+	// rays from outside of the ball towards somewhere around it, some of which go through the holes at the poles
+	SCP_vector<std::pair<vec3d, vec3d>> random_rays(int count, unsigned seed) const
+	{
+		std::mt19937 gen(seed);
+		std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+		SCP_vector<std::pair<vec3d, vec3d>> rays;
+		for (int i = 0; i < count; ++i) {
+			vec3d from = vm_vec_new(dist(gen), dist(gen), dist(gen));
+			vm_vec_normalize_safe(&from);
+			from *= 100.0f;
+
+			vec3d to = vm_vec_new(dist(gen), dist(gen), dist(gen)) * 60.0f;
+			rays.emplace_back(from, to);
+		}
+		return rays;
+	}
+
+	int collide(const vec3d& p0, const vec3d& p1, int flags, mc_info* mc) const
+	{
+		mc->model_num = m_model_num;
+		mc->orient = &vmd_identity_matrix;
+		mc->pos = &vmd_zero_vector;
+		mc->p0 = &p0;
+		mc->p1 = &p1;
+		mc->flags = flags;
+		return model_collide(mc);
+	}
+
+	SCP_vector<vec3d> m_points;
+	SCP_vector<triangle> m_tris;
+	SCP_vector<ubyte> m_bsp_data;
+
+	int m_tree_index = -1;
+	int m_model_num = -1;
+	polymodel* m_pm = nullptr;
+};
+
+TEST_F(ModelCollideTest, flattened_tree_matches_bsp)
+{
+	auto tree = model_get_bsp_collision_tree(m_tree_index);
+
+	// every polygon shows up exactly once, with the points it had in the original tree
+	ASSERT_EQ((size_t)tree->n_leaves, tree->flat_polys.size());
+
+	SCP_vector<int> seen(tree->n_leaves, 0);
+	for (const auto& poly : tree->flat_polys) {
+		const auto& leaf = tree->leaf_list[poly.leaf];
+		++seen[poly.leaf];
+
+		ASSERT_EQ(leaf.num_verts, poly.num_verts);
+		for (int i = 0; i < poly.num_verts; ++i) {
+			const auto& point = tree->point_list[tree->vert_list[leaf.vert_start + i].vertnum];
+			ASSERT_TRUE(vm_vec_equal(point, tree->flat_points[poly.first_point + i]));
+		}
+	}
+	for (auto count : seen) {
+		ASSERT_EQ(1, count);
+	}
+
+	// every subtree ends where its skip points to, and lies within the box of its root
+	for (size_t i = 0; i < tree->flat_nodes.size(); ++i) {
+		const auto& node = tree->flat_nodes[i];
+		ASSERT_GT(node.skip, (int)i);
+		ASSERT_LE(node.skip, (int)tree->flat_nodes.size());
+
+		for (int child = (int)i + 1; child < node.skip; ++child) {
+			for (int axis = 0; axis < 3; ++axis) {
+				ASSERT_GE(tree->flat_nodes[child].min.a1d[axis], node.min.a1d[axis]);
+				ASSERT_LE(tree->flat_nodes[child].max.a1d[axis], node.max.a1d[axis]);
+			}
+		}
+	}
+}
+
+TEST_F(ModelCollideTest, random_rays_match_reference)
+{
+	auto tree = model_get_bsp_collision_tree(m_tree_index);
+
+	int hits = 0;
+	for (const auto& ray : random_rays(4000, 2)) {
+		float expected_dist = 0.0f;
+		int expected_leaf = -1;
+		bool expected = reference_ray_hit(tree, ray.first, ray.second, &expected_dist, &expected_leaf);
+
+		mc_info mc;
+		bool hit = collide(ray.first, ray.second, MC_CHECK_MODEL, &mc) != 0;
+
+		ASSERT_EQ(expected, hit);
+		if (hit) {
+			++hits;
+			ASSERT_EQ(expected_dist, mc.hit_dist);
+			ASSERT_EQ(&tree->leaf_list[expected_leaf], mc.bsp_leaf);
+			ASSERT_EQ(0, mc.hit_submodel);
+		}
+	}
+
+	// make sure the rays actually hit something, and missed something
+	ASSERT_GT(hits, 1000);
+	ASSERT_LT(hits, 4000);
+}
+
+TEST_F(ModelCollideTest, batch_matches_single_checks)
+{
+	const int flag_sets[] = {MC_CHECK_MODEL, MC_CHECK_MODEL | MC_CHECK_RAY, MC_CHECK_MODEL | MC_CHECK_SPHERELINE,
+		MC_CHECK_MODEL | MC_ONLY_SPHERE, MC_CHECK_MODEL | MC_ONLY_BOUND_BOX, MC_CHECK_SHIELD};
+	const vec3d elsewhere = vm_vec_new(20.0f, 0.0f, 0.0f);
+
+	auto rays = random_rays(600, 4);
+
+	SCP_vector<mc_info> single(rays.size()), batched(rays.size());
+	for (size_t i = 0; i < rays.size(); ++i) {
+		for (auto mc : {&single[i], &batched[i]}) {
+			mc->model_num = m_model_num;
+			mc->orient = &vmd_identity_matrix;
+			mc->pos = (i % 7 == 3) ? &elsewhere : &vmd_zero_vector;
+			mc->p0 = &rays[i].first;
+			mc->p1 = &rays[i].second;
+			mc->flags = flag_sets[i % 6];
+			mc->radius = 0.5f + (i % 5) * 0.5f;
+		}
+	}
+
+	int expected = 0;
+	for (auto& mc : single) {
+		if (model_collide(&mc))
+			++expected;
+	}
+
+	// in batches of different sizes, including a batch of one
+	int actual = 0;
+	for (size_t start = 0, size = 1; start < batched.size(); start += size, size = size * 2 + 1) {
+		SCP_vector<mc_info*> batch;
+		for (size_t i = start; i < MIN(start + size, batched.size()); ++i) {
+			batch.push_back(&batched[i]);
+		}
+		actual += model_collide_batch(batch.data(), (int)batch.size());
+	}
+
+	ASSERT_EQ(expected, actual);
+	ASSERT_GT(expected, 0);
+
+	for (size_t i = 0; i < rays.size(); ++i) {
+		const auto& a = single[i];
+		const auto& b = batched[i];
+
+		ASSERT_EQ(a.num_hits, b.num_hits) << i;
+		ASSERT_EQ(a.hit_dist, b.hit_dist) << i;
+		ASSERT_TRUE(vm_vec_equal(a.hit_point, b.hit_point)) << i;
+		ASSERT_TRUE(vm_vec_equal(a.hit_point_world, b.hit_point_world)) << i;
+		ASSERT_TRUE(vm_vec_equal(a.hit_normal, b.hit_normal)) << i;
+		ASSERT_EQ(a.hit_submodel, b.hit_submodel) << i;
+		ASSERT_EQ(a.hit_bitmap, b.hit_bitmap) << i;
+		ASSERT_EQ(a.edge_hit, b.edge_hit) << i;
+		ASSERT_EQ(a.bsp_leaf, b.bsp_leaf) << i;
+	}
+}
+
+TEST_F(ModelCollideTest, benchmark_rays)
+{
+	using clock = std::chrono::steady_clock;
+
+	auto rays = random_rays(20000, 3);
+	auto tree = model_get_bsp_collision_tree(m_tree_index);
+
+	int sink = 0;
+	auto start = clock::now();
+	for (const auto& ray : rays) {
+		mc_info mc;
+		sink += collide(ray.first, ray.second, MC_CHECK_MODEL, &mc);
+	}
+	auto mid = clock::now();
+	for (const auto& ray : rays) {
+		mc_info mc;
+		mc.radius = 2.0f;
+		sink += collide(ray.first, ray.second, MC_CHECK_MODEL | MC_CHECK_SPHERELINE, &mc);
+	}
+	auto end = clock::now();
+	for (const auto& ray : rays) {
+		float dist;
+		int leaf;
+		sink += reference_ray_hit(tree, ray.first, ray.second, &dist, &leaf) ? 1 : 0;
+	}
+	auto brute = clock::now();
+
+	ASSERT_GT(sink, 0);
+
+	auto to_ns = [&rays](clock::duration d) {
+		return std::chrono::duration<double, std::nano>(d).count() / rays.size();
+	};
+	std::cout << m_tris.size() << " polygons: " << to_ns(mid - start) << " ns per ray, " << to_ns(end - mid)
+	          << " ns per sphere, " << to_ns(brute - end) << " ns per ray checking every polygon" << std::endl;
+}
+
+TEST_F(ModelCollideTest, benchmark_batches)
+{
+	using clock = std::chrono::steady_clock;
+	const size_t batch_size = 16;
+
+	// like a volley from a turret: every batch starts at the same spot and heads for roughly the same area
+	auto scattered = random_rays(20000, 5);
+	auto volleys = scattered;
+	for (size_t i = 0; i < volleys.size(); ++i) {
+		const auto& lead = scattered[i - i % batch_size];
+		volleys[i].first = lead.first;
+		volleys[i].second = lead.second + (scattered[i].second - lead.second) * 0.05f;
+	}
+
+	auto setup = [this](mc_info* mc, const std::pair<vec3d, vec3d>& ray) {
+		mc->model_num = m_model_num;
+		mc->orient = &vmd_identity_matrix;
+		mc->pos = &vmd_zero_vector;
+		mc->p0 = &ray.first;
+		mc->p1 = &ray.second;
+		mc->flags = MC_CHECK_MODEL;
+	};
+
+	for (auto rays : {&scattered, &volleys}) {
+		int sink = 0;
+		auto start = clock::now();
+		for (const auto& ray : *rays) {
+			mc_info mc;
+			setup(&mc, ray);
+			sink += model_collide(&mc) ? 1 : 0;
+		}
+		auto mid = clock::now();
+		for (size_t i = 0; i < rays->size(); i += batch_size) {
+			mc_info batch[batch_size];
+			mc_info* batch_list[batch_size];
+
+			int count = (int)MIN(batch_size, rays->size() - i);
+			for (int j = 0; j < count; ++j) {
+				setup(&batch[j], (*rays)[i + j]);
+				batch_list[j] = &batch[j];
+			}
+			sink -= model_collide_batch(batch_list, count);
+		}
+		auto end = clock::now();
+
+		ASSERT_EQ(0, sink);
+
+		auto to_ns = [rays](clock::duration d) {
+			return std::chrono::duration<double, std::nano>(d).count() / rays->size();
+		};
+		std::cout << (rays == &scattered ? "scattered" : "volleys") << ": " << to_ns(mid - start)
+		          << " ns per ray on its own, " << to_ns(end - mid) << " ns per ray in batches of " << batch_size
+		          << std::endl;
+	}
+}
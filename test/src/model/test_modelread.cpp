@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <globalincs/systemvars.h>
 #include <model/model.h>
 
 #include "util/FSTestFixture.h"
@@ -26,6 +27,7 @@ protected:
 		pm = new polymodel();
 		pmi = new polymodel_instance();
 
+		pm->n_models = 3;
 		pm->submodel = make_shared<bsp_info[]>(3);
 		pmi->submodel = new submodel_instance[3];
 
@@ -98,4 +100,63 @@ TEST_F(SubmodelLocalizeTest, submodel_instance_localize_roundtrip_world) {
 	EXPECT_VECMAT_NEAR(global, (vec3d{ {{-1.0f, 4.0f, 1.0f}} }));
 	EXPECT_VECMAT_NEAR(roundtrip, local);
 	EXPECT_VECMAT_NEAR(roundtripMat, localMat);
-}
\ No newline at end of file
+}
+
+TEST_F(SubmodelLocalizeTest, cached_transforms_follow_changes) {
+	// the previous frame's transforms are never cached, so they can be used to check the cached ones
+	auto sync_last_frame = [this]() {
+		for (int i = 0; i < 3; i++) {
+			pmi->submodel[i].canonical_prev_orient = pmi->submodel[i].canonical_orient;
+			pmi->submodel[i].canonical_prev_offset = pmi->submodel[i].canonical_offset;
+		}
+	};
+	auto expect_up_to_date = [this](const vec3d& local) {
+		vec3d cached, uncached;
+		model_instance_local_to_global_point(&cached, &local, pm, pmi, 2);
+		model_instance_local_to_global_point(&uncached, &local, pm, pmi, 2, nullptr, nullptr, true);
+		EXPECT_VECMAT_NEAR(cached, uncached);
+
+		model_instance_global_to_local_point(&cached, &local, pm, pmi, 2);
+		model_instance_global_to_local_point(&uncached, &local, pm, pmi, 2, nullptr, nullptr, true);
+		EXPECT_VECMAT_NEAR(cached, uncached);
+
+		model_instance_global_to_local_dir(&cached, &local, pm, pmi, 2);
+		model_instance_global_to_local_dir(&uncached, &local, pm, pmi, 2, nullptr, true);
+		EXPECT_VECMAT_NEAR(cached, uncached);
+	};
+
+	const vec3d local{ {{0.5f, 1.0f, -2.0f}} };
+	sync_last_frame();
+	expect_up_to_date(local);
+
+	// the root is where the model's frame of reference is
+	auto root = model_instance_get_submodel_transform(pm, pmi, 0);
+	ASSERT_NE(nullptr, root);
+	EXPECT_EQ(0.0f, vm_vec_mag(&root->offset));
+
+	vec3d before;
+	model_instance_local_to_global_point(&before, &local, pm, pmi, 2);
+
+	// moving the middle submodel without saying so goes unnoticed until the next frame
+	angles ang{ 0.3f, 0.2f, -0.4f };
+	vm_angles_2_matrix(&pmi->submodel[1].canonical_orient, &ang);
+	pmi->submodel[1].canonical_offset = vec3d{ {{1.0f, 0.0f, 2.0f}} };
+	sync_last_frame();
+
+	vec3d stale;
+	model_instance_local_to_global_point(&stale, &local, pm, pmi, 2);
+	EXPECT_VECMAT_NEAR(stale, before);
+
+	submodel_instance_transform_changed(&pmi->submodel[1]);
+	expect_up_to_date(local);
+
+	// and a new frame starts over anyway
+	ang = angles{ -0.7f, 0.0f, 1.1f };
+	vm_angles_2_matrix(&pmi->submodel[1].canonical_orient, &ang);
+	sync_last_frame();
+
+	int old_framecount = Framecount;
+	Framecount++;
+	expect_up_to_date(local);
+	Framecount = old_framecount;
+}
@@ -0,0 +1,319 @@
+#include <gtest/gtest.h>
+
+#include "object/collidebroadphase.h"
+
+#include <chrono>
+#include <random>
+
+namespace {
+
+struct test_collider {
+	vec3d pos;
+	vec3d last_pos;
+	float radius;
+	bool alive;
+};
+
+SCP_vector<test_collider> Test_colliders;
+
+// same rules as obj_get_collider_bounds() uses for weapons, ships etc. are just the degenerate case of that
+void test_get_bounds(int id, collider_broadphase::collider_bounds* bounds)
+{
+	const auto& c = Test_colliders[id];
+	for (int axis = 0; axis < 3; ++axis) {
+		bounds->min.a1d[axis] = std::min(c.pos.a1d[axis], c.last_pos.a1d[axis]) - c.radius;
+		bounds->max.a1d[axis] = std::max(c.pos.a1d[axis], c.last_pos.a1d[axis]) + c.radius;
+	}
+}
+
+float test_get_endpoint(int id, int axis, bool min)
+{
+	collider_broadphase::collider_bounds bounds;
+	test_get_bounds(id, &bounds);
+	return min ? bounds.min.a1d[axis] : bounds.max.a1d[axis];
+}
+
+using pair_set = SCP_set<std::pair<int, int>>;
+
+std::pair<int, int> make_key(int a, int b)
+{
+	return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+}
+
+pair_set brute_force_pairs()
+{
+	pair_set out;
+	for (int i = 0; i < (int)Test_colliders.size(); ++i) {
+		if (!Test_colliders[i].alive)
+			continue;
+		collider_broadphase::collider_bounds a;
+		test_get_bounds(i, &a);
+
+		for (int j = i + 1; j < (int)Test_colliders.size(); ++j) {
+			if (!Test_colliders[j].alive)
+				continue;
+			collider_broadphase::collider_bounds b;
+			test_get_bounds(j, &b);
+
+			bool overlap = true;
+			for (int axis = 0; axis < 3; ++axis) {
+				if (a.min.a1d[axis] > b.max.a1d[axis] || b.min.a1d[axis] > a.max.a1d[axis])
+					overlap = false;
+			}
+			if (overlap)
+				out.insert(make_key(i, j));
+		}
+	}
+	return out;
+}
+
+// The sort and sweep obj_sort_and_collide() used before the persistent broadphase, kept here as a reference
+void three_pass_quicksort(SCP_vector<int>* list, int left, int right, int axis)
+{
+	if (right > left) {
+		int pivot_index = left + (right - left) / 2;
+		float pivot_value = test_get_endpoint((*list)[pivot_index], axis, true);
+
+		std::swap((*list)[pivot_index], (*list)[right]);
+
+		int store_index = left;
+		for (int i = left; i < right; ++i) {
+			if (test_get_endpoint((*list)[i], axis, true) <= pivot_value) {
+				std::swap((*list)[i], (*list)[store_index]);
+				store_index++;
+			}
+		}
+		std::swap((*list)[right], (*list)[store_index]);
+
+		three_pass_quicksort(list, left, store_index - 1, axis);
+		three_pass_quicksort(list, store_index + 1, right, axis);
+	}
+}
+
+void three_pass_find_overlaps(SCP_vector<int>& overlap_list_out, SCP_vector<int>& list, int axis, pair_set* pairs_out)
+{
+	bool first_not_added = true;
+	SCP_vector<int> overlappers;
+
+	for (int in_index : list) {
+		bool overlapped = false;
+		const float min = test_get_endpoint(in_index, axis, true);
+
+		for (size_t j = 0; j < overlappers.size();) {
+			if (min <= test_get_endpoint(overlappers[j], axis, false)) {
+				overlapped = true;
+
+				if (overlappers.size() == 1 && first_not_added) {
+					first_not_added = false;
+					overlap_list_out.push_back(overlappers[j]);
+				}
+
+				if (pairs_out != nullptr)
+					pairs_out->insert(make_key(in_index, overlappers[j]));
+			} else {
+				overlappers[j] = overlappers.back();
+				overlappers.pop_back();
+				continue;
+			}
+			++j;
+		}
+
+		if (overlappers.empty())
+			first_not_added = true;
+		if (overlapped)
+			overlap_list_out.push_back(in_index);
+
+		overlappers.push_back(in_index);
+	}
+}
+
+pair_set three_pass_pairs(SCP_vector<int>& list)
+{
+	pair_set out;
+	SCP_vector<int> sort_list_y, sort_list_z;
+
+	three_pass_quicksort(&list, 0, (int)list.size() - 1, 0);
+	three_pass_find_overlaps(sort_list_y, list, 0, nullptr);
+	three_pass_quicksort(&sort_list_y, 0, (int)sort_list_y.size() - 1, 1);
+	three_pass_find_overlaps(sort_list_z, sort_list_y, 1, nullptr);
+	sort_list_y.clear();
+	three_pass_quicksort(&sort_list_z, 0, (int)sort_list_z.size() - 1, 2);
+	three_pass_find_overlaps(sort_list_y, sort_list_z, 2, &out);
+
+	return out;
+}
+
+pair_set broadphase_pairs(collider_broadphase& broadphase)
+{
+	pair_set out;
+	broadphase.update(test_get_bounds);
+	broadphase.find_overlaps([&out](int a, int b) {
+		EXPECT_TRUE(out.insert(make_key(a, b)).second) << "Pair " << a << "/" << b << " reported twice";
+	});
+	return out;
+}
+
+// a fleet battle in a 20km cube, a few large ships, a lot of fighters and even more weapons
+void generate_scene(std::mt19937& gen, size_t count)
+{
+	std::uniform_real_distribution<float> pos_dist(-10000.0f, 10000.0f);
+	std::uniform_real_distribution<float> vel_dist(-50.0f, 50.0f);
+	std::uniform_int_distribution<int> kind_dist(0, 99);
+
+	Test_colliders.clear();
+	for (size_t i = 0; i < count; ++i) {
+		test_collider c;
+		c.pos.xyz = {pos_dist(gen), pos_dist(gen), pos_dist(gen)};
+		c.last_pos = c.pos;
+		c.alive = true;
+
+		int kind = kind_dist(gen);
+		if (kind < 2) {
+			c.radius = 1000.0f;
+		} else if (kind < 30) {
+			c.radius = 20.0f;
+		} else {
+			c.radius = 1.0f;
+			c.last_pos.xyz = {c.pos.xyz.x - vel_dist(gen), c.pos.xyz.y - vel_dist(gen), c.pos.xyz.z - vel_dist(gen)};
+		}
+		Test_colliders.push_back(c);
+	}
+}
+
+void move_scene(std::mt19937& gen)
+{
+	std::uniform_real_distribution<float> vel_dist(-30.0f, 30.0f);
+
+	for (auto& c : Test_colliders) {
+		c.last_pos = c.pos;
+		c.pos.xyz.x += vel_dist(gen);
+		c.pos.xyz.y += vel_dist(gen);
+		c.pos.xyz.z += vel_dist(gen);
+	}
+}
+
+} // namespace
+
+TEST(CollideBroadphaseTest, matches_brute_force)
+{
+	std::mt19937 gen(1234);
+	generate_scene(gen, 2000);
+
+	collider_broadphase broadphase;
+	for (int i = 0; i < (int)Test_colliders.size(); ++i)
+		broadphase.add(i);
+
+	ASSERT_EQ(Test_colliders.size(), broadphase.size());
+
+	auto expected = brute_force_pairs();
+	ASSERT_FALSE(expected.empty());
+	ASSERT_EQ(expected, broadphase_pairs(broadphase));
+}
+
+TEST(CollideBroadphaseTest, persistent_updates)
+{
+	std::mt19937 gen(4321);
+	generate_scene(gen, 1000);
+
+	collider_broadphase broadphase;
+	for (int i = 0; i < (int)Test_colliders.size(); ++i)
+		broadphase.add(i);
+
+	std::uniform_int_distribution<int> id_dist(0, (int)Test_colliders.size() - 1);
+
+	for (int frame = 0; frame < 50; ++frame) {
+		// kill and revive a few colliders every frame, reusing ids just like object slots get reused
+		for (int k = 0; k < 10; ++k) {
+			int id = id_dist(gen);
+			if (Test_colliders[id].alive) {
+				Test_colliders[id].alive = false;
+				broadphase.remove(id);
+			} else {
+				Test_colliders[id].alive = true;
+				broadphase.add(id);
+			}
+		}
+
+		move_scene(gen);
+
+		ASSERT_EQ(brute_force_pairs(), broadphase_pairs(broadphase)) << "Mismatch in frame " << frame;
+	}
+}
+
+TEST(CollideBroadphaseTest, remove_during_sweep)
+{
+	Test_colliders.clear();
+	for (int i = 0; i < 10; ++i) {
+		test_collider c;
+		c.pos.xyz = {(float)i, 0.0f, 0.0f};
+		c.last_pos = c.pos;
+		c.radius = 5.0f;
+		c.alive = true;
+		Test_colliders.push_back(c);
+	}
+
+	collider_broadphase broadphase;
+	for (int i = 0; i < 10; ++i)
+		broadphase.add(i);
+
+	broadphase.update(test_get_bounds);
+
+	// removing a collider from inside the callback must not report it again
+	int calls = 0;
+	broadphase.find_overlaps([&](int a, int b) {
+		ASSERT_NE(a, 5);
+		ASSERT_NE(b, 5);
+		if (a == 4 || b == 4) {
+			broadphase.remove(5);
+			broadphase.add(10);
+		}
+		++calls;
+	});
+
+	ASSERT_GT(calls, 0);
+	ASSERT_EQ((size_t)10, broadphase.size());
+}
+
+TEST(CollideBroadphaseTest, benchmark_against_three_pass_sort)
+{
+	std::mt19937 gen(5678);
+	generate_scene(gen, 5000);
+
+	collider_broadphase broadphase;
+	SCP_vector<int> list;
+	for (int i = 0; i < (int)Test_colliders.size(); ++i) {
+		broadphase.add(i);
+		list.push_back(i);
+	}
+
+	using clock = std::chrono::steady_clock;
+	clock::duration three_pass_time{}, broadphase_time{};
+	size_t three_pass_count = 0, broadphase_count = 0;
+
+	const int frames = 30;
+	for (int frame = 0; frame < frames; ++frame) {
+		move_scene(gen);
+
+		auto start = clock::now();
+		auto reference = three_pass_pairs(list);
+		auto mid = clock::now();
+		auto result = broadphase_pairs(broadphase);
+		auto end = clock::now();
+
+		three_pass_time += mid - start;
+		broadphase_time += end - mid;
+		three_pass_count += reference.size();
+		broadphase_count += result.size();
+
+		// the three pass sort only filters one axis at a time so it reports a superset of the actual overlaps
+		for (auto& pair : result) {
+			ASSERT_TRUE(reference.count(pair) > 0) << "Pair " << pair.first << "/" << pair.second << " missing from three pass sort";
+		}
+	}
+
+	auto to_ms = [frames](clock::duration d) {
+		return std::chrono::duration<double, std::milli>(d).count() / frames;
+	};
+	std::cout << "Three pass sort: " << three_pass_count / frames << " pairs, " << to_ms(three_pass_time) << " ms per frame" << std::endl;
+	std::cout << "Broadphase:      " << broadphase_count / frames << " pairs, " << to_ms(broadphase_time) << " ms per frame" << std::endl;
+}
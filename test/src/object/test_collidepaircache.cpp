@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include "object/collidepaircache.h"
+
+#include <random>
+
+namespace {
+using reference_map = SCP_map<std::pair<int, int>, int>;
+
+void check_against_reference(collider_pair_cache& cache, const reference_map& reference)
+{
+	ASSERT_EQ(reference.size(), cache.size());
+
+	for (const auto& entry : reference) {
+		auto pair = cache.find(entry.first.first, entry.first.second);
+		ASSERT_NE(nullptr, pair) << "Pair " << entry.first.first << "/" << entry.first.second << " is missing";
+		ASSERT_EQ(entry.second, pair->next_check_time);
+	}
+
+	size_t count = 0;
+	cache.for_each([&count](collider_pair&) { ++count; });
+	ASSERT_EQ(reference.size(), count);
+}
+}
+
+TEST(CollidePairCacheTest, insert_and_find)
+{
+	collider_pair_cache cache;
+
+	bool created;
+	auto pair = cache.find_or_insert(1, 2, &created);
+	ASSERT_TRUE(created);
+	pair->next_check_time = 42;
+
+	pair = cache.find_or_insert(1, 2, &created);
+	ASSERT_FALSE(created);
+	ASSERT_EQ(42, pair->next_check_time);
+
+	// the order of the objects is part of the key
+	ASSERT_EQ(nullptr, cache.find(2, 1));
+	ASSERT_EQ((size_t)1, cache.size());
+
+	cache.remove(1, 2);
+	ASSERT_EQ(nullptr, cache.find(1, 2));
+	ASSERT_EQ((size_t)0, cache.size());
+}
+
+TEST(CollidePairCacheTest, random_operations)
+{
+	collider_pair_cache cache;
+	reference_map reference;
+
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<int> objnum_dist(0, 499);
+	std::uniform_int_distribution<int> op_dist(0, 9);
+
+	for (int i = 0; i < 200000; ++i) {
+		const int a = objnum_dist(gen);
+		const int b = objnum_dist(gen);
+		const int op = op_dist(gen);
+
+		if (op < 6) {
+			bool created;
+			auto pair = cache.find_or_insert(a, b, &created);
+			ASSERT_EQ(reference.count({a, b}) == 0, created);
+			pair->next_check_time = i;
+			reference[{a, b}] = i;
+		} else if (op < 9) {
+			cache.remove(a, b);
+			reference.erase({a, b});
+		} else {
+			cache.remove_object(a);
+			for (auto it = reference.begin(); it != reference.end();) {
+				if (it->first.first == a || it->first.second == a)
+					it = reference.erase(it);
+				else
+					++it;
+			}
+		}
+
+		if (i % 10000 == 0) {
+			check_against_reference(cache, reference);
+		}
+	}
+
+	check_against_reference(cache, reference);
+
+	cache.clear();
+	check_against_reference(cache, {});
+}
+
+TEST(CollidePairCacheTest, pairs_of_object)
+{
+	collider_pair_cache cache;
+	bool created;
+
+	for (int i = 1; i <= 100; ++i) {
+		cache.find_or_insert(0, i, &created)->next_check_time = i;
+		cache.find_or_insert(i, 200, &created)->next_check_time = i;
+	}
+
+	// drop half of the pairs through the other object, object 0 only finds out about that lazily
+	for (int i = 1; i <= 100; i += 2) {
+		cache.remove_object(i);
+	}
+
+	int visited = 0;
+	cache.for_each_pair_of(0, [&visited](collider_pair& pair) {
+		EXPECT_EQ(0, pair.next_check_time % 2);
+		++visited;
+
+		// remove every pair with a multiple of four
+		return pair.next_check_time % 4 != 0;
+	});
+	ASSERT_EQ(50, visited);
+
+	visited = 0;
+	cache.for_each_pair_of(0, [&visited](collider_pair&) {
+		++visited;
+		return true;
+	});
+	ASSERT_EQ(25, visited);
+
+	// 25 left for object 0 and 50 for object 200
+	ASSERT_EQ((size_t)75, cache.size());
+}
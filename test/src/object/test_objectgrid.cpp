@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include "object/object.h"
+#include "object/objectgrid.h"
+
+#include <random>
+
+namespace {
+struct test_object {
+	vec3d pos;
+	float extent;
+};
+
+SCP_vector<int> brute_force_query(const SCP_vector<test_object>& objects, const vec3d& center, float range)
+{
+	SCP_vector<int> result;
+	for (size_t i = 0; i < objects.size(); ++i) {
+		const float max_dist = range + objects[i].extent;
+		if (vm_vec_dist_squared(&center, &objects[i].pos) <= max_dist * max_dist) {
+			result.push_back(static_cast<int>(i));
+		}
+	}
+	return result;
+}
+
+SCP_vector<int> grid_query(const object_grid& grid, const vec3d& center, float range)
+{
+	SCP_vector<int> result;
+	grid.query(center, range, [&result](int objnum) { result.push_back(objnum); });
+	return result;
+}
+}
+
+TEST(ObjectGridTest, matches_brute_force)
+{
+	const int num_objects = 1000;
+
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<float> pos_dist(-20000.0f, 20000.0f);
+	std::uniform_real_distribution<float> extent_dist(5.0f, 500.0f);
+	std::uniform_real_distribution<float> range_dist(0.0f, 6000.0f);
+
+	SCP_vector<test_object> objects;
+	object_grid grid(2000.0f);
+
+	// add the objects in reverse so the order of adding and the object numbers differ
+	for (int i = 0; i < num_objects; ++i) {
+		test_object obj;
+		obj.pos = vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+		obj.extent = extent_dist(gen);
+		objects.push_back(obj);
+	}
+	for (int i = num_objects - 1; i >= 0; --i) {
+		Objects[i].signature = i + 1;
+		grid.add(i, objects[i].pos, objects[i].extent);
+	}
+
+	for (int q = 0; q < 500; ++q) {
+		auto center = vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+		auto range = range_dist(gen);
+
+		auto expected = brute_force_query(objects, center, range);
+		auto actual = grid_query(grid, center, range);
+
+		// results come in the order the objects were added
+		std::reverse(expected.begin(), expected.end());
+		ASSERT_EQ(expected, actual) << "Query " << q;
+	}
+
+	// a range which covers everything ends up looking at all objects
+	ASSERT_EQ((size_t)num_objects, grid_query(grid, vmd_zero_vector, 100000.0f).size());
+
+	grid.clear();
+	ASSERT_TRUE(grid_query(grid, vmd_zero_vector, 100000.0f).empty());
+}
+
+TEST(ObjectGridTest, skips_reused_objects)
+{
+	object_grid grid(1000.0f);
+
+	Objects[0].signature = 10;
+	Objects[1].signature = 11;
+	grid.add(0, vmd_zero_vector, 10.0f);
+	grid.add(1, vmd_zero_vector, 10.0f);
+
+	// object 0 died and its slot was taken by something else, which was then added at a different position
+	Objects[0].signature = 12;
+	auto far_pos = vm_vec_new(5000.0f, 0.0f, 0.0f);
+	grid.add(0, far_pos, 10.0f);
+
+	ASSERT_EQ(SCP_vector<int>{1}, grid_query(grid, vmd_zero_vector, 100.0f));
+	ASSERT_EQ(SCP_vector<int>{0}, grid_query(grid, far_pos, 100.0f));
+}
@@ -1,6 +1,11 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
 #include <parse/parselo.h>
 
 #include "util/FSTestFixture.h"
@@ -62,6 +67,127 @@ TEST_F(ParseloTest, utf8_with_bom) {
 	ASSERT_STREQ(content.c_str(), "Hello World");
 }
 
+TEST_F(ParseloTest, strip_comments) {
+	read_file_text("comments.tbl", CF_TYPE_TABLES);
+	reset_parse();
+
+	ASSERT_STREQ(Parse_text, "#Comments\n"
+		"\n"
+		"$Name: Alpha \n"
+		"$Text: \"quoted ; not a comment\"\n"
+		"\n"
+		" $After: 1\n"
+		" $Other: 2\n"
+		"$Math: 3 * 4 / 5 ! 6\n"
+		" $Versioned: 7\n"
+		"\n"
+		"#End\n");
+
+	// every line of the file is still there, so line numbers match the file
+	skip_to_string("$After:");
+	EXPECT_EQ(6, get_line_num());
+	skip_to_string("$Versioned:");
+	EXPECT_EQ(9, get_line_num());
+	EXPECT_EQ(0, skip_to_string("$Future:"));
+	EXPECT_EQ(12, get_line_num());
+}
+
+namespace {
+// how get_line_num() used to count, by walking the text up to Mp every time
+int reference_line_num()
+{
+	int count = 1;
+	bool inquote = false, incomment = false, multiline = false;
+	const char *stoploc = Mp;
+
+	for (const char *p = Parse_text; p < stoploc && *p != '\0'; ++p) {
+		if (!incomment && (*p == '\"'))
+			inquote = !inquote;
+		if (!incomment && !inquote && (*p == COMMENT_CHAR))
+			incomment = true;
+		if (!incomment && (*p == '/') && (*(p + 1) == '*')) {
+			multiline = true;
+			incomment = true;
+		}
+		if (incomment)
+			stoploc++;
+		if (multiline && (p > Parse_text) && (*(p - 1) == '*') && (*p == '/')) {
+			multiline = false;
+			incomment = false;
+		}
+		if (*p == EOLN) {
+			if (!multiline && incomment)
+				incomment = false;
+			count++;
+		}
+	}
+
+	return count;
+}
+}
+
+TEST(ParseloBenchmark, test_data_tables) {
+	// every table in the test data, over and over until there's a good amount of text
+	SCP_string tables;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(TEST_DATA_PATH)) {
+		auto extension = entry.path().extension().string();
+		if (extension != ".tbl" && extension != ".tbm")
+			continue;
+
+		std::ifstream file(entry.path(), std::ios::binary);
+		std::stringstream contents;
+		contents << file.rdbuf();
+		tables += contents.str();
+		tables += "\n";
+	}
+	ASSERT_FALSE(tables.empty());
+
+	SCP_string raw_text;
+	while (raw_text.size() < 2 * 1024 * 1024)
+		raw_text += tables;
+
+	using clock = std::chrono::steady_clock;
+	auto to_ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+	// the buffers are big enough for sharp s turning into two characters
+	allocate_parse_text(raw_text.size() * 2);
+	memcpy(Parse_text_raw, raw_text.c_str(), raw_text.size());
+
+	auto start = clock::now();
+	process_raw_file_text(Parse_text, Parse_text_raw);
+	auto read_time = clock::now() - start;
+
+	// this goes through every line without finding anything
+	reset_parse();
+	start = clock::now();
+	EXPECT_EQ(0, skip_to_string("$Not in any table:"));
+	auto skip_time = clock::now() - start;
+	EXPECT_EQ('\0', *Mp);
+
+	const int lookups = 100;
+	auto length = strlen(Parse_text);
+	clock::duration line_num_time{}, reference_time{};
+	for (int i = 0; i < lookups; ++i) {
+		Mp = Parse_text + length * i / lookups;
+
+		start = clock::now();
+		auto line_num = get_line_num();
+		auto mid = clock::now();
+		auto reference = reference_line_num();
+		line_num_time += mid - start;
+		reference_time += clock::now() - mid;
+
+		ASSERT_EQ(reference, line_num) << "at " << (Mp - Parse_text);
+	}
+
+	stop_parse();
+
+	auto mb = raw_text.size() / (1024.0 * 1024.0);
+	std::cout << "Reading:       " << mb / (to_ms(read_time) / 1000.0) << " MB/s" << std::endl;
+	std::cout << "Skipping:      " << mb / (to_ms(skip_time) / 1000.0) << " MB/s" << std::endl;
+	std::cout << "Line numbers:  " << to_ms(line_num_time) / lookups << " ms each, " << to_ms(reference_time) / lookups << " ms scanning from the start" << std::endl;
+}
+
 TEST(ParseloUtilTest, drop_trailing_whitespace_cstr) {
 	char test_str[256];
 
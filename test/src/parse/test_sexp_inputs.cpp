@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include "globalincs/safe_strings.h"
+#include "parse/parselo.h"
+#include "parse/sexp.h"
+
+namespace {
+int parse_formula(const char* formula)
+{
+	char buf[512];
+	strcpy_s(buf, formula);
+
+	Mp = buf;
+	int node = get_sexp_main();
+	Mp = nullptr;
+
+	return node;
+}
+
+int formula_inputs(const char* formula)
+{
+	int node = parse_formula(formula);
+	EXPECT_GE(node, 0) << formula;
+
+	return sexp_get_formula_inputs(node);
+}
+}
+
+TEST(SexpInputsTest, formula_inputs)
+{
+	init_sexp();
+
+	EXPECT_EQ(0, formula_inputs("( and ( true ) ( < 1 ( + 2 3 ) ) )"));
+	EXPECT_EQ(SEXP_INPUT_MISSION_LOG | SEXP_INPUT_SHIPS, formula_inputs("( is-destroyed-delay 0 \"Alpha 1\" \"Beta\" )"));
+	EXPECT_EQ(SEXP_INPUT_MISSION_LOG | SEXP_INPUT_SHIPS,
+		formula_inputs("( or ( has-arrived-delay 0 \"Alpha\" ) ( is-subsystem-destroyed-delay \"Beta 1\" \"engine\" 0 ) )"));
+	EXPECT_EQ(SEXP_INPUT_EVENTS | SEXP_INPUT_MISSION_LOG,
+		formula_inputs("( and ( is-event-true-delay \"Start\" 0 ) ( not ( is-goal-true-delay \"Escort\" 0 ) ) )"));
+
+	// only the condition of a top-level when is looked at
+	EXPECT_EQ(SEXP_INPUT_EVENTS, formula_inputs("( when ( is-event-true-delay \"Start\" 0 ) ( send-message \"a\" \"b\" \"c\" ) )"));
+
+	// any delay or anything else which depends on time has to be evaluated every time
+	EXPECT_EQ(SEXP_INPUT_VOLATILE, formula_inputs("( is-destroyed-delay 5 \"Alpha 1\" )"));
+	EXPECT_EQ(SEXP_INPUT_VOLATILE, formula_inputs("( is-event-true-delay \"Start\" 3 )"));
+	EXPECT_EQ(SEXP_INPUT_VOLATILE, formula_inputs("( and ( true ) ( has-time-elapsed 10 ) )"));
+
+	// a nested when runs its actions whenever its condition is true, regardless of what the event does
+	EXPECT_EQ(0, formula_inputs("( when ( true ) ( do-nothing ) )"));
+	EXPECT_EQ(SEXP_INPUT_VOLATILE, formula_inputs("( and ( when ( true ) ( do-nothing ) ) ( false ) )"));
+
+	init_sexp();
+}
+
+TEST(SexpInputsTest, stamp_follows_changes)
+{
+	auto log_stamp = sexp_input_stamp(SEXP_INPUT_MISSION_LOG);
+	auto ships_stamp = sexp_input_stamp(SEXP_INPUT_SHIPS | SEXP_INPUT_VARIABLES);
+	auto none_stamp = sexp_input_stamp(0);
+
+	EXPECT_NE(0u, log_stamp);
+	EXPECT_NE(0u, none_stamp);
+
+	sexp_input_changed(SEXP_INPUT_MISSION_LOG);
+	EXPECT_NE(log_stamp, sexp_input_stamp(SEXP_INPUT_MISSION_LOG));
+	EXPECT_EQ(ships_stamp, sexp_input_stamp(SEXP_INPUT_SHIPS | SEXP_INPUT_VARIABLES));
+
+	sexp_input_changed(SEXP_INPUT_VARIABLES);
+	EXPECT_NE(ships_stamp, sexp_input_stamp(SEXP_INPUT_SHIPS | SEXP_INPUT_VARIABLES));
+	EXPECT_EQ(none_stamp, sexp_input_stamp(0));
+}
@@ -0,0 +1,333 @@
+#include <gtest/gtest.h>
+
+#include "globalincs/safe_strings.h"
+#include "mission/missiongoals.h"
+#include "parse/parselo.h"
+#include "parse/sexp.h"
+#include "ship/ship.h"
+
+#include <random>
+
+namespace {
+// formulas which can be evaluated without a mission, covering nesting, short-circuiting and when-argument trees
+const char* Formulas[] = {
+	"( and ( true ) ( < 1 2 ) )",
+	"( and ( false ) ( < 1 2 ) )",
+	"( or ( false ) ( = 3 ( + 1 2 ) ) )",
+	"( not ( > ( * 2 3 ) ( - 10 ( / 8 2 ) ) ) )",
+	"( xor ( true ) ( < 5 ( mod 7 4 ) ) )",
+	"( = ( min 4 ( abs -2 ) 9 ) 2 )",
+	"( when ( or ( false ) ( true ) ) ( do-nothing ) )",
+	"( when-argument ( any-of \"1\" \"2\" \"3\" ) ( < \"<argument>\" 3 ) ( do-nothing ) )",
+	"( when-argument ( every-of \"4\" \"5\" ) ( > ( + \"<argument>\" 1 ) 4 ) ( do-nothing ) ( do-nothing ) )",
+	"( every-time-argument ( number-of 1 \"7\" \"8\" ) ( and ( true ) ( = \"<argument>\" 8 ) ) ( do-nothing ) )",
+};
+
+const char* Junk_formula = "( and ( < 1 2 ) ( > 3 4 ) ( or ( true ) ( false ) ) )";
+
+int parse_formula(const char* formula)
+{
+	char buf[512];
+	strcpy_s(buf, formula);
+
+	Mp = buf;
+	int node = get_sexp_main();
+	Mp = nullptr;
+
+	return node;
+}
+
+// Parses the formulas with a freed tree in the middle, so that there are unused nodes which still have their old links
+SCP_vector<int> parse_formulas()
+{
+	init_sexp();
+
+	SCP_vector<int> roots;
+	const auto half = sizeof(Formulas) / sizeof(Formulas[0]) / 2;
+
+	for (size_t i = 0; i < half; ++i) {
+		roots.push_back(parse_formula(Formulas[i]));
+	}
+	int junk = parse_formula(Junk_formula);
+	for (size_t i = half; i < sizeof(Formulas) / sizeof(Formulas[0]); ++i) {
+		roots.push_back(parse_formula(Formulas[i]));
+	}
+	free_sexp2(junk);
+
+	for (auto root : roots) {
+		EXPECT_GE(root, 0);
+	}
+
+	return roots;
+}
+
+// what find_sexp_list(), find_parent_operator() and is_sexp_top_level() computed before they had an index
+int reference_find_sexp_list(int num)
+{
+	for (int i = 0; i < Num_sexp_nodes; i++) {
+		if (Sexp_nodes[i].first == num)
+			return i;
+	}
+	return -1;
+}
+
+// the old links of freed nodes can go around in circles, which is reported as -2 instead of looping forever
+int reference_find_parent_operator(int node)
+{
+	if (Sexp_nodes[node].subtype == SEXP_ATOM_OPERATOR) {
+		node = reference_find_sexp_list(node);
+		if (node < 0)
+			return -1;
+	}
+
+	for (int steps = 0; Sexp_nodes[node].subtype != SEXP_ATOM_OPERATOR; ++steps) {
+		if (steps > Num_sexp_nodes)
+			return -2;
+
+		int i;
+		for (i = 0; i < Num_sexp_nodes; i++) {
+			if (Sexp_nodes[i].rest == node)
+				break;
+		}
+		if (i == Num_sexp_nodes)
+			return -1;
+		node = i;
+	}
+
+	return node;
+}
+
+int reference_is_sexp_top_level(int node)
+{
+	if (Sexp_nodes[node].type == SEXP_NOT_USED)
+		return 0;
+
+	for (int i = 0; i < Num_sexp_nodes; i++) {
+		if ((Sexp_nodes[i].type == SEXP_NOT_USED) || (i == node))
+			continue;
+		if ((Sexp_nodes[i].first == node) || (Sexp_nodes[i].rest == node))
+			return 0;
+	}
+
+	return 1;
+}
+
+void expect_links_match(const char* when)
+{
+	EXPECT_EQ(reference_find_sexp_list(-1), find_sexp_list(-1)) << when;
+
+	for (int i = 0; i < Num_sexp_nodes; ++i) {
+		EXPECT_EQ(reference_find_sexp_list(i), find_sexp_list(i)) << "Node " << i << " " << when;
+		EXPECT_EQ(reference_is_sexp_top_level(i), is_sexp_top_level(i)) << "Node " << i << " " << when;
+
+		// freed nodes included, since nothing stops anyone from asking about them
+		int parent = reference_find_parent_operator(i);
+		if (parent != -2) {
+			EXPECT_EQ(parent, find_parent_operator(i)) << "Node " << i << " " << when;
+		} else {
+			EXPECT_EQ(SEXP_NOT_USED, Sexp_nodes[i].type) << "Node " << i << " " << when;
+		}
+	}
+}
+
+// the node with the given text among the arguments of the given operator
+int find_argument(const char* op_text, const char* text)
+{
+	for (int i = 0; i < Num_sexp_nodes; ++i) {
+		if (Sexp_nodes[i].type == SEXP_NOT_USED || Sexp_nodes[i].subtype != SEXP_ATOM_OPERATOR || strcmp(Sexp_nodes[i].text, op_text) != 0)
+			continue;
+
+		for (int node = CDR(i); node >= 0; node = CDR(node)) {
+			if (!strcmp(Sexp_nodes[node].text, text))
+				return node;
+		}
+	}
+	return -1;
+}
+
+int cached_type(int node)
+{
+	return Sexp_nodes[node].cache ? Sexp_nodes[node].cache->sexp_node_data_type : OPF_NONE;
+}
+
+struct evaluation_record {
+	SCP_vector<int> results;
+	SCP_vector<int> values;
+	SCP_vector<int> flags;
+	SCP_vector<SCP_string> log;
+};
+
+// Evaluates all formulas for a few frames with event logging on and records everything the evaluator leaves behind
+evaluation_record evaluate_formulas(const SCP_vector<int>& roots)
+{
+	evaluation_record record;
+
+	SCP_vector<SCP_string> log, variable_log, container_log, argument_log;
+	Current_event_log_buffer = &log;
+	Current_event_log_variable_buffer = &variable_log;
+	Current_event_log_container_buffer = &container_log;
+	Current_event_log_argument_buffer = &argument_log;
+	Log_event = true;
+
+	for (int frame = 0; frame < 3; ++frame) {
+		for (auto root : roots) {
+			record.results.push_back(eval_sexp(root));
+		}
+	}
+
+	Log_event = false;
+	Current_event_log_buffer = nullptr;
+	Current_event_log_variable_buffer = nullptr;
+	Current_event_log_container_buffer = nullptr;
+	Current_event_log_argument_buffer = nullptr;
+
+	for (int i = 0; i < Num_sexp_nodes; ++i) {
+		if (Sexp_nodes[i].type == SEXP_NOT_USED)
+			continue;
+
+		record.values.push_back(Sexp_nodes[i].value);
+		record.flags.push_back(Sexp_nodes[i].flags);
+	}
+
+	record.log = log;
+	record.log.insert(record.log.end(), argument_log.begin(), argument_log.end());
+
+	return record;
+}
+}
+
+TEST(SexpPrecomputeTest, links_match_scans)
+{
+	parse_formulas();
+
+	sexp_precompute_nodes();
+	expect_links_match("after precomputing");
+
+	// trees which are built and torn down during the mission have to be picked up as well
+	int extra = parse_formula(Junk_formula);
+	expect_links_match("after adding a tree");
+
+	free_sexp2(extra);
+	expect_links_match("after freeing a tree");
+
+	init_sexp();
+}
+
+TEST(SexpPrecomputeTest, links_match_scans_after_edits)
+{
+	auto roots = parse_formulas();
+	sexp_precompute_nodes();
+
+	const auto num_formulas = sizeof(Formulas) / sizeof(Formulas[0]);
+	std::mt19937 random(1234);
+
+	for (int round = 0; round < 40; ++round) {
+		// cut an argument out of its list, which relinks the node in front of it and leaves the freed one pointing on
+		SCP_vector<int> owners;
+		for (int i = 0; i < Num_sexp_nodes; ++i) {
+			int rest = Sexp_nodes[i].rest;
+			if (Sexp_nodes[i].type != SEXP_NOT_USED && rest >= 0 && Sexp_nodes[rest].type != SEXP_NOT_USED &&
+				rest != Locked_sexp_true && rest != Locked_sexp_false)
+				owners.push_back(i);
+		}
+		if (!owners.empty()) {
+			int owner = owners[random() % owners.size()];
+			free_sexp(Sexp_nodes[owner].rest, owner);
+		}
+		expect_links_match("after cutting out an argument");
+
+		// replace a whole formula, which reuses freed nodes that still have their old links
+		auto& root = roots[random() % roots.size()];
+		free_sexp2(root);
+		expect_links_match("after freeing a formula");
+
+		root = parse_formula(Formulas[random() % num_formulas]);
+		ASSERT_GE(root, 0);
+		expect_links_match("after parsing a formula");
+	}
+
+	init_sexp();
+}
+
+TEST(SexpPrecomputeTest, references_match_lazy_resolution)
+{
+	init_sexp();
+
+	Ship_registry.emplace_back("Alpha 1");
+	Ship_registry_map.emplace("Alpha 1", (int)Ship_registry.size() - 1);
+	strcpy_s(Wings[0].name, "Beta");
+	Num_wings = 1;
+	int limit = sexp_add_variable("50", "limit", SEXP_VARIABLE_NUMBER, -1);
+	ASSERT_GE(limit, 0);
+
+	ASSERT_GE(parse_formula("( when ( < ( hits-left \"Alpha 1\" ) @limit[50] ) ( cancel-future-waves \"Beta\" \"Gamma\" ) "
+		"( protect-ship \"Nobody\" ) )"), 0);
+	ASSERT_GE(parse_formula("( when-argument ( any-of \"Alpha 1\" ) ( < ( hits-left \"<argument>\" ) 50 ) ( do-nothing ) )"), 0);
+
+	sexp_precompute_nodes();
+	sexp_precompute_references();
+
+	// known names are cached as their first lookup would have cached them
+	int ship_node = find_argument("hits-left", "Alpha 1");
+	ASSERT_GE(ship_node, 0);
+	ASSERT_EQ(OPF_SHIP, cached_type(ship_node));
+	EXPECT_EQ((int)Ship_registry.size() - 1, Sexp_nodes[ship_node].cache->ship_registry_index);
+	EXPECT_EQ(&Ship_registry.back(), eval_ship(ship_node));
+
+	int wing_node = find_argument("cancel-future-waves", "Beta");
+	ASSERT_GE(wing_node, 0);
+	ASSERT_EQ(OPF_WING, cached_type(wing_node));
+	EXPECT_EQ(&Wings[0], eval_wing(wing_node));
+
+	int variable_node = find_argument("<", std::to_string(limit).c_str());
+	ASSERT_GE(variable_node, 0);
+	EXPECT_EQ(limit, Sexp_nodes[variable_node].cached_variable_index);
+
+	// unknown names may still turn up later, and arguments or anything but ships and wings are left alone
+	EXPECT_EQ(OPF_NONE, cached_type(find_argument("cancel-future-waves", "Gamma")));
+	EXPECT_EQ(OPF_NONE, cached_type(find_argument("protect-ship", "Nobody")));
+	EXPECT_EQ(OPF_NONE, cached_type(find_argument("hits-left", "<argument>")));
+	EXPECT_EQ(OPF_NONE, cached_type(find_argument("any-of", "Alpha 1")));
+	EXPECT_EQ(OPF_NONE, cached_type(find_argument("<", "50")));
+
+	Ship_registry.pop_back();
+	Ship_registry_map.erase("Alpha 1");
+	Wings[0].name[0] = '\0';
+	Num_wings = 0;
+	init_sexp();
+}
+
+TEST(SexpPrecomputeTest, evaluation_matches_lazy_evaluation)
+{
+	auto lazy = evaluate_formulas(parse_formulas());
+
+	auto roots = parse_formulas();
+	sexp_precompute_nodes();
+	auto precomputed = evaluate_formulas(roots);
+
+	ASSERT_EQ(lazy.results, precomputed.results);
+	ASSERT_EQ(lazy.values, precomputed.values);
+	ASSERT_EQ(lazy.log, precomputed.log);
+
+	// precomputing resolves the when-argument flags of nodes which were never evaluated, everything that was needs to
+	// agree
+	const int when_arg_flags = SNF_DESCENDANT_OF_WHEN_ARG_OP | SNF_NOT_DESCENDANT_OF_WHEN_ARG_OP;
+	ASSERT_EQ(lazy.flags.size(), precomputed.flags.size());
+	for (size_t i = 0; i < lazy.flags.size(); ++i) {
+		ASSERT_EQ(lazy.flags[i] & ~when_arg_flags, precomputed.flags[i] & ~when_arg_flags) << "Node " << i;
+
+		if (lazy.flags[i] & when_arg_flags) {
+			ASSERT_EQ(lazy.flags[i] & when_arg_flags, precomputed.flags[i] & when_arg_flags) << "Node " << i;
+		}
+	}
+
+	// make sure the formulas actually exercised the short-circuit paths
+	bool found_known = false;
+	for (auto value : precomputed.values) {
+		if (value == SEXP_KNOWN_TRUE || value == SEXP_KNOWN_FALSE)
+			found_known = true;
+	}
+	ASSERT_TRUE(found_known);
+
+	init_sexp();
+}
@@ -0,0 +1,198 @@
+#include "cmdline/cmdline.h"
+#include "particle/ParticleEffect.h"
+#include "particle/ParticleManager.h"
+#include "particle/particle.h"
+#include "render/3d.h"
+#include "utils/threading.h"
+
+#include "util/FSTestFixture.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+class ParticleTest : public test::FSTestFixture {
+  public:
+	ParticleTest() : test::FSTestFixture(INIT_CFILE) {}
+
+  protected:
+	void SetUp() override
+	{
+		test::FSTestFixture::SetUp();
+
+		// there are no graphics, so pretend the legacy bitmaps are already there
+		particle::Anim_bitmap_id_fire = 0;
+		particle::Anim_bitmap_id_smoke = 0;
+		particle::Anim_bitmap_id_smoke2 = 0;
+
+		particle::ParticleManager::init();
+		m_effect = particle::ParticleManager::get()->addEffect(particle::ParticleEffect("Test"));
+
+		// keep everything from being culled
+		m_old_detail = Detail.num_particles;
+		Detail.num_particles = static_cast<int>(DefaultDetailPreset::Num_detail_presets);
+		Eye_position = vmd_zero_vector;
+	}
+	void TearDown() override
+	{
+		particle::kill_all();
+		particle::ParticleManager::shutdown();
+
+		particle::Anim_bitmap_id_fire = -1;
+		particle::Anim_bitmap_id_smoke = -1;
+		particle::Anim_bitmap_id_smoke2 = -1;
+		Detail.num_particles = m_old_detail;
+
+		test::FSTestFixture::TearDown();
+	}
+
+	particle::particle make_particle(const vec3d& pos, const vec3d& vel, float max_life, bool looping = false) const
+	{
+		particle::particle part{};
+		part.pos = pos;
+		part.velocity = vel;
+		part.age = 0.0f;
+		part.max_life = max_life;
+		part.looping = looping;
+		part.radius = 1.0f;
+		part.bitmap = 0;
+		part.nframes = 1;
+		part.parent_effect = {m_effect, 0};
+		return part;
+	}
+
+	particle::ParticleEffectHandle m_effect;
+	int m_old_detail = 0;
+};
+
+TEST_F(ParticleTest, drifting_particles_expire_like_others)
+{
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<float> pos_dist(-50.0f, 50.0f);
+	std::uniform_int_distribution<int> life_dist(0, 20);
+
+	// every particle is created once through the regular path and once as a persistent particle, which is always moved
+	// one particle at a time
+	SCP_vector<particle::WeakParticlePtr> persistent;
+	for (int i = 0; i < 1000; ++i) {
+		auto pos = vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+		auto vel = vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+		float max_life = life_dist(gen) * 0.05f;
+		bool looping = (i % 50) == 0;
+
+		particle::create(make_particle(pos, vel, max_life, looping));
+		persistent.push_back(particle::createPersistent(make_particle(pos, vel, max_life, looping)));
+	}
+
+	ASSERT_EQ((size_t)2000, particle::get_particle_count());
+
+	for (int frame = 0; frame < 40; ++frame) {
+		particle::move_all(0.033f);
+
+		size_t persistent_alive = 0;
+		for (auto& part : persistent) {
+			if (!part.expired())
+				++persistent_alive;
+		}
+
+		ASSERT_EQ(persistent_alive * 2, particle::get_particle_count()) << "Frame " << frame;
+	}
+
+	// only the looping ones are left
+	ASSERT_EQ((size_t)40, particle::get_particle_count());
+}
+
+TEST_F(ParticleTest, threaded_frames_match_serial)
+{
+	// the same particles moved for the same frames, recording the count and where every persistent particle is
+	auto run = [this](bool threaded) {
+		Cmdline_threaded_particles = threaded;
+
+		std::mt19937 gen(3);
+		std::uniform_real_distribution<float> pos_dist(-50.0f, 50.0f);
+		std::uniform_int_distribution<int> life_dist(0, 30);
+
+		SCP_vector<particle::WeakParticlePtr> persistent;
+		for (int i = 0; i < 5000; ++i) {
+			auto pos = vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+			auto vel = vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+			float max_life = life_dist(gen) * 0.05f;
+
+			particle::create(make_particle(pos, vel, max_life, (i % 100) == 0));
+			persistent.push_back(particle::createPersistent(make_particle(pos, vel, max_life * 0.5f, (i % 70) == 0)));
+		}
+
+		SCP_vector<float> record;
+		for (int frame = 0; frame < 40; ++frame) {
+			particle::move_all(0.033f);
+
+			record.push_back(static_cast<float>(particle::get_particle_count()));
+			for (auto& handle : persistent) {
+				if (auto part = handle.lock()) {
+					record.insert(record.end(), {part->pos.xyz.x, part->pos.xyz.y, part->pos.xyz.z, part->age});
+				} else {
+					record.push_back(-1.0f);
+				}
+			}
+		}
+
+		particle::kill_all();
+		return record;
+	};
+
+	auto old_threads = Cmdline_multithreading;
+	auto old_threaded = Cmdline_threaded_particles;
+	Cmdline_multithreading = 4;
+	threading::init_task_pool();
+
+	auto serial = run(false);
+	auto threaded = run(true);
+
+	threading::shut_down_task_pool();
+	Cmdline_multithreading = old_threads;
+	Cmdline_threaded_particles = old_threaded;
+
+	ASSERT_EQ(serial, threaded);
+}
+
+TEST_F(ParticleTest, benchmark_move_100k)
+{
+	using clock = std::chrono::steady_clock;
+
+	const int num_particles = 100000;
+	const int frames = 60;
+
+	std::mt19937 gen(2);
+	std::uniform_real_distribution<float> pos_dist(-50.0f, 50.0f);
+
+	auto run = [&](bool persistent) {
+		SCP_vector<particle::WeakParticlePtr> handles;
+
+		auto start = clock::now();
+		for (int i = 0; i < num_particles; ++i) {
+			auto part = make_particle(vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen)), vm_vec_new(pos_dist(gen), pos_dist(gen), pos_dist(gen)), 10.0f + i * 1e-5f);
+			if (persistent)
+				handles.push_back(particle::createPersistent(std::move(part)));
+			else
+				particle::create(std::move(part));
+		}
+		auto spawned = clock::now();
+
+		for (int frame = 0; frame < frames; ++frame) {
+			particle::move_all(0.016f);
+		}
+		auto end = clock::now();
+
+		EXPECT_EQ((size_t)num_particles, particle::get_particle_count());
+		particle::kill_all();
+
+		return std::make_pair(spawned - start, end - spawned);
+	};
+
+	auto regular = run(false);
+	auto persistent = run(true);
+
+	auto to_ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+	std::cout << "Regular particles:    spawn " << to_ms(regular.first) << " ms, " << to_ms(regular.second) / frames << " ms per frame" << std::endl;
+	std::cout << "Persistent particles: spawn " << to_ms(persistent.first) << " ms, " << to_ms(persistent.second) / frames << " ms per frame" << std::endl;
+}
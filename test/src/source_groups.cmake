@@ -33,6 +33,10 @@ if (FSO_BUILD_WITH_VULKAN)
 	)
 endif()
 
+add_file_folder("Lighting"
+    lighting/test_lighting.cpp
+)
+
 add_file_folder("Math"
     math/test_vecmat.cpp
 )
@@ -41,17 +45,35 @@ add_file_folder("menuui"
     menuui/test_intel_parse.cpp
 )
 
+add_file_folder("Mission"
+    mission/test_missionlog.cpp
+)
+
 add_file_folder("mod"
     mod/test_mod_table.cpp
 )
 
 add_file_folder("model"
+    model/test_modelcache.cpp
+    model/test_modelcollide.cpp
     model/test_modelread.cpp
 )
 
+add_file_folder("Object"
+    object/test_collidebroadphase.cpp
+    object/test_collidepaircache.cpp
+    object/test_objectgrid.cpp
+)
+
 add_file_folder("Parse"
     parse/test_parselo.cpp
     parse/test_replace.cpp
+    parse/test_sexp_inputs.cpp
+    parse/test_sexp_precompute.cpp
+)
+
+add_file_folder("Particle"
+    particle/test_particle.cpp
 )
 
 add_file_folder("Pilotfile"
@@ -95,6 +117,8 @@ add_file_folder("Test Util"
 
 add_file_folder("Utils"
     utils/HeapAllocatorTest.cpp
+    utils/test_name_index.cpp
+    utils/test_threading.cpp
 )
 
 add_file_folder("Weapon"
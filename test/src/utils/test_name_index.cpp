@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+
+#include "object/object.h"
+#include "parse/sexp.h"
+#include "ship/ship.h"
+#include "utils/name_index.h"
+#include "weapon/weapon.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+// puts everything with the same length into the same bucket, to make sure the names are still told apart
+struct length_hash {
+	size_t operator()(const char* name) const { return strlen(name); }
+};
+
+template <typename Hash>
+int find_name(const util::name_index<Hash>& index, const SCP_vector<SCP_string>& names, const char* name)
+{
+	return index.find(name, [&names, name](int i) { return !stricmp(names[i].c_str(), name); });
+}
+
+SCP_vector<SCP_string> make_names(const char* prefix, int count)
+{
+	SCP_vector<SCP_string> names;
+	for (int i = 0; i < count; ++i) {
+		names.push_back(SCP_string(prefix) + " " + std::to_string(i));
+	}
+	return names;
+}
+
+// Times looking up every name, in its own case and in uppercase, plus as many missing ones with the old linear scan
+// and with the lookup function, and checks that both agree
+template <typename Linear, typename Lookup>
+void benchmark_lookup(const char* what, const SCP_vector<SCP_string>& names, Linear linear, Lookup lookup)
+{
+	SCP_vector<SCP_string> queries;
+	for (const auto& name : names) {
+		SCP_string upper = name;
+		SCP_toupper(upper);
+
+		queries.push_back(name);
+		queries.push_back(upper);
+		queries.push_back(name + " (missing)");
+	}
+
+	std::mt19937 gen(1);
+	std::shuffle(queries.begin(), queries.end(), gen);
+
+	for (const auto& query : queries) {
+		ASSERT_EQ(linear(query.c_str()), lookup(query.c_str())) << what << ": " << query;
+	}
+
+	using clock = std::chrono::steady_clock;
+	const int rounds = 20;
+	int sink = 0;
+
+	auto start = clock::now();
+	for (int r = 0; r < rounds; ++r) {
+		for (const auto& query : queries) {
+			sink += linear(query.c_str());
+		}
+	}
+	auto mid = clock::now();
+	for (int r = 0; r < rounds; ++r) {
+		for (const auto& query : queries) {
+			sink -= lookup(query.c_str());
+		}
+	}
+	auto end = clock::now();
+
+	ASSERT_EQ(0, sink);
+
+	auto to_ns = [&queries](clock::duration d) {
+		return std::chrono::duration<double, std::nano>(d).count() / (rounds * queries.size());
+	};
+	std::cout << what << " (" << names.size() << " names): " << to_ns(mid - start) << " ns per linear scan, "
+	          << to_ns(end - mid) << " ns per indexed lookup" << std::endl;
+}
+}
+
+TEST(NameIndexTest, find_set_remove)
+{
+	SCP_vector<SCP_string> names = {"Alpha 1", "Beta 1", "alpha 1", "Gamma 2", "Delta 3"};
+
+	util::name_index<> index;
+	for (int i = 0; i < (int)names.size(); ++i) {
+		index.set(i, names[i].c_str());
+	}
+
+	// duplicates resolve to the lowest index, just like a scan would
+	EXPECT_EQ(0, find_name(index, names, "ALPHA 1"));
+	EXPECT_EQ(3, find_name(index, names, "gamma 2"));
+	EXPECT_EQ(-1, find_name(index, names, "Epsilon"));
+	EXPECT_EQ(2, index.find("Alpha 1", [](int i) { return i > 0; }));
+
+	index.remove(0);
+	EXPECT_EQ(2, find_name(index, names, "Alpha 1"));
+
+	// renaming moves an entry from one name to the other
+	names[3] = "Epsilon";
+	index.set(3, names[3].c_str());
+	EXPECT_EQ(3, find_name(index, names, "EPSILON"));
+	EXPECT_EQ(-1, index.find("Gamma 2", [](int) { return true; }));
+
+	// removing twice, or something which was never there, doesn't do anything
+	index.remove(0);
+	index.remove(42);
+	EXPECT_EQ(4, find_name(index, names, "Delta 3"));
+
+	index.clear();
+	EXPECT_EQ(-1, find_name(index, names, "Delta 3"));
+}
+
+TEST(NameIndexTest, colliding_hashes)
+{
+	SCP_vector<SCP_string> names = {"Alpha", "Gamma", "Delta", "Omega", "Sigma"};
+
+	util::name_index<length_hash> index;
+	for (int i = (int)names.size() - 1; i >= 0; --i) {
+		index.set(i, names[i].c_str());
+	}
+
+	for (int i = 0; i < (int)names.size(); ++i) {
+		EXPECT_EQ(i, find_name(index, names, names[i].c_str()));
+	}
+	EXPECT_EQ(-1, find_name(index, names, "Kappa"));
+}
+
+TEST(NameIndexTest, update_growing_table)
+{
+	auto names = make_names("Class", 10);
+
+	util::name_index<> index;
+	auto name_of = [&names](int i) { return names[i].c_str(); };
+
+	index.update((int)names.size(), name_of);
+	EXPECT_EQ(7, find_name(index, names, "class 7"));
+
+	// only the new entries need to be picked up
+	names.push_back("Newcomer");
+	index.update((int)names.size(), name_of);
+	EXPECT_EQ(10, find_name(index, names, "newcomer"));
+
+	// shrinking starts from scratch
+	names.resize(5);
+	index.update((int)names.size(), name_of);
+	EXPECT_EQ(-1, find_name(index, names, "Newcomer"));
+	EXPECT_EQ(4, find_name(index, names, "Class 4"));
+
+	// entries which were renamed are only found again after invalidating
+	names[4] = "Renamed";
+	index.update((int)names.size(), name_of);
+	EXPECT_EQ(-1, find_name(index, names, "Renamed"));
+	index.invalidate();
+	index.update((int)names.size(), name_of);
+	EXPECT_EQ(4, find_name(index, names, "Renamed"));
+}
+
+TEST(NameIndexTest, benchmark_lookups)
+{
+	// ships
+	{
+		auto names = make_names("GTF Ulysses", MAX_SHIPS);
+		for (int i = 0; i < MAX_SHIPS; ++i) {
+			Objects[i].type = OBJ_SHIP;
+			Ships[i].objnum = i;
+			strcpy_s(Ships[i].ship_name, names[i].c_str());
+			ship_name_changed(i);
+		}
+
+		benchmark_lookup("ship_name_lookup", names, [](const char* name) {
+			for (int i = 0; i < MAX_SHIPS; i++) {
+				if (Ships[i].objnum >= 0 && Objects[Ships[i].objnum].type == OBJ_SHIP && !stricmp(name, Ships[i].ship_name))
+					return i;
+			}
+			return -1;
+		}, [](const char* name) { return ship_name_lookup(name); });
+
+		for (int i = 0; i < MAX_SHIPS; ++i) {
+			Objects[i].type = OBJ_NONE;
+			Ships[i].objnum = -1;
+			Ships[i].ship_name[0] = '\0';
+		}
+	}
+
+	// ship classes
+	{
+		SCP_vector<ship_info> old_ship_info;
+		std::swap(old_ship_info, Ship_info);
+
+		auto names = make_names("GTC Fenris", 400);
+		Ship_info.resize(names.size());
+		for (size_t i = 0; i < names.size(); ++i) {
+			strcpy_s(Ship_info[i].name, names[i].c_str());
+		}
+
+		benchmark_lookup("ship_info_lookup", names, [](const char* name) {
+			for (int i = 0; i < ship_info_size(); i++) {
+				if (!stricmp(name, Ship_info[i].name))
+					return i;
+			}
+			return -1;
+		}, [](const char* name) { return ship_info_lookup(name); });
+
+		std::swap(old_ship_info, Ship_info);
+	}
+
+	// weapon classes
+	{
+		SCP_vector<weapon_info> old_weapon_info;
+		std::swap(old_weapon_info, Weapon_info);
+
+		auto names = make_names("Subach HL-7", 300);
+		Weapon_info.resize(names.size());
+		for (size_t i = 0; i < names.size(); ++i) {
+			strcpy_s(Weapon_info[i].name, names[i].c_str());
+		}
+
+		benchmark_lookup("weapon_info_lookup", names, [](const char* name) {
+			for (int i = 0; i < weapon_info_size(); i++) {
+				if (!stricmp(name, Weapon_info[i].name))
+					return i;
+			}
+			return -1;
+		}, [](const char* name) { return weapon_info_lookup(name); });
+
+		std::swap(old_weapon_info, Weapon_info);
+	}
+
+	// ship types
+	{
+		SCP_vector<ship_type_info> old_ship_types;
+		std::swap(old_ship_types, Ship_types);
+
+		auto names = make_names("Cruiser", 40);
+		Ship_types.resize(names.size());
+		for (size_t i = 0; i < names.size(); ++i) {
+			strcpy_s(Ship_types[i].name, names[i].c_str());
+		}
+
+		benchmark_lookup("ship_type_name_lookup", names, [](const char* name) {
+			for (int i = 0; i < (int)Ship_types.size(); i++) {
+				if (!stricmp(name, Ship_types[i].name))
+					return i;
+			}
+			return -1;
+		}, [](const char* name) { return ship_type_name_lookup(name); });
+
+		std::swap(old_ship_types, Ship_types);
+	}
+
+	// sexp operators, which are compared case-sensitively
+	{
+		SCP_vector<SCP_string> names;
+		for (const auto& op : Operators) {
+			names.push_back(op.text);
+		}
+
+		benchmark_lookup("get_operator_index", names, [](const char* name) {
+			for (int i = 0; i < (int)Operators.size(); i++) {
+				if (Operators[i].text == name)
+					return i;
+			}
+			return -1;
+		}, [](const char* name) { return get_operator_index(name); });
+	}
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "cmdline/cmdline.h"
+#include "object/objcollide.h"
+#include "utils/threading.h"
+
+#include <chrono>
+
+class ThreadingTest : public ::testing::Test {
+  protected:
+	void SetUp() override {
+		m_old_threads = Cmdline_multithreading;
+
+		// one main thread and three workers, regardless of what the machine running the tests has
+		Cmdline_multithreading = 4;
+		threading::init_task_pool();
+		collide_init();
+	}
+	void TearDown() override {
+		threading::shut_down_task_pool();
+		Cmdline_multithreading = m_old_threads;
+	}
+
+	int m_old_threads = 1;
+};
+
+TEST_F(ThreadingTest, job_group_runs_all_jobs) {
+	std::atomic<int> counter(0);
+
+	threading::job_group group;
+	for (int i = 0; i < 1000; ++i) {
+		group.add([&counter]() { counter.fetch_add(1); });
+	}
+	group.wait();
+
+	ASSERT_TRUE(group.done());
+	ASSERT_EQ(1000, counter.load());
+}
+
+TEST_F(ThreadingTest, job_group_dependencies) {
+	// a diamond a -> (b, c) -> d, repeated a bunch of times to give the threads a chance to race
+	for (int round = 0; round < 200; ++round) {
+		std::atomic<int> a(0), b(0), c(0), d(0);
+		std::atomic<bool> order_ok(true);
+
+		threading::job_group group;
+		auto id_a = group.add([&]() { a = 1; });
+		auto id_b = group.add([&]() { if (a != 1) order_ok = false; b = 1; }, {id_a});
+		auto id_c = group.add([&]() { if (a != 1) order_ok = false; c = 1; }, {id_a});
+		group.add([&]() { if (b != 1 || c != 1) order_ok = false; d = 1; }, {id_b, id_c});
+		group.wait();
+
+		ASSERT_TRUE(order_ok.load()) << "Dependency order violated in round " << round;
+		ASSERT_EQ(1, d.load());
+	}
+}
+
+TEST_F(ThreadingTest, nested_jobs) {
+	std::atomic<int> counter(0);
+
+	threading::job_group outer;
+	for (int i = 0; i < 16; ++i) {
+		outer.add([&counter]() {
+			threading::job_group inner;
+			for (int j = 0; j < 16; ++j) {
+				inner.add([&counter]() { counter.fetch_add(1); });
+			}
+			inner.wait();
+		});
+	}
+	outer.wait();
+
+	ASSERT_EQ(16 * 16, counter.load());
+}
+
+TEST_F(ThreadingTest, parallel_for_covers_range) {
+	SCP_vector<int> values(10007, 0);
+
+	threading::parallel_for(0, values.size(), 100, [&values](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			values[i] += 1;
+		}
+	});
+
+	for (size_t i = 0; i < values.size(); ++i) {
+		ASSERT_EQ(1, values[i]) << "Element " << i;
+	}
+}
+
+TEST_F(ThreadingTest, benchmark_dispatch_latency) {
+	using clock = std::chrono::steady_clock;
+	const int iterations = 1000;
+
+	// the old way of getting anything onto the workers, a full spin up and spin down of the pool. This is what the
+	// collision code goes through every frame.
+	auto start = clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		obj_sort_and_collide();
+	}
+	auto spin_time = clock::now() - start;
+
+	// one job per worker, which is the closest equivalent of occupying the whole pool
+	start = clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		threading::job_group group;
+		for (size_t w = 0; w < threading::get_num_workers(); ++w) {
+			group.add([]() {});
+		}
+		group.wait();
+	}
+	auto job_time = clock::now() - start;
+
+	auto to_us = [iterations](clock::duration d) {
+		return std::chrono::duration<double, std::micro>(d).count() / iterations;
+	};
+	std::cout << "Spin up/spin down cycle: " << to_us(spin_time) << " us" << std::endl;
+	std::cout << "Job group dispatch:      " << to_us(job_time) << " us" << std::endl;
+}